@@ -0,0 +1,27 @@
+#version 450
+
+// Compile with: glslc bindless.vert -o bindless.spv
+
+// Set to the capacity of the bindless table when the pipeline is built
+layout(constant_id = 0) const uint STORAGE_BUFFER_CAPACITY = 1;
+
+layout(set = 0, binding = 0) readonly buffer DrawData
+{
+    vec4 offset;
+} drawData[STORAGE_BUFFER_CAPACITY];
+
+layout(push_constant) uniform DrawHandles
+{
+    uint drawDataHandle;
+};
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main()
+{
+    gl_Position = vec4(inPosition + drawData[drawDataHandle].offset.xy, 0.0, 1.0);
+    fragColor = inColor;
+}
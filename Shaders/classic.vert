@@ -0,0 +1,19 @@
+#version 450
+
+// Compile with: glslc classic.vert -o classic.spv
+
+layout(set = 0, binding = 0) readonly buffer DrawData
+{
+    vec4 offset;
+} drawData;
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main()
+{
+    gl_Position = vec4(inPosition + drawData.offset.xy, 0.0, 1.0);
+    fragColor = inColor;
+}
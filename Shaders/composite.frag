@@ -0,0 +1,13 @@
+#version 450
+
+// Compile with: glslc composite.frag -o composite.spv
+
+// Albedo written by the scene subpass, read at this pixel only so it can stay in tile memory
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput albedo;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    outColor = vec4(subpassLoad(albedo).rgb, 1.0);
+}
@@ -0,0 +1,46 @@
+#version 450
+
+// Compile with: glslc culled.vert -o culled.spv
+
+struct CullObject
+{
+    vec4 sphere;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint materialIndex;
+};
+
+layout(set = 0, binding = 0) readonly buffer Objects
+{
+    CullObject objects[];
+};
+
+layout(push_constant) uniform Camera
+{
+    mat4 viewProjection;
+};
+
+const vec3 materialTints[4] = vec3[](
+    vec3(1.0, 1.0, 1.0),
+    vec3(1.0, 0.6, 0.6),
+    vec3(0.6, 1.0, 0.6),
+    vec3(0.6, 0.6, 1.0)
+);
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main()
+{
+    // Direct and indirect draws both pass the object index as firstInstance
+    CullObject object = objects[gl_InstanceIndex];
+    
+    // The triangle's corners are at most 0.71 from its origin, scaled up so they touch the bounding sphere
+    vec2 offset = inPosition * object.sphere.w * 1.41;
+    
+    gl_Position = viewProjection * vec4(object.sphere.xyz + vec3(offset, 0.0), 1.0);
+    fragColor = inColor * materialTints[object.materialIndex % 4];
+}
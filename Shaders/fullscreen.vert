@@ -0,0 +1,11 @@
+#version 450
+
+// Compile with: glslc fullscreen.vert -o fullscreen.spv
+
+// One triangle covering the screen, no vertex buffer needed
+void main()
+{
+    vec2 position = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,30 @@
+#version 450
+
+// Compile with: glslc instanced.vert -o instanced.spv
+
+// Pushed once per batch, every instance of a draw shares its material
+layout(push_constant) uniform DrawConstants
+{
+    uint materialIndex;
+};
+
+const vec3 materialTints[4] = vec3[](
+    vec3(1.0, 1.0, 1.0),
+    vec3(1.0, 0.6, 0.6),
+    vec3(0.6, 1.0, 0.6),
+    vec3(0.6, 0.6, 1.0)
+);
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+// Instance rate: xy is the offset, z the scale
+layout(location = 2) in vec3 inInstance;
+
+layout(location = 0) out vec3 fragColor;
+
+void main()
+{
+    gl_Position = vec4(inPosition * inInstance.z + inInstance.xy, 0.0, 1.0);
+    fragColor = inColor * materialTints[materialIndex % 4];
+}
@@ -0,0 +1,25 @@
+#version 450
+
+// Compile with: glslc layered.vert -o layered.spv
+
+// One layer of the depth benchmark per draw: xy is the offset, z the scale and w the depth
+layout(push_constant) uniform LayerConstants
+{
+    vec4 layer;
+};
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+// The depth pre-pass runs this shader too and its depth has to match exactly for the EQUAL test
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = vec4(inPosition * layer.z + layer.xy, layer.w, 1.0);
+    
+    // Nearer layers are brighter, so a wrong depth order is easy to spot
+    fragColor = inColor * (1.0 - 0.5 * layer.w);
+}
@@ -0,0 +1,20 @@
+#version 450
+
+// Compile with: glslc shaded.frag -o shaded.spv
+
+// Deliberately expensive, so the depth benchmark shows what every fragment that is never shaded saves
+layout(constant_id = 0) const uint SHADE_ITERATIONS = 32;
+
+layout(location = 0) in vec3 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    vec3 color = fragColor;
+    
+    for (uint i = 0; i < SHADE_ITERATIONS; i++)
+        color = abs(sin(color * 3.1 + gl_FragCoord.xyx * 0.001));
+    
+    outColor = vec4(mix(fragColor, color, 0.25), 1.0);
+}
@@ -0,0 +1,12 @@
+#version 450
+
+// Compile with: glslc shader.frag -o frag.spv
+
+layout(location = 0) in vec3 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    outColor = vec4(fragColor, 1.0);
+}
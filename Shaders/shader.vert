@@ -0,0 +1,32 @@
+#version 450
+
+// Compile with: glslc shader.vert -o vert.spv
+
+// Bound per draw at a dynamic offset into the frame uniform buffer
+layout(set = 0, binding = 0) uniform ObjectUniforms
+{
+    mat4 transform;
+} object;
+
+layout(push_constant) uniform DrawConstants
+{
+    uint materialIndex;
+};
+
+const vec3 materialTints[4] = vec3[](
+    vec3(1.0, 1.0, 1.0),
+    vec3(1.0, 0.6, 0.6),
+    vec3(0.6, 1.0, 0.6),
+    vec3(0.6, 0.6, 1.0)
+);
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main()
+{
+    gl_Position = object.transform * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor * materialTints[materialIndex % 4];
+}
@@ -0,0 +1,217 @@
+//
+//  deviceSelectorTests.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+//  Checks of the physical device ranking on made-up devices, built as its own command line target together with
+//  deviceSelector.cpp. No device is touched, so the results are the same on lavapipe as on real hardware. Exits
+//  with 1 when any check fails.
+//
+
+#include "../deviceSelector.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char* description)
+{
+    if (!condition)
+    {
+        printf("FAILED: %s\n", description);
+        failures++;
+    }
+}
+
+// One graphics family and a local heap of heapMegabytes
+static PhysicalDeviceDescription makeDevice(const char* name, VkPhysicalDeviceType type, VkDeviceSize heapMegabytes)
+{
+    PhysicalDeviceDescription description;
+    description.suitable = true;
+    
+    strncpy(description.properties.deviceName, name, VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+    description.properties.deviceType = type;
+    
+    description.memoryProperties.memoryHeapCount = 1;
+    description.memoryProperties.memoryHeaps[0].size = heapMegabytes * 1024 * 1024;
+    description.memoryProperties.memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    
+    VkQueueFamilyProperties graphics {};
+    graphics.queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+    graphics.queueCount = 1;
+    
+    description.queueFamilies.push_back(graphics);
+    
+    return description;
+}
+
+static void addQueueFamily(PhysicalDeviceDescription &description, VkQueueFlags flags)
+{
+    VkQueueFamilyProperties family {};
+    family.queueFlags = flags;
+    family.queueCount = 1;
+    
+    description.queueFamilies.push_back(family);
+}
+
+static void setDeviceUUID(PhysicalDeviceDescription &description, uint8_t seed)
+{
+    for (uint32_t i = 0; i < VK_UUID_SIZE; i++)
+        description.deviceUUID[i] = static_cast<uint8_t>(seed + i);
+    
+    description.hasDeviceUUID = true;
+}
+
+static void testDeviceType()
+{
+    // The integrated GPU reports more shared memory as device local than the discrete one has
+    std::vector<PhysicalDeviceDescription> devices = {
+        makeDevice("Integrated", VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, 32768),
+        makeDevice("Discrete", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 4096),
+        makeDevice("llvmpipe", VK_PHYSICAL_DEVICE_TYPE_CPU, 65536)
+    };
+    
+    check(selectPhysicalDevice(devices, "") == 1, "a discrete GPU beats an integrated GPU with a larger heap");
+    
+    devices.erase(devices.begin() + 1);
+    check(selectPhysicalDevice(devices, "") == 0, "an integrated GPU beats a CPU device");
+}
+
+static void testHeapSize()
+{
+    std::vector<PhysicalDeviceDescription> devices = {
+        makeDevice("Small", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 4096),
+        makeDevice("Large", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 16384)
+    };
+    
+    // Host visible heaps that are not device local do not count
+    devices[0].memoryProperties.memoryHeapCount = 2;
+    devices[0].memoryProperties.memoryHeaps[1].size = 65536ull * 1024 * 1024;
+    devices[0].memoryProperties.memoryHeaps[1].flags = 0;
+    
+    check(selectPhysicalDevice(devices, "") == 1, "the larger local heap wins between devices of the same type");
+}
+
+static void testQueueFamilies()
+{
+    std::vector<PhysicalDeviceDescription> devices = {
+        makeDevice("Shared", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192),
+        makeDevice("Transfer", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192),
+        makeDevice("Both", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192)
+    };
+    
+    addQueueFamily(devices[1], VK_QUEUE_TRANSFER_BIT);
+    addQueueFamily(devices[2], VK_QUEUE_TRANSFER_BIT);
+    addQueueFamily(devices[2], VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT);
+    
+    check(scorePhysicalDevice(devices[1]) > scorePhysicalDevice(devices[0]), "a dedicated transfer family adds to the score");
+    check(selectPhysicalDevice(devices, "") == 2, "dedicated transfer and compute families win over either alone");
+    
+    // A transfer family that can also do graphics is not dedicated
+    addQueueFamily(devices[0], VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT);
+    check(scorePhysicalDevice(devices[0]) < scorePhysicalDevice(devices[1]), "a graphics family is not a dedicated transfer family");
+}
+
+static void testFeatures()
+{
+    std::vector<PhysicalDeviceDescription> devices = {
+        makeDevice("Plain", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192),
+        makeDevice("Featured", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192)
+    };
+    
+    devices[1].features.samplerAnisotropy = VK_TRUE;
+    devices[1].features.multiDrawIndirect = VK_TRUE;
+    
+    check(selectPhysicalDevice(devices, "") == 1, "optional features break a tie");
+}
+
+static void testTiesAndSuitability()
+{
+    std::vector<PhysicalDeviceDescription> devices = {
+        makeDevice("First", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192),
+        makeDevice("Second", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192)
+    };
+    
+    check(selectPhysicalDevice(devices, "") == 0, "ties keep the lower index");
+    
+    devices.push_back(makeDevice("Unsuitable", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 65536));
+    devices.back().suitable = false;
+    
+    check(selectPhysicalDevice(devices, "") == 0, "an unsuitable device is never picked, whatever its score");
+    check(selectPhysicalDevice(devices, "unsuitable") == 0, "an override cannot pick an unsuitable device");
+    
+    devices[0].suitable = false;
+    devices[1].suitable = false;
+    
+    bool threw = false;
+    
+    try
+    {
+        selectPhysicalDevice(devices, "");
+    }
+    catch (const std::runtime_error &)
+    {
+        threw = true;
+    }
+    
+    check(threw, "no suitable device throws");
+}
+
+static void testOverrides()
+{
+    std::vector<PhysicalDeviceDescription> devices = {
+        makeDevice("NVIDIA GeForce RTX", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192),
+        makeDevice("Intel(R) UHD Graphics", VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, 2048),
+        makeDevice("Intel(R) Arc", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 4096)
+    };
+    
+    setDeviceUUID(devices[0], 0x00);
+    setDeviceUUID(devices[1], 0x10);
+    
+    check(selectPhysicalDevice(devices, "uhd") == 1, "a name override is a case-insensitive substring");
+    check(selectPhysicalDevice(devices, "intel") == 1, "a name override matching several devices takes the first");
+    check(selectPhysicalDevice(devices, "10111213-1415-1617-1819-1a1b1c1d1e1f") == 1, "a dashed device UUID overrides");
+    check(selectPhysicalDevice(devices, "101112131415161718191A1B1C1D1E1F") == 1, "a compact upper case device UUID overrides");
+    check(selectPhysicalDevice(devices, "Radeon") == 0, "an override nothing matches falls back to the highest score");
+    
+    // Without a device UUID only the name can match, even a zero UUID
+    check(selectPhysicalDevice(devices, "00000000000000000000000000000000") == 0, "a zero UUID does not match an unknown device UUID");
+    check(!matchesDeviceOverride(devices[2], "00000000000000000000000000000000"), "a device without a UUID never matches one");
+}
+
+static void testOverrideSource()
+{
+    setenv(DEVICE_OVERRIDE_VARIABLE, "from environment", 1);
+    
+    check(getDeviceOverride("configured") == "configured", "the configured override wins over the environment");
+    check(getDeviceOverride("") == "from environment", "the environment is used without a configured override");
+    
+    unsetenv(DEVICE_OVERRIDE_VARIABLE);
+    
+    check(getDeviceOverride("").empty(), "no override without either");
+}
+
+int main()
+{
+    testDeviceType();
+    testHeapSize();
+    testQueueFamilies();
+    testFeatures();
+    testTiesAndSuitability();
+    testOverrides();
+    testOverrideSource();
+    
+    if (failures != 0)
+    {
+        printf("%u device selector checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    
+    printf("All device selector checks passed\n");
+    
+    return EXIT_SUCCESS;
+}
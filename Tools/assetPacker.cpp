@@ -0,0 +1,117 @@
+//
+//  assetPacker.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+//  Offline packer for the runtime AssetArchive, built as its own command line target together with
+//  assetArchive.cpp and mappedFile.cpp. Entries are named by the path they were given, so
+//
+//      assetPacker --compress assets.pak Shaders/vert.spv Shaders/frag.spv Shaders/overlap.spv
+//
+//  produces entries the application finds under the same relative paths it used for loose files.
+//  Directories are added recursively.
+//
+
+#include "../assetArchive.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+static std::vector<uint8_t> readSource(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open " + path.string() + "!");
+    
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    
+    return data;
+}
+
+static void addSource(std::vector<ArchiveSource> &sources, const std::filesystem::path &path)
+{
+    if (std::filesystem::is_directory(path))
+    {
+        for (const auto &child : std::filesystem::recursive_directory_iterator(path))
+            if (child.is_regular_file())
+                sources.push_back({child.path().generic_string(), readSource(child.path())});
+    }
+    else
+        sources.push_back({path.generic_string(), readSource(path)});
+}
+
+int main(int argc, const char* argv[])
+{
+    bool compress = false;
+    std::string outputPath;
+    std::vector<std::string> inputs;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        
+        if (argument == "--compress")
+            compress = true;
+        else if (outputPath.empty())
+            outputPath = argument;
+        else
+            inputs.push_back(argument);
+    }
+    
+    if (outputPath.empty() || inputs.empty())
+    {
+        std::cerr << "Usage: assetPacker [--compress] <archive> <file or directory>..." << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    try
+    {
+        std::vector<ArchiveSource> sources;
+        
+        for (const auto &input : inputs)
+            addSource(sources, input);
+        
+        // Sorted names keep the output identical between runs
+        std::sort(sources.begin(), sources.end(), [](const ArchiveSource &a, const ArchiveSource &b)
+        {
+            return a.name < b.name;
+        });
+        
+        writeAssetArchive(outputPath, sources, compress);
+        
+        AssetArchive archive;
+        archive.open(outputPath);
+        
+        uint64_t rawSize = 0, storedSize = 0;
+        
+        for (const auto &source : sources)
+        {
+            const ArchiveEntry* entry = archive.find(source.name);
+            
+            // Every entry is read back once, a packer that writes broken archives is worse than none
+            if (entry == nullptr || archive.read(*entry) != source.data)
+                throw std::runtime_error("Failed to verify " + source.name + "!");
+            
+            rawSize += entry->size;
+            storedSize += entry->storedSize;
+        }
+        
+        printf("Packed %zu entries into %s, %llu bytes stored for %llu bytes of data\n", sources.size(), outputPath.c_str(), static_cast<unsigned long long>(storedSize), static_cast<unsigned long long>(rawSize));
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    return 0;
+}
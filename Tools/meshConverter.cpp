@@ -0,0 +1,74 @@
+//
+//  meshConverter.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+//  Offline converter from OBJ to the runtime mesh format, built as its own command line target together with
+//  meshFormat.cpp. Without an output path the input's extension is replaced, so
+//
+//      meshConverter Models/bunny.obj
+//
+//  writes Models/bunny.vmesh, which the mesh streamer loads loose or from an archive made by assetPacker.
+//
+
+#include "../meshFormat.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: meshConverter <input.obj> [output.vmesh]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    std::filesystem::path inputPath = argv[1];
+    std::filesystem::path outputPath = argc == 3 ? std::filesystem::path(argv[2]) : std::filesystem::path(inputPath).replace_extension(".vmesh");
+    
+    try
+    {
+        std::string extension = inputPath.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+        
+        if (extension != ".obj")
+            throw std::runtime_error("Only .obj input is supported!");
+        
+        SourceMesh source = loadObjMesh(inputPath.string());
+        std::vector<uint8_t> encoded = encodeMesh(source);
+        
+        // Decoded again, so the file is known to load and the quantization error can be reported
+        MeshData decoded = decodeMesh(encoded.data(), encoded.size());
+        float maxError = 0.0f;
+        
+        for (size_t i = 0; i < source.vertices.size(); i++)
+            for (uint32_t axis = 0; axis < 3; axis++)
+                maxError = std::max(maxError, std::fabs(source.vertices[i].position[axis] - decoded.vertices[i].position[axis]));
+        
+        std::ofstream file(outputPath, std::ios::binary);
+        
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open " + outputPath.string() + "!");
+        
+        file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+        
+        if (!file)
+            throw std::runtime_error("Failed to write " + outputPath.string() + "!");
+        
+        printf("Converted %s: %zu vertices, %zu triangles, %u-bit indices, %zu bytes (%zu decoded), max position error %g\n", inputPath.string().c_str(), source.vertices.size(), source.indices.size() / 3, decoded.indexSize * 8, encoded.size(), decoded.getByteSize(), maxError);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    return 0;
+}
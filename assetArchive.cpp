@@ -0,0 +1,415 @@
+//
+//  assetArchive.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "assetArchive.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// Set in a chunk's size prefix when the chunk did not compress and is stored as is
+const uint32_t RAW_CHUNK_BIT = 0x80000000;
+
+const uint32_t MIN_MATCH = 4;
+const uint32_t MAX_OFFSET = 0xFFFF;
+const uint32_t MATCH_TABLE_BITS = 14;
+
+// LZ CHUNK FUNCTIONS START
+static void writeVarint(std::vector<uint8_t> &output, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        output.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    
+    output.push_back(static_cast<uint8_t>(value));
+}
+
+static uint32_t readVarint(const uint8_t* &input, const uint8_t* end)
+{
+    uint32_t value = 0;
+    
+    for (uint32_t shift = 0; shift < 32; shift += 7)
+    {
+        if (input >= end)
+            break;
+        
+        uint8_t byte = *input++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        
+        if (!(byte & 0x80))
+            return value;
+    }
+    
+    throw std::runtime_error("Corrupt archive entry!");
+}
+
+static uint32_t read32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    
+    return value;
+}
+
+// Greedy matcher over a hash of the next 4 bytes. Each token is a literal run followed by a
+// match, and the chunk ends as soon as its raw size has been produced
+static std::vector<uint8_t> compressChunk(const uint8_t* data, uint32_t size)
+{
+    std::vector<uint8_t> output;
+    std::vector<uint32_t> table(1u << MATCH_TABLE_BITS, UINT32_MAX);
+    
+    uint32_t anchor = 0;
+    uint32_t position = 0;
+    
+    while (position + MIN_MATCH <= size)
+    {
+        uint32_t sequence = read32(data + position);
+        uint32_t slot = (sequence * 2654435761u) >> (32 - MATCH_TABLE_BITS);
+        
+        uint32_t candidate = table[slot];
+        table[slot] = position;
+        
+        if (candidate == UINT32_MAX || position - candidate > MAX_OFFSET || read32(data + candidate) != sequence)
+        {
+            position++;
+            continue;
+        }
+        
+        uint32_t length = MIN_MATCH;
+        
+        while (position + length < size && data[candidate + length] == data[position + length])
+            length++;
+        
+        writeVarint(output, position - anchor);
+        output.insert(output.end(), data + anchor, data + position);
+        
+        writeVarint(output, length - MIN_MATCH);
+        output.push_back(static_cast<uint8_t>(position - candidate));
+        output.push_back(static_cast<uint8_t>((position - candidate) >> 8));
+        
+        position += length;
+        anchor = position;
+    }
+    
+    if (anchor < size)
+    {
+        writeVarint(output, size - anchor);
+        output.insert(output.end(), data + anchor, data + size);
+    }
+    
+    return output;
+}
+
+static void decompressChunk(const uint8_t* input, size_t inputSize, uint8_t* output, uint32_t outputSize)
+{
+    const uint8_t* end = input + inputSize;
+    uint32_t produced = 0;
+    
+    while (produced < outputSize)
+    {
+        uint32_t literals = readVarint(input, end);
+        
+        if (literals > outputSize - produced || literals > static_cast<size_t>(end - input))
+            throw std::runtime_error("Corrupt archive entry!");
+        
+        memcpy(output + produced, input, literals);
+        input += literals;
+        produced += literals;
+        
+        if (produced == outputSize)
+            break;
+        
+        uint32_t length = readVarint(input, end) + MIN_MATCH;
+        
+        if (end - input < 2)
+            throw std::runtime_error("Corrupt archive entry!");
+        
+        uint32_t offset = input[0] | (static_cast<uint32_t>(input[1]) << 8);
+        input += 2;
+        
+        if (offset == 0 || offset > produced || length > outputSize - produced)
+            throw std::runtime_error("Corrupt archive entry!");
+        
+        // Matches may overlap their own output, so this has to go byte by byte
+        for (uint32_t i = 0; i < length; i++, produced++)
+            output[produced] = output[produced - offset];
+    }
+}
+
+static std::vector<uint8_t> compressEntry(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> output;
+    
+    for (size_t offset = 0; offset < data.size(); offset += ARCHIVE_CHUNK_SIZE)
+    {
+        uint32_t chunkSize = static_cast<uint32_t>(std::min<size_t>(ARCHIVE_CHUNK_SIZE, data.size() - offset));
+        std::vector<uint8_t> chunk = compressChunk(data.data() + offset, chunkSize);
+        
+        bool raw = chunk.size() >= chunkSize;
+        uint32_t prefix = raw ? (chunkSize | RAW_CHUNK_BIT) : static_cast<uint32_t>(chunk.size());
+        
+        output.insert(output.end(), reinterpret_cast<const uint8_t*>(&prefix), reinterpret_cast<const uint8_t*>(&prefix) + sizeof(prefix));
+        
+        if (raw)
+            output.insert(output.end(), data.begin() + offset, data.begin() + offset + chunkSize);
+        else
+            output.insert(output.end(), chunk.begin(), chunk.end());
+    }
+    
+    return output;
+}
+// LZ CHUNK FUNCTIONS END
+
+uint64_t hashArchiveName(const std::string &name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    
+    for (char character : name)
+    {
+        hash ^= static_cast<uint8_t>(character);
+        hash *= 1099511628211ull;
+    }
+    
+    // 0 is reserved for empty buckets
+    return hash != 0 ? hash : 1;
+}
+
+static uint64_t alignArchiveOffset(uint64_t offset)
+{
+    return (offset + ARCHIVE_ALIGNMENT - 1) & ~(ARCHIVE_ALIGNMENT - 1);
+}
+
+void writeAssetArchive(const std::string &path, const std::vector<ArchiveSource> &sources, bool compress)
+{
+    // At most half full, so probe sequences stay short
+    uint32_t bucketCount = 1;
+    
+    while (bucketCount < sources.size() * 2)
+        bucketCount <<= 1;
+    
+    std::vector<ArchiveEntry> buckets(bucketCount, ArchiveEntry {});
+    std::vector<std::vector<uint8_t>> storedData(sources.size());
+    std::vector<char> nameTable;
+    std::vector<uint32_t> entryBuckets;
+    
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        const ArchiveSource &source = sources[i];
+        uint64_t hash = hashArchiveName(source.name);
+        uint32_t bucket = static_cast<uint32_t>(hash) & (bucketCount - 1);
+        
+        while (buckets[bucket].nameHash != 0)
+        {
+            if (buckets[bucket].nameHash == hash && source.name == &nameTable[buckets[bucket].nameOffset])
+                throw std::runtime_error("Duplicate archive entry: " + source.name);
+            
+            bucket = (bucket + 1) & (bucketCount - 1);
+        }
+        
+        ArchiveEntry &entry = buckets[bucket];
+        entry.nameHash = hash;
+        entry.size = source.data.size();
+        entry.nameOffset = static_cast<uint32_t>(nameTable.size());
+        entry.compression = ArchiveCompression::None;
+        
+        nameTable.insert(nameTable.end(), source.name.begin(), source.name.end());
+        nameTable.push_back('\0');
+        
+        if (compress)
+        {
+            std::vector<uint8_t> compressed = compressEntry(source.data);
+            
+            if (compressed.size() < source.data.size())
+            {
+                entry.compression = ArchiveCompression::Lz;
+                storedData[i] = std::move(compressed);
+            }
+        }
+        
+        entry.storedSize = entry.compression == ArchiveCompression::None ? source.data.size() : storedData[i].size();
+        entryBuckets.push_back(bucket);
+    }
+    
+    ArchiveHeader header {};
+    header.magic = ARCHIVE_MAGIC;
+    header.version = ARCHIVE_VERSION;
+    header.entryCount = static_cast<uint32_t>(sources.size());
+    header.bucketCount = bucketCount;
+    header.nameTableOffset = sizeof(ArchiveHeader) + bucketCount * sizeof(ArchiveEntry);
+    header.nameTableSize = nameTable.size();
+    
+    uint64_t offset = alignArchiveOffset(header.nameTableOffset + header.nameTableSize);
+    
+    for (uint32_t bucket : entryBuckets)
+    {
+        buckets[bucket].offset = offset;
+        offset = alignArchiveOffset(offset + buckets[bucket].storedSize);
+    }
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open archive " + path + "!");
+    
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(ArchiveEntry));
+    file.write(nameTable.data(), nameTable.size());
+    
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        const ArchiveEntry &entry = buckets[entryBuckets[i]];
+        const std::vector<uint8_t> &data = entry.compression == ArchiveCompression::None ? sources[i].data : storedData[i];
+        
+        file.seekp(static_cast<std::streamoff>(entry.offset));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    
+    if (!file)
+        throw std::runtime_error("Failed to write archive " + path + "!");
+}
+
+void AssetArchive::open(const std::string &path)
+{
+    close();
+    
+    MappedFile mapping(path);
+    
+    if (mapping.size() < sizeof(ArchiveHeader))
+        throw std::runtime_error("Invalid archive " + path + "!");
+    
+    const ArchiveHeader* archiveHeader = reinterpret_cast<const ArchiveHeader*>(mapping.data());
+    
+    uint64_t indexEnd = sizeof(ArchiveHeader) + static_cast<uint64_t>(archiveHeader->bucketCount) * sizeof(ArchiveEntry);
+    
+    if (archiveHeader->magic != ARCHIVE_MAGIC || archiveHeader->version != ARCHIVE_VERSION)
+        throw std::runtime_error("Invalid archive " + path + "!");
+    
+    if (archiveHeader->bucketCount == 0 || (archiveHeader->bucketCount & (archiveHeader->bucketCount - 1)) != 0 || archiveHeader->entryCount >= archiveHeader->bucketCount)
+        throw std::runtime_error("Invalid archive " + path + "!");
+    
+    if (indexEnd > archiveHeader->nameTableOffset || archiveHeader->nameTableOffset + archiveHeader->nameTableSize > mapping.size())
+        throw std::runtime_error("Invalid archive " + path + "!");
+    
+    file = std::move(mapping);
+    archivePath = path;
+    
+    header = archiveHeader;
+    buckets = reinterpret_cast<const ArchiveEntry*>(file.data() + sizeof(ArchiveHeader));
+    names = reinterpret_cast<const char*>(file.data() + header->nameTableOffset);
+}
+
+void AssetArchive::close()
+{
+    file = MappedFile();
+    archivePath.clear();
+    
+    header = nullptr;
+    buckets = nullptr;
+    names = nullptr;
+}
+
+const ArchiveEntry* AssetArchive::find(const std::string &name) const
+{
+    if (header == nullptr)
+        return nullptr;
+    
+    uint64_t hash = hashArchiveName(name);
+    uint32_t mask = header->bucketCount - 1;
+    
+    // The table is never full, so an empty bucket always ends the probe
+    for (uint32_t bucket = static_cast<uint32_t>(hash) & mask; buckets[bucket].nameHash != 0; bucket = (bucket + 1) & mask)
+    {
+        const ArchiveEntry &entry = buckets[bucket];
+        
+        if (entry.nameHash != hash || entry.nameOffset >= header->nameTableSize)
+            continue;
+        
+        if (strncmp(names + entry.nameOffset, name.c_str(), header->nameTableSize - entry.nameOffset) != 0)
+            continue;
+        
+        if (entry.offset + entry.storedSize > file.size() || (entry.compression == ArchiveCompression::None && entry.storedSize != entry.size))
+            throw std::runtime_error("Corrupt archive entry: " + name);
+        
+        return &entry;
+    }
+    
+    return nullptr;
+}
+
+const uint8_t* AssetArchive::getData(const ArchiveEntry &entry) const
+{
+    return entry.compression == ArchiveCompression::None ? file.data() + entry.offset : nullptr;
+}
+
+std::vector<uint8_t> AssetArchive::read(const ArchiveEntry &entry) const
+{
+    std::vector<uint8_t> data;
+    data.reserve(entry.size);
+    
+    stream(entry, [&](const uint8_t* chunk, size_t size)
+    {
+        data.insert(data.end(), chunk, chunk + size);
+    });
+    
+    return data;
+}
+
+void AssetArchive::stream(const ArchiveEntry &entry, const ChunkFunction &function) const
+{
+    const uint8_t* stored = file.data() + entry.offset;
+    
+    if (entry.compression == ArchiveCompression::None)
+    {
+        for (uint64_t offset = 0; offset < entry.size; offset += ARCHIVE_CHUNK_SIZE)
+            function(stored + offset, static_cast<size_t>(std::min<uint64_t>(ARCHIVE_CHUNK_SIZE, entry.size - offset)));
+        
+        return;
+    }
+    
+    if (entry.compression != ArchiveCompression::Lz)
+        throw std::runtime_error("Unknown archive compression!");
+    
+    const uint8_t* end = stored + entry.storedSize;
+    std::vector<uint8_t> chunk(ARCHIVE_CHUNK_SIZE);
+    
+    for (uint64_t produced = 0; produced < entry.size;)
+    {
+        uint32_t chunkSize = static_cast<uint32_t>(std::min<uint64_t>(ARCHIVE_CHUNK_SIZE, entry.size - produced));
+        
+        if (end - stored < static_cast<ptrdiff_t>(sizeof(uint32_t)))
+            throw std::runtime_error("Corrupt archive entry!");
+        
+        uint32_t prefix = read32(stored);
+        stored += sizeof(uint32_t);
+        
+        uint32_t storedChunkSize = prefix & ~RAW_CHUNK_BIT;
+        
+        if (storedChunkSize > static_cast<size_t>(end - stored))
+            throw std::runtime_error("Corrupt archive entry!");
+        
+        // Chunks that did not compress are handed out straight from the mapping
+        if (prefix & RAW_CHUNK_BIT)
+        {
+            if (storedChunkSize != chunkSize)
+                throw std::runtime_error("Corrupt archive entry!");
+            
+            function(stored, chunkSize);
+        }
+        else
+        {
+            decompressChunk(stored, storedChunkSize, chunk.data(), chunkSize);
+            function(chunk.data(), chunkSize);
+        }
+        
+        stored += storedChunkSize;
+        produced += chunkSize;
+    }
+}
@@ -0,0 +1,109 @@
+//
+//  assetArchive.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef assetArchive_hpp
+#define assetArchive_hpp
+
+#include <stdio.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mappedFile.hpp"
+
+const uint32_t ARCHIVE_MAGIC = 0x4B415056; // "VPAK"
+const uint32_t ARCHIVE_VERSION = 1;
+
+// Entry data starts on this boundary so uncompressed SPIR-V can be used straight from the mapping
+const uint64_t ARCHIVE_ALIGNMENT = 16;
+
+// Compressed entries are split into chunks of this size so they can be streamed
+const uint32_t ARCHIVE_CHUNK_SIZE = 64 * 1024;
+
+enum class ArchiveCompression : uint32_t
+{
+    None = 0,
+    
+    // Byte oriented LZ77, every chunk prefixed by its stored size
+    Lz = 1
+};
+
+// Layout on disk: header, then bucketCount entries forming an open addressing hash table,
+// then the name table, then the entry data. Everything is little endian
+struct ArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t bucketCount;
+    uint64_t nameTableOffset;
+    uint64_t nameTableSize;
+};
+
+struct ArchiveEntry
+{
+    // 0 marks an empty bucket
+    uint64_t nameHash;
+    
+    uint64_t offset;
+    uint64_t size;
+    uint64_t storedSize;
+    
+    ArchiveCompression compression;
+    uint32_t nameOffset;
+};
+
+struct ArchiveSource
+{
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+uint64_t hashArchiveName(const std::string &name);
+
+// Compression is only kept for entries it makes smaller
+void writeAssetArchive(const std::string &path, const std::vector<ArchiveSource> &sources, bool compress);
+
+// Read-only view of an archive. The index is used in place from the mapping, so opening costs one
+// mmap and a lookup is a hash plus, almost always, a single probe
+class AssetArchive
+{
+public:
+    using ChunkFunction = std::function<void(const uint8_t* data, size_t size)>;
+    
+    void open(const std::string &path);
+    void close();
+    
+    bool isOpen() const { return header != nullptr; }
+    
+    const ArchiveEntry* find(const std::string &name) const;
+    
+    // Only for uncompressed entries, nullptr otherwise
+    const uint8_t* getData(const ArchiveEntry &entry) const;
+    
+    std::vector<uint8_t> read(const ArchiveEntry &entry) const;
+    
+    // Hands the entry to the callback in pieces of at most ARCHIVE_CHUNK_SIZE bytes without ever holding all of it
+    void stream(const ArchiveEntry &entry, const ChunkFunction &function) const;
+    
+    uint32_t getEntryCount() const { return header != nullptr ? header->entryCount : 0; }
+    const std::string &getPath() const { return archivePath; }
+
+private:
+    MappedFile file;
+    std::string archivePath;
+    
+    const ArchiveHeader* header = nullptr;
+    const ArchiveEntry* buckets = nullptr;
+    const char* names = nullptr;
+};
+
+#endif /* assetArchive_hpp */
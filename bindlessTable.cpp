@@ -0,0 +1,399 @@
+//
+//  bindlessTable.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "bindlessTable.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+DescriptorIndexingSupport queryDescriptorIndexingSupport(VkInstance instance, VkPhysicalDevice physicalDevice)
+{
+    DescriptorIndexingSupport support;
+    
+    auto getFeatures2 = (PFN_vkGetPhysicalDeviceFeatures2KHR) vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR");
+    auto getProperties2 = (PFN_vkGetPhysicalDeviceProperties2KHR) vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR");
+    
+    if (getFeatures2 == nullptr || getProperties2 == nullptr)
+        return support;
+    
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+    
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+    
+    auto hasExtension = [&](const char* name)
+    {
+        return std::any_of(extensions.begin(), extensions.end(), [name](const VkExtensionProperties &extension) { return strcmp(extension.extensionName, name) == 0; });
+    };
+    
+    // maintenance3 is a dependency of descriptor indexing
+    if (!hasExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) || !hasExtension(VK_KHR_MAINTENANCE3_EXTENSION_NAME))
+        return support;
+    
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    
+    VkPhysicalDeviceFeatures2 features {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features.pNext = &indexingFeatures;
+    
+    getFeatures2(physicalDevice, &features);
+    
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT required = getBindlessIndexingFeatures();
+    
+    if ((required.descriptorBindingPartiallyBound && !indexingFeatures.descriptorBindingPartiallyBound) ||
+        (required.descriptorBindingStorageBufferUpdateAfterBind && !indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind) ||
+        (required.descriptorBindingSampledImageUpdateAfterBind && !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind) ||
+        (required.descriptorBindingUpdateUnusedWhilePending && !indexingFeatures.descriptorBindingUpdateUnusedWhilePending))
+        return support;
+    
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties {};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    
+    VkPhysicalDeviceProperties2 properties {};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties.pNext = &indexingProperties;
+    
+    getProperties2(physicalDevice, &properties);
+    
+    support.supported = true;
+    support.maxStorageBuffers = std::min(indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers, indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers);
+    support.maxSampledImages = std::min(indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages);
+    
+    return support;
+}
+
+VkPhysicalDeviceDescriptorIndexingFeaturesEXT getBindlessIndexingFeatures()
+{
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT features {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    
+    // Handles come from push constants, so they are dynamically uniform and no non-uniform indexing is needed
+    features.descriptorBindingPartiallyBound = VK_TRUE;
+    features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    
+    return features;
+}
+
+// BINDLESS TABLE FUNCTIONS START
+
+void BindlessTable::create(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t slotCount, const DescriptorIndexingSupport &support)
+{
+    this->device = device;
+    this->slotCount = slotCount;
+    bindless = support.supported;
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    
+    ResourceArray &storageBuffers = getArray(BindlessResourceType::StorageBuffer);
+    ResourceArray &sampledImages = getArray(BindlessResourceType::SampledImage);
+    
+    if (bindless)
+    {
+        storageBuffers.capacity = std::min(MAX_BINDLESS_STORAGE_BUFFERS, support.maxStorageBuffers);
+        sampledImages.capacity = std::min(MAX_BINDLESS_SAMPLED_IMAGES, support.maxSampledImages);
+    }
+    else
+    {
+        storageBuffers.capacity = std::min({FALLBACK_BINDLESS_RESOURCES, properties.limits.maxPerStageDescriptorStorageBuffers, properties.limits.maxDescriptorSetStorageBuffers});
+        sampledImages.capacity = std::min({FALLBACK_BINDLESS_RESOURCES, properties.limits.maxPerStageDescriptorSampledImages, properties.limits.maxDescriptorSetSampledImages});
+    }
+    
+    storageBuffers.occupied.assign(storageBuffers.capacity, false);
+    sampledImages.occupied.assign(sampledImages.capacity, false);
+    
+    VkSamplerCreateInfo samplerInfo {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.maxLod = 1000.0f;
+    
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create bindless sampler!");
+    
+    const VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+    
+    VkDescriptorSetLayoutBinding bindings[3] {};
+    
+    bindings[0].binding = static_cast<uint32_t>(BindlessResourceType::StorageBuffer);
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = storageBuffers.capacity;
+    bindings[0].stageFlags = stages;
+    
+    bindings[1].binding = static_cast<uint32_t>(BindlessResourceType::SampledImage);
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[1].descriptorCount = sampledImages.capacity;
+    bindings[1].stageFlags = stages;
+    
+    bindings[2].binding = BINDLESS_SAMPLER_BINDING;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = stages;
+    bindings[2].pImmutableSamplers = &sampler;
+    
+    // Empty slots may stay unwritten, and slots no submitted frame reads may be written while those frames run
+    const VkDescriptorBindingFlagsEXT arrayFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+    VkDescriptorBindingFlagsEXT bindingFlags[3] = {arrayFlags, arrayFlags, 0};
+    
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = 3;
+    bindingFlagsInfo.pBindingFlags = bindingFlags;
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = bindless ? &bindingFlagsInfo : nullptr;
+    layoutInfo.flags = bindless ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT : 0;
+    layoutInfo.bindingCount = 3;
+    layoutInfo.pBindings = bindings;
+    
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create bindless descriptor set layout!");
+    
+    uint32_t setCount = bindless ? 1 : slotCount;
+    
+    VkDescriptorPoolSize poolSizes[3] {};
+    poolSizes[0] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBuffers.capacity * setCount};
+    poolSizes[1] = {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, sampledImages.capacity * setCount};
+    poolSizes[2] = {VK_DESCRIPTOR_TYPE_SAMPLER, setCount};
+    
+    VkDescriptorPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = bindless ? VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT : 0;
+    poolInfo.maxSets = setCount;
+    poolInfo.poolSizeCount = 3;
+    poolInfo.pPoolSizes = poolSizes;
+    
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create bindless descriptor pool!");
+    
+    std::vector<VkDescriptorSetLayout> setLayouts(setCount, setLayout);
+    descriptorSets.resize(setCount);
+    
+    VkDescriptorSetAllocateInfo allocateInfo {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = descriptorPool;
+    allocateInfo.descriptorSetCount = setCount;
+    allocateInfo.pSetLayouts = setLayouts.data();
+    
+    if (vkAllocateDescriptorSets(device, &allocateInfo, descriptorSets.data()) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate bindless descriptor sets!");
+    
+    pendingWrites.assign(bindless ? 0 : slotCount, {});
+}
+
+void BindlessTable::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+    
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    vkDestroySampler(device, sampler, nullptr);
+    
+    descriptorSets.clear();
+    pendingWrites.clear();
+    removedHandles.clear();
+    
+    arrays[0] = ResourceArray();
+    arrays[1] = ResourceArray();
+    
+    device = VK_NULL_HANDLE;
+}
+
+void BindlessTable::setDefaultStorageBuffer(VkBuffer buffer, VkDeviceSize range)
+{
+    PendingWrite defaultWrite {};
+    defaultWrite.type = BindlessResourceType::StorageBuffer;
+    defaultWrite.bufferInfo = {buffer, 0, range};
+    
+    setDefault(defaultWrite);
+}
+
+void BindlessTable::setDefaultSampledImage(VkImageView imageView)
+{
+    PendingWrite defaultWrite {};
+    defaultWrite.type = BindlessResourceType::SampledImage;
+    defaultWrite.imageInfo = {VK_NULL_HANDLE, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    
+    setDefault(defaultWrite);
+}
+
+void BindlessTable::setDefault(const PendingWrite &defaultWrite)
+{
+    // Partially bound arrays are fine with empty slots
+    if (bindless)
+        return;
+    
+    ResourceArray &array = getArray(defaultWrite.type);
+    array.hasDefault = true;
+    array.defaultWrite = defaultWrite;
+    
+    for (uint32_t handle = 0; handle < array.capacity; handle++)
+    {
+        if (array.occupied[handle])
+            continue;
+        
+        PendingWrite pendingWrite = defaultWrite;
+        pendingWrite.handle = handle;
+        
+        write(pendingWrite);
+    }
+}
+
+uint32_t BindlessTable::addStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    PendingWrite pendingWrite {};
+    pendingWrite.type = BindlessResourceType::StorageBuffer;
+    pendingWrite.handle = allocateHandle(pendingWrite.type);
+    pendingWrite.bufferInfo = {buffer, offset, range};
+    
+    write(pendingWrite);
+    
+    return pendingWrite.handle;
+}
+
+uint32_t BindlessTable::addSampledImage(VkImageView imageView, VkImageLayout layout)
+{
+    PendingWrite pendingWrite {};
+    pendingWrite.type = BindlessResourceType::SampledImage;
+    pendingWrite.handle = allocateHandle(pendingWrite.type);
+    pendingWrite.imageInfo = {VK_NULL_HANDLE, imageView, layout};
+    
+    write(pendingWrite);
+    
+    return pendingWrite.handle;
+}
+
+uint32_t BindlessTable::allocateHandle(BindlessResourceType type)
+{
+    ResourceArray &array = getArray(type);
+    uint32_t handle;
+    
+    if (!array.freeHandles.empty())
+    {
+        handle = array.freeHandles.back();
+        array.freeHandles.pop_back();
+    }
+    else if (array.nextHandle < array.capacity)
+        handle = array.nextHandle++;
+    else
+        throw std::runtime_error("Bindless table is full, it holds " + std::to_string(array.capacity) + " resources of each type!");
+    
+    array.occupied[handle] = true;
+    array.count++;
+    
+    return handle;
+}
+
+void BindlessTable::remove(BindlessResourceType type, uint32_t handle)
+{
+    ResourceArray &array = getArray(type);
+    
+    if (handle >= array.capacity || !array.occupied[handle])
+        throw std::runtime_error("Invalid bindless handle!");
+    
+    array.occupied[handle] = false;
+    array.count--;
+    
+    // The removed resource may be destroyed before the fallback copies are written again, so they get the default back
+    if (array.hasDefault)
+    {
+        PendingWrite pendingWrite = array.defaultWrite;
+        pendingWrite.handle = handle;
+        
+        write(pendingWrite);
+    }
+    
+    removedHandles.push_back({type, handle, frameNumber});
+}
+
+void BindlessTable::beginFrame(uint32_t slot)
+{
+    frameNumber++;
+    
+    // Every slot has begun once since the removal, so each frame that was in flight back then has retired
+    while (!removedHandles.empty() && frameNumber >= removedHandles.front().removedAtFrame + slotCount)
+    {
+        getArray(removedHandles.front().type).freeHandles.push_back(removedHandles.front().handle);
+        removedHandles.pop_front();
+    }
+    
+    if (bindless || pendingWrites[slot].empty())
+        return;
+    
+    writeSet(pendingWrites[slot], descriptorSets[slot]);
+    pendingWrites[slot].clear();
+}
+
+VkDescriptorSet BindlessTable::getDescriptorSet(uint32_t slot) const
+{
+    return bindless ? descriptorSets[0] : descriptorSets[slot];
+}
+
+uint32_t BindlessTable::getCapacity(BindlessResourceType type) const
+{
+    return arrays[static_cast<uint32_t>(type)].capacity;
+}
+
+uint32_t BindlessTable::getResourceCount(BindlessResourceType type) const
+{
+    return arrays[static_cast<uint32_t>(type)].count;
+}
+
+void BindlessTable::write(const PendingWrite &pendingWrite)
+{
+    // Update-after-bind allows writing slots that no pending command buffer uses
+    if (bindless)
+    {
+        writeSet({pendingWrite}, descriptorSets[0]);
+        return;
+    }
+    
+    for (auto &slotWrites : pendingWrites)
+        slotWrites.push_back(pendingWrite);
+}
+
+void BindlessTable::writeSet(const std::vector<PendingWrite> &writes, VkDescriptorSet descriptorSet) const
+{
+    std::vector<VkWriteDescriptorSet> descriptorWrites(writes.size());
+    
+    for (size_t i = 0; i < writes.size(); i++)
+    {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = descriptorSet;
+        descriptorWrites[i].dstBinding = static_cast<uint32_t>(writes[i].type);
+        descriptorWrites[i].dstArrayElement = writes[i].handle;
+        descriptorWrites[i].descriptorCount = 1;
+        
+        if (writes[i].type == BindlessResourceType::StorageBuffer)
+        {
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[i].pBufferInfo = &writes[i].bufferInfo;
+        }
+        else
+        {
+            descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            descriptorWrites[i].pImageInfo = &writes[i].imageInfo;
+        }
+    }
+    
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+// BINDLESS TABLE FUNCTIONS END
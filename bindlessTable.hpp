@@ -0,0 +1,146 @@
+//
+//  bindlessTable.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef bindlessTable_hpp
+#define bindlessTable_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+const uint32_t MAX_BINDLESS_STORAGE_BUFFERS = 65536;
+const uint32_t MAX_BINDLESS_SAMPLED_IMAGES = 65536;
+
+// Without descriptor indexing every slot of the array has to be written, so the arrays stay small
+const uint32_t FALLBACK_BINDLESS_RESOURCES = 256;
+
+const uint32_t INVALID_BINDLESS_HANDLE = UINT32_MAX;
+
+// Binding of each array in the table's set, handles index into them
+enum class BindlessResourceType : uint32_t
+{
+    StorageBuffer = 0,
+    SampledImage = 1
+};
+
+// Binding 2 is a single immutable sampler shared by every sampled image
+const uint32_t BINDLESS_SAMPLER_BINDING = 2;
+
+// What the device offers for update-after-bind arrays
+struct DescriptorIndexingSupport
+{
+    bool supported = false;
+    
+    uint32_t maxStorageBuffers = 0;
+    uint32_t maxSampledImages = 0;
+};
+
+// Needs VK_KHR_get_physical_device_properties2 on the instance, without it this reports no support
+DescriptorIndexingSupport queryDescriptorIndexingSupport(VkInstance instance, VkPhysicalDevice physicalDevice);
+
+// The features the table relies on, chained into VkDeviceCreateInfo when the extension is enabled
+VkPhysicalDeviceDescriptorIndexingFeaturesEXT getBindlessIndexingFeatures();
+
+// One descriptor set holding every storage buffer and sampled image, shaders pick one with a handle from push constants.
+// With descriptor indexing the set is update-after-bind and written in place. Without it there is a copy per frame slot
+// and each write reaches a copy in beginFrame(), once the frame that last used that copy has retired
+class BindlessTable
+{
+public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t slotCount, const DescriptorIndexingSupport &support);
+    void destroy();
+    
+    // Fallback only: a valid descriptor for every slot that holds no resource, as those are not allowed to be left empty
+    void setDefaultStorageBuffer(VkBuffer buffer, VkDeviceSize range);
+    void setDefaultSampledImage(VkImageView imageView);
+    
+    // The handle is valid in shaders from the next beginFrame(), or immediately with descriptor indexing
+    uint32_t addStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+    uint32_t addSampledImage(VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    
+    // The handle is only handed out again once every frame that could still read it has retired
+    void remove(BindlessResourceType type, uint32_t handle);
+    
+    // Call after the slot's fence has been waited on and before anything is recorded for it
+    void beginFrame(uint32_t slot);
+    
+    VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+    VkDescriptorSet getDescriptorSet(uint32_t slot) const;
+    
+    bool isBindless() const { return bindless; }
+    
+    // Array size of each binding, shaders declare theirs with a specialization constant of this value
+    uint32_t getCapacity(BindlessResourceType type) const;
+    uint32_t getResourceCount(BindlessResourceType type) const;
+
+private:
+    struct PendingWrite
+    {
+        BindlessResourceType type;
+        uint32_t handle;
+        
+        VkDescriptorBufferInfo bufferInfo;
+        VkDescriptorImageInfo imageInfo;
+    };
+    
+    struct RemovedHandle
+    {
+        BindlessResourceType type;
+        uint32_t handle;
+        uint64_t removedAtFrame;
+    };
+    
+    struct ResourceArray
+    {
+        uint32_t capacity = 0;
+        uint32_t nextHandle = 0;
+        uint32_t count = 0;
+        
+        std::vector<uint32_t> freeHandles;
+        std::vector<bool> occupied;
+        
+        // Fallback only, written to every slot that holds no resource
+        bool hasDefault = false;
+        PendingWrite defaultWrite;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    uint32_t slotCount = 0;
+    bool bindless = false;
+    
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+    
+    // A single set with descriptor indexing, one per slot otherwise
+    std::vector<VkDescriptorSet> descriptorSets;
+    
+    // Writes every fallback copy still has to receive, one queue per slot
+    std::vector<std::vector<PendingWrite>> pendingWrites;
+    
+    ResourceArray arrays[2];
+    
+    std::deque<RemovedHandle> removedHandles;
+    uint64_t frameNumber = 0;
+    
+    ResourceArray &getArray(BindlessResourceType type) { return arrays[static_cast<uint32_t>(type)]; }
+    
+    uint32_t allocateHandle(BindlessResourceType type);
+    void setDefault(const PendingWrite &defaultWrite);
+    
+    void write(const PendingWrite &pendingWrite);
+    void writeSet(const std::vector<PendingWrite> &writes, VkDescriptorSet descriptorSet) const;
+};
+
+#endif /* bindlessTable_hpp */
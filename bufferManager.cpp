@@ -0,0 +1,454 @@
+//
+//  bufferManager.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "bufferManager.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+void BufferManager::create(VkPhysicalDevice physicalDevice, VkDevice device, DeviceMemoryAllocator* memoryAllocator, uint32_t graphicsFamily, uint32_t transferFamily, VkQueue transferQueue, VkDeviceSize stagingSize)
+{
+    this->device = device;
+    this->memoryAllocator = memoryAllocator;
+    this->graphicsFamily = graphicsFamily;
+    this->transferFamily = transferFamily;
+    this->transferQueue = transferQueue;
+    this->stagingSize = stagingSize;
+    
+    sharedFamilies = {graphicsFamily};
+    shareWithQueueFamily(transferFamily);
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    
+    copyAlignment = std::max<VkDeviceSize>(properties.limits.optimalBufferCopyOffsetAlignment, 16);
+    
+    // Coherent memory mapped once for the lifetime of the ring, so writing to it is a plain memcpy
+    stagingBuffer = createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    stagingData = static_cast<char*>(stagingBuffer.allocation.mapped);
+    
+    for (auto &batch : batches)
+    {
+        VkCommandPoolCreateInfo poolInfo {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = transferFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &batch.commandPool) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create upload command pool!");
+        
+        VkCommandBufferAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = batch.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        
+        if (vkAllocateCommandBuffers(device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create upload command buffer!");
+        
+        VkFenceCreateInfo fenceInfo {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        
+        VkSemaphoreCreateInfo semaphoreInfo {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        
+        if (vkCreateFence(device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS || vkCreateSemaphore(device, &semaphoreInfo, nullptr, &batch.semaphore) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create upload sync objects!");
+    }
+}
+
+void BufferManager::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+    
+    waitIdle();
+    
+    for (const auto &batch : batches)
+    {
+        vkDestroySemaphore(device, batch.semaphore, nullptr);
+        vkDestroyFence(device, batch.fence, nullptr);
+        vkDestroyCommandPool(device, batch.commandPool, nullptr);
+    }
+    
+    destroyBuffer(stagingBuffer);
+    
+    device = VK_NULL_HANDLE;
+}
+
+DeviceBuffer BufferManager::createDeviceBuffer(VkDeviceSize size, VkBufferUsageFlags usage)
+{
+    return createBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void BufferManager::destroyBuffer(DeviceBuffer &buffer)
+{
+    vkDestroyBuffer(device, buffer.buffer, nullptr);
+    memoryAllocator->free(buffer.allocation);
+    
+    buffer = DeviceBuffer();
+}
+
+DeviceImage BufferManager::createDeviceImage(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, VkImageUsageFlags usage)
+{
+    DeviceImage image;
+    image.format = format;
+    image.extent = {width, height};
+    image.mipLevels = mipLevels;
+    
+    VkImageCreateInfo imageInfo {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = {width, height, 1};
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    
+    // Concurrent like the buffers, so the layout transitions done on the transfer queue need no ownership transfer
+    if (sharedFamilies.size() > 1)
+    {
+        imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharedFamilies.size());
+        imageInfo.pQueueFamilyIndices = sharedFamilies.data();
+    }
+    else
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    
+    if (vkCreateImage(device, &imageInfo, nullptr, &image.image) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create image!");
+    
+    image.allocation = memoryAllocator->allocateForImage(image.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    
+    return image;
+}
+
+void BufferManager::destroyImage(DeviceImage &image)
+{
+    vkDestroyImage(device, image.image, nullptr);
+    memoryAllocator->free(image.allocation);
+    
+    image = DeviceImage();
+}
+
+void BufferManager::shareWithQueueFamily(uint32_t queueFamily)
+{
+    if (std::find(sharedFamilies.begin(), sharedFamilies.end(), queueFamily) == sharedFamilies.end())
+        sharedFamilies.push_back(queueFamily);
+}
+
+void BufferManager::upload(const DeviceBuffer &destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size)
+{
+    if (destinationOffset + size > destination.size)
+        throw std::runtime_error("Upload does not fit in the destination buffer!");
+    
+    stats.uploads++;
+    stats.bytesUploaded += size;
+    
+    const char* source = static_cast<const char*>(data);
+    
+    // Large uploads go through in pieces so the ring can keep cycling while earlier pieces copy
+    VkDeviceSize maxChunk = stagingSize / UPLOAD_BATCH_COUNT;
+    
+    while (size > 0)
+    {
+        VkDeviceSize chunk = std::min(size, maxChunk);
+        VkDeviceSize stagingOffset = allocateStaging(chunk);
+        
+        memcpy(stagingData + stagingOffset, source, chunk);
+        
+        // Back to back uploads into one buffer usually land back to back in the ring too, so they share a region
+        std::vector<PendingCopy> &copies = batches[currentBatch].copies;
+        
+        if (!copies.empty() && copies.back().destination == destination.buffer && copies.back().region.srcOffset + copies.back().region.size == stagingOffset && copies.back().region.dstOffset + copies.back().region.size == destinationOffset)
+            copies.back().region.size += chunk;
+        else
+            copies.push_back({destination.buffer, {stagingOffset, destinationOffset, chunk}});
+        
+        source += chunk;
+        destinationOffset += chunk;
+        size -= chunk;
+        
+        // Submitting each slice of the ring keeps the copy engine busy while the CPU fills the next quarter
+        if (batches[currentBatch].ringBytes >= maxChunk)
+            flush();
+    }
+}
+
+void BufferManager::uploadImage(const DeviceImage &destination, uint32_t mipLevel, uint32_t blockHeight, VkDeviceSize rowPitch, const void* data)
+{
+    uint32_t width = std::max(destination.extent.width >> mipLevel, 1u);
+    uint32_t height = std::max(destination.extent.height >> mipLevel, 1u);
+    uint32_t rows = (height + blockHeight - 1) / blockHeight;
+    
+    VkDeviceSize maxChunk = stagingSize / UPLOAD_BATCH_COUNT;
+    
+    if (rowPitch > maxChunk)
+        throw std::runtime_error("Image row does not fit in the staging ring!");
+    
+    uint32_t rowsPerChunk = static_cast<uint32_t>(maxChunk / rowPitch);
+    const char* source = static_cast<const char*>(data);
+    
+    stats.uploads++;
+    stats.bytesUploaded += rows * rowPitch;
+    
+    for (uint32_t row = 0; row < rows; row += rowsPerChunk)
+    {
+        uint32_t rowCount = std::min(rowsPerChunk, rows - row);
+        VkDeviceSize chunk = rowCount * rowPitch;
+        VkDeviceSize stagingOffset = allocateStaging(chunk);
+        
+        memcpy(stagingData + stagingOffset, source + row * rowPitch, chunk);
+        
+        // A row length of 0 means the rows are tightly packed, which is what rowPitch describes
+        VkBufferImageCopy region {};
+        region.bufferOffset = stagingOffset;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 0, 1};
+        region.imageOffset = {0, static_cast<int32_t>(row * blockHeight), 0};
+        region.imageExtent = {width, std::min(rowCount * blockHeight, height - row * blockHeight), 1};
+        
+        batches[currentBatch].imageCopies.push_back({destination.image, region, row == 0});
+        
+        if (batches[currentBatch].ringBytes >= maxChunk)
+            flush();
+    }
+}
+
+void BufferManager::flush(VkSemaphore* graphicsWait)
+{
+    UploadBatch &batch = batches[currentBatch];
+    
+    if (graphicsWait != nullptr)
+        *graphicsWait = VK_NULL_HANDLE;
+    
+    // An empty batch still goes out when a semaphore is asked for and copies submitted earlier were not covered by one
+    if (batch.copies.empty() && batch.imageCopies.empty() && (graphicsWait == nullptr || !unsignaledSubmits))
+        return;
+    
+    vkResetCommandPool(device, batch.commandPool, 0);
+    
+    VkCommandBufferBeginInfo beginInfo {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    
+    if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("Failed to begin recording upload command buffer!");
+    
+    // Runs of copies into the same buffer go out as a single command
+    std::vector<VkBufferCopy> regions;
+    
+    for (size_t i = 0; i < batch.copies.size(); i++)
+    {
+        regions.push_back(batch.copies[i].region);
+        
+        if (i + 1 == batch.copies.size() || batch.copies[i + 1].destination != batch.copies[i].destination)
+        {
+            vkCmdCopyBuffer(batch.commandBuffer, stagingBuffer.buffer, batch.copies[i].destination, static_cast<uint32_t>(regions.size()), regions.data());
+            regions.clear();
+        }
+    }
+    
+    recordImageCopies(batch);
+    
+    if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to record upload command buffer!");
+    
+    VkSubmitInfo submitInfo {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    
+    // The semaphore orders the copies before the graphics work that reads them, the fence frees the ring space
+    submitInfo.signalSemaphoreCount = graphicsWait != nullptr ? 1 : 0;
+    submitInfo.pSignalSemaphores = &batch.semaphore;
+    
+    if (vkQueueSubmit(transferQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to submit upload command buffer!");
+    
+    stats.copyRegions += batch.copies.size() + batch.imageCopies.size();
+    stats.submits++;
+    
+    batch.copies.clear();
+    batch.imageCopies.clear();
+    batch.submitted = true;
+    
+    unsignaledSubmits = graphicsWait == nullptr;
+    
+    if (graphicsWait != nullptr)
+        *graphicsWait = batch.semaphore;
+    
+    currentBatch = (currentBatch + 1) % UPLOAD_BATCH_COUNT;
+}
+
+void BufferManager::waitIdle()
+{
+    flush();
+    
+    while (retireOldestBatch());
+    
+    // Everything has completed, there is nothing left a semaphore would have to cover
+    unsignaledSubmits = false;
+}
+
+void BufferManager::recordImageCopies(const UploadBatch &batch)
+{
+    if (batch.imageCopies.empty())
+        return;
+    
+    // One transition per level touched, the earliest copy into a level decides whether its contents can be discarded
+    std::vector<VkImageMemoryBarrier> barriers;
+    
+    for (const auto &copy : batch.imageCopies)
+    {
+        uint32_t mipLevel = copy.region.imageSubresource.mipLevel;
+        
+        bool seen = std::any_of(barriers.begin(), barriers.end(), [&](const VkImageMemoryBarrier &barrier)
+        {
+            return barrier.image == copy.destination && barrier.subresourceRange.baseMipLevel == mipLevel;
+        });
+        
+        if (seen)
+            continue;
+        
+        VkImageMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = copy.firstBand ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = copy.firstBand ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = copy.destination;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, 0, 1};
+        
+        barriers.push_back(barrier);
+    }
+    
+    vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+    
+    std::vector<VkBufferImageCopy> regions;
+    
+    for (size_t i = 0; i < batch.imageCopies.size(); i++)
+    {
+        regions.push_back(batch.imageCopies[i].region);
+        
+        if (i + 1 == batch.imageCopies.size() || batch.imageCopies[i + 1].destination != batch.imageCopies[i].destination)
+        {
+            vkCmdCopyBufferToImage(batch.commandBuffer, stagingBuffer.buffer, batch.imageCopies[i].destination, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+            regions.clear();
+        }
+    }
+    
+    // Graphics reads them after waiting on the batch semaphore, a later batch writing more bands chains on the transfer stage
+    for (auto &barrier : barriers)
+    {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+    
+    vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+VkDeviceSize BufferManager::allocateStaging(VkDeviceSize size)
+{
+    while (true)
+    {
+        // An empty ring starts over at the front so a chunk never has to wrap around
+        if (ringUsed == 0)
+            ringHead = 0;
+        
+        VkDeviceSize offset = (ringHead + copyAlignment - 1) / copyAlignment * copyAlignment;
+        VkDeviceSize padding = offset - ringHead;
+        
+        // Chunks are never split across the end of the ring, the leftover bytes are skipped instead
+        if (offset + size > stagingSize)
+        {
+            padding = stagingSize - ringHead;
+            offset = 0;
+        }
+        
+        if (ringUsed + padding + size <= stagingSize)
+        {
+            UploadBatch &batch = batches[currentBatch];
+            
+            if (batch.submitted)
+                retireBatch(batch);
+            
+            ringHead = offset + size;
+            ringUsed += padding + size;
+            batch.ringBytes += padding + size;
+            
+            return offset;
+        }
+        
+        // Out of space: free the oldest batch, or submit what is queued so far so it can be freed next time around
+        if (!retireOldestBatch())
+            flush();
+    }
+}
+
+bool BufferManager::retireOldestBatch()
+{
+    // Batches are submitted round robin, so the oldest one in flight is the first submitted one from the current slot on
+    for (uint32_t i = 0; i < UPLOAD_BATCH_COUNT; i++)
+    {
+        UploadBatch &batch = batches[(currentBatch + i) % UPLOAD_BATCH_COUNT];
+        
+        if (batch.submitted)
+        {
+            retireBatch(batch);
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void BufferManager::retireBatch(UploadBatch &batch)
+{
+    vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(device, 1, &batch.fence);
+    
+    ringUsed -= batch.ringBytes;
+    batch.ringBytes = 0;
+    batch.submitted = false;
+}
+
+DeviceBuffer BufferManager::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+{
+    DeviceBuffer buffer;
+    buffer.size = size;
+    
+    VkBufferCreateInfo bufferInfo {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    
+    // Concurrent sharing costs little for buffers and saves a release/acquire barrier pair per upload
+    if (sharedFamilies.size() > 1)
+    {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(sharedFamilies.size());
+        bufferInfo.pQueueFamilyIndices = sharedFamilies.data();
+    }
+    else
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer.buffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create buffer!");
+    
+    buffer.allocation = memoryAllocator->allocateForBuffer(buffer.buffer, properties);
+    
+    return buffer;
+}
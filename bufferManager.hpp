@@ -0,0 +1,157 @@
+//
+//  bufferManager.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef bufferManager_hpp
+#define bufferManager_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <stdio.h>
+#include <vector>
+
+#include "memoryAllocator.hpp"
+
+const VkDeviceSize DEFAULT_STAGING_RING_SIZE = 16 * 1024 * 1024;
+
+// Submitted batches the staging ring can have in flight before an upload has to wait on the oldest
+const uint32_t UPLOAD_BATCH_COUNT = 4;
+
+struct DeviceBuffer
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    MemoryAllocation allocation;
+    VkDeviceSize size = 0;
+};
+
+// Optimally tiled and sampled, every level is in SHADER_READ_ONLY_OPTIMAL once its upload has been flushed
+struct DeviceImage
+{
+    VkImage image = VK_NULL_HANDLE;
+    MemoryAllocation allocation;
+    
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent {};
+    uint32_t mipLevels = 0;
+};
+
+struct UploadStats
+{
+    VkDeviceSize bytesUploaded = 0;
+    uint64_t uploads = 0;
+    uint64_t copyRegions = 0;
+    uint64_t submits = 0;
+};
+
+// Owns every device-local vertex/index buffer and the one path data takes to reach them:
+// a persistently mapped staging ring copied from on the transfer queue
+class BufferManager
+{
+public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, DeviceMemoryAllocator* memoryAllocator, uint32_t graphicsFamily, uint32_t transferFamily, VkQueue transferQueue, VkDeviceSize stagingSize = DEFAULT_STAGING_RING_SIZE);
+    void destroy();
+    
+    // Device local and a copy destination, shared with the graphics family when the transfer family is a different one
+    DeviceBuffer createDeviceBuffer(VkDeviceSize size, VkBufferUsageFlags usage);
+    void destroyBuffer(DeviceBuffer &buffer);
+    
+    // Device local, sampled and a copy destination, shared the same way as the buffers
+    DeviceImage createDeviceImage(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, VkImageUsageFlags usage);
+    void destroyImage(DeviceImage &image);
+    
+    // Copies the data into the staging ring and queues the copy, nothing reaches the GPU until flush
+    void upload(const DeviceBuffer &destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size);
+    
+    // Queues one whole mip level, given as tightly packed rows of texel blocks rowPitch bytes apart. A level larger
+    // than a slice of the ring goes through in bands of block rows. Upload each level of an image once
+    void uploadImage(const DeviceImage &destination, uint32_t mipLevel, uint32_t blockHeight, VkDeviceSize rowPitch, const void* data);
+    
+    // Submits the queued copies. A semaphore handed out through graphicsWait must be waited on by a graphics submit
+    // before the next flush that asks for one
+    void flush(VkSemaphore* graphicsWait = nullptr);
+    
+    // Blocks until every submitted copy has finished and releases the whole ring
+    void waitIdle();
+    
+    // Buffers created afterwards can also be used from this family, e.g. by async compute
+    void shareWithQueueFamily(uint32_t queueFamily);
+    
+    bool hasDedicatedTransferQueue() const { return graphicsFamily != transferFamily; }
+    
+    const UploadStats &getStats() const { return stats; }
+    void resetStats() { stats = UploadStats(); }
+
+private:
+    struct PendingCopy
+    {
+        VkBuffer destination;
+        VkBufferCopy region;
+    };
+    
+    struct PendingImageCopy
+    {
+        VkImage destination;
+        VkBufferImageCopy region;
+        
+        // The first band of a level may discard whatever the level held, later ones keep the bands before them
+        bool firstBand;
+    };
+    
+    struct UploadBatch
+    {
+        VkCommandPool commandPool;
+        VkCommandBuffer commandBuffer;
+        VkFence fence;
+        VkSemaphore semaphore;
+        
+        std::vector<PendingCopy> copies;
+        std::vector<PendingImageCopy> imageCopies;
+        
+        // Ring space this batch keeps alive until its fence signals, padding included
+        VkDeviceSize ringBytes = 0;
+        bool submitted = false;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    DeviceMemoryAllocator* memoryAllocator = nullptr;
+    
+    uint32_t graphicsFamily = 0;
+    uint32_t transferFamily = 0;
+    VkQueue transferQueue = VK_NULL_HANDLE;
+    
+    // Every family buffers are shared between, more than one switches them to concurrent sharing
+    std::vector<uint32_t> sharedFamilies;
+    
+    DeviceBuffer stagingBuffer;
+    char* stagingData = nullptr;
+    
+    VkDeviceSize stagingSize = 0;
+    VkDeviceSize copyAlignment = 1;
+    VkDeviceSize ringHead = 0;
+    VkDeviceSize ringUsed = 0;
+    
+    std::array<UploadBatch, UPLOAD_BATCH_COUNT> batches;
+    uint32_t currentBatch = 0;
+    
+    UploadStats stats;
+    
+    // Set while submitted copies have not been followed by a semaphore the graphics queue waits on
+    bool unsignaledSubmits = false;
+    
+    VkDeviceSize allocateStaging(VkDeviceSize size);
+    void recordImageCopies(const UploadBatch &batch);
+    bool retireOldestBatch();
+    void retireBatch(UploadBatch &batch);
+    
+    DeviceBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+};
+
+#endif /* bufferManager_hpp */
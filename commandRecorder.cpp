@@ -0,0 +1,169 @@
+//
+//  commandRecorder.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "commandRecorder.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <stdexcept>
+
+void ParallelCommandRecorder::create(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount, ThreadPool* threadPool)
+{
+    this->device = device;
+    this->threadPool = threadPool;
+    
+    frames.resize(frameCount);
+    
+    for (auto &frame : frames)
+    {
+        frame.primaryPool = createTransientPool(queueFamilyIndex);
+        frame.primaryBuffer = allocateBuffer(frame.primaryPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        
+        frame.workerPools.resize(threadPool->getThreadCount());
+        frame.workerBuffers.resize(threadPool->getThreadCount());
+        
+        for (size_t i = 0; i < frame.workerPools.size(); i++)
+        {
+            frame.workerPools[i] = createTransientPool(queueFamilyIndex);
+            frame.workerBuffers[i] = allocateBuffer(frame.workerPools[i], VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+        }
+    }
+}
+
+void ParallelCommandRecorder::destroy()
+{
+    // Destroying a pool frees every buffer allocated from it
+    for (const auto &frame : frames)
+    {
+        vkDestroyCommandPool(device, frame.primaryPool, nullptr);
+        
+        for (auto pool : frame.workerPools)
+            vkDestroyCommandPool(device, pool, nullptr);
+    }
+    
+    frames.clear();
+}
+
+VkCommandBuffer ParallelCommandRecorder::beginFrame(uint32_t frameSlot)
+{
+    currentSlot = frameSlot;
+    
+    FrameCommands &frame = frames[frameSlot];
+    
+    // One reset per pool is far cheaper than resetting every buffer individually
+    vkResetCommandPool(device, frame.primaryPool, 0);
+    
+    for (auto pool : frame.workerPools)
+        vkResetCommandPool(device, pool, 0);
+    
+    return frame.primaryBuffer;
+}
+
+const std::vector<VkCommandBuffer> &ParallelCommandRecorder::recordSecondaries(const VkCommandBufferInheritanceInfo &inheritance, uint32_t drawCount, const RecordFunction &record)
+{
+    FrameCommands &frame = frames[currentSlot];
+    
+    uint32_t workers = static_cast<uint32_t>(frame.workerBuffers.size());
+    
+    if (maxWorkers != 0)
+        workers = std::min(workers, maxWorkers);
+    
+    workers = std::max(1u, std::min(workers, (drawCount + MIN_DRAWS_PER_WORKER - 1) / MIN_DRAWS_PER_WORKER));
+    
+    auto recordRange = [&](uint32_t worker)
+    {
+        uint32_t firstDraw = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * worker / workers);
+        uint32_t lastDraw = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * (worker + 1) / workers);
+        
+        VkCommandBuffer commandBuffer = frame.workerBuffers[worker];
+        
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = &inheritance;
+        
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+            throw std::runtime_error("Failed to begin recording secondary command buffer!");
+        
+        record(commandBuffer, worker, firstDraw, lastDraw - firstDraw);
+        
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to record secondary command buffer!");
+    };
+    
+    // The calling thread takes the first range itself instead of idling on the others
+    std::vector<std::future<void>> pending;
+    pending.reserve(workers - 1);
+    
+    for (uint32_t worker = 1; worker < workers; worker++)
+        pending.push_back(threadPool->submit([&recordRange, worker]() { recordRange(worker); }));
+    
+    std::exception_ptr error;
+    
+    try
+    {
+        recordRange(0);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    
+    // Every worker has to finish before anything it captured goes out of scope
+    for (auto &result : pending)
+    {
+        try
+        {
+            result.get();
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+    
+    if (error)
+        std::rethrow_exception(error);
+    
+    recordedBuffers.assign(frame.workerBuffers.begin(), frame.workerBuffers.begin() + workers);
+    
+    return recordedBuffers;
+}
+
+VkCommandPool ParallelCommandRecorder::createTransientPool(uint32_t queueFamilyIndex) const
+{
+    VkCommandPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    
+    VkCommandPool pool;
+    
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create command pool!");
+    
+    return pool;
+}
+
+VkCommandBuffer ParallelCommandRecorder::allocateBuffer(VkCommandPool pool, VkCommandBufferLevel level) const
+{
+    VkCommandBufferAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = pool;
+    allocInfo.level = level;
+    allocInfo.commandBufferCount = 1;
+    
+    VkCommandBuffer commandBuffer;
+    
+    if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create command buffers!");
+    
+    return commandBuffer;
+}
@@ -0,0 +1,71 @@
+//
+//  commandRecorder.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef commandRecorder_hpp
+#define commandRecorder_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <functional>
+#include <stdio.h>
+#include <vector>
+
+#include "threadPool.hpp"
+
+// Below this many draws per worker the hand-off costs more than the recording saves
+const uint32_t MIN_DRAWS_PER_WORKER = 512;
+
+// Per-frame transient command pools, one primary pool plus one pool per worker so no pool is ever shared between threads
+class ParallelCommandRecorder
+{
+public:
+    // Records draws [firstDraw, firstDraw + drawCount) into a secondary buffer that has already been begun. Worker 0 is
+    // the calling thread, no two ranges of a frame share a worker index
+    using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t worker, uint32_t firstDraw, uint32_t drawCount)>;
+    
+    void create(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount, ThreadPool* threadPool);
+    void destroy();
+    
+    // Resets every pool of the slot, so the fence of that slot must already have been waited on
+    VkCommandBuffer beginFrame(uint32_t frameSlot);
+    
+    // Splits the draw list across the workers, the returned buffers are ready for vkCmdExecuteCommands
+    const std::vector<VkCommandBuffer> &recordSecondaries(const VkCommandBufferInheritanceInfo &inheritance, uint32_t drawCount, const RecordFunction &record);
+    
+    // Caps how many workers a frame may use, 0 lifts the cap
+    void setMaxWorkers(uint32_t workers) { maxWorkers = workers; }
+    
+    uint32_t getWorkerCount() const { return threadPool != nullptr ? threadPool->getThreadCount() : 0; }
+
+private:
+    struct FrameCommands
+    {
+        VkCommandPool primaryPool;
+        VkCommandBuffer primaryBuffer;
+        
+        std::vector<VkCommandPool> workerPools;
+        std::vector<VkCommandBuffer> workerBuffers;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    ThreadPool* threadPool = nullptr;
+    
+    std::vector<FrameCommands> frames;
+    uint32_t currentSlot = 0;
+    uint32_t maxWorkers = 0;
+    
+    std::vector<VkCommandBuffer> recordedBuffers;
+    
+    VkCommandPool createTransientPool(uint32_t queueFamilyIndex) const;
+    VkCommandBuffer allocateBuffer(VkCommandPool pool, VkCommandBufferLevel level) const;
+};
+
+#endif /* commandRecorder_hpp */
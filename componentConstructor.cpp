@@ -23,7 +23,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL ApplicationComponentConstructor::debugCallback(Vk
 // STATIC FUNCTION MEMBERS END
 
 // INSTANCE CREATION FUNCTIONS START
-VkInstance* ApplicationComponentConstructor::createInstance() const
+VkInstance* ApplicationComponentConstructor::createInstance(const bool &headless) const
 {
     VkInstance* newInstance = new VkInstance;
     
@@ -44,7 +44,7 @@ VkInstance* ApplicationComponentConstructor::createInstance() const
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
     
-    auto extensions = helper.getRequiredExtensions(enableValidationLayers);
+    auto extensions = helper.getRequiredExtensions(enableValidationLayers, headless);
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
     
@@ -131,7 +131,9 @@ std::pair<VkDevice*, VkQueue*> ApplicationComponentConstructor::createLogicalDev
     VkDevice* newDevice = new VkDevice;
     VkQueue* newGraphicsQueue = new VkQueue;
     
-    QueueFamilyIndices indices = helper.findQueueFamilies(device, (*surface));
+    bool headless = surface == nullptr;
+    
+    QueueFamilyIndices indices = helper.findQueueFamilies(device, headless ? VK_NULL_HANDLE : (*surface));
     
     VkDeviceQueueCreateInfo queueCreateInfo {};
     queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -149,8 +151,10 @@ std::pair<VkDevice*, VkQueue*> ApplicationComponentConstructor::createLogicalDev
     createInfo.queueCreateInfoCount = 1;
     
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    
+    std::vector<const char*> extensions = helper.getRequiredDeviceExtensions(headless);
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
     
     if (enableValidationLayers)
     {
@@ -165,9 +169,53 @@ std::pair<VkDevice*, VkQueue*> ApplicationComponentConstructor::createLogicalDev
     
     return std::make_pair(newDevice, newGraphicsQueue);
 }
+// LOGICAL DEVICE CREATION FUNCTIONS END
+
+// MEMORY ALLOCATOR CREATION FUNCTIONS START
+void ApplicationComponentConstructor::createMemoryAllocator(VkPhysicalDevice const &physicalDevice, VkDevice* const device)
+{
+    memoryAllocator.create(physicalDevice, (*device));
+}
+
+void ApplicationComponentConstructor::destroyMemoryAllocator()
+{
+    memoryAllocator.destroy();
+}
+// MEMORY ALLOCATOR CREATION FUNCTIONS END
+
+// OFFSCREEN TARGET CREATION FUNCTIONS START
+std::pair<std::vector<VkImage>, std::vector<MemoryAllocation>> ApplicationComponentConstructor::createOffscreenImages(VkDevice* const device, VkFormat const format, VkExtent2D const extent, uint32_t const imageCount)
+{
+    std::vector<VkImage> newImages(imageCount);
+    std::vector<MemoryAllocation> newImageMemory(imageCount);
+    
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
+        VkImageCreateInfo createInfo {};
+        createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        createInfo.imageType = VK_IMAGE_TYPE_2D;
+        createInfo.format = format;
+        createInfo.extent = {extent.width, extent.height, 1};
+        createInfo.mipLevels = 1;
+        createInfo.arrayLayers = 1;
+        createInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        createInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        createInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        
+        if (vkCreateImage((*device), &createInfo, nullptr, &newImages[i]) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create offscreen image!");
+        
+        newImageMemory[i] = memoryAllocator.allocateForImage(newImages[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+    
+    return std::make_pair(newImages, newImageMemory);
+}
+// OFFSCREEN TARGET CREATION FUNCTIONS END
 
 // SWAPCHAIN CREATION FUNCTIONS START
-std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> ApplicationComponentConstructor::createSwapChain(VkPhysicalDevice const &physicalDevice, VkDevice* const device, VkSurfaceKHR* const surface) const
+std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> ApplicationComponentConstructor::createSwapChain(VkPhysicalDevice const &physicalDevice, VkDevice* const device, VkSurfaceKHR* const surface, GLFWwindow* const window, VkSwapchainKHR const oldSwapChain) const
 {
     VkSwapchainKHR newSwapChain;
     
@@ -175,7 +223,7 @@ std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> ApplicationComponentC
     
     VkSurfaceFormatKHR surfaceFormat = helper.chooseSwapSurfaceFormat(swapChainSupport.formats);
     VkPresentModeKHR presentMode = helper.chooseSwapSurfacePresentMode(swapChainSupport.presentModes);
-    VkExtent2D extent = helper.chooseSwapSurfaceExtent(swapChainSupport.capabilities);
+    VkExtent2D extent = helper.chooseSwapSurfaceExtent(swapChainSupport.capabilities, window);
     
     uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
     
@@ -212,7 +260,7 @@ std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> ApplicationComponentC
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = oldSwapChain;
     
     if (vkCreateSwapchainKHR((*device), &createInfo, nullptr, &newSwapChain) != VK_SUCCESS)
         throw std::runtime_error("Failed to create swapchain!");
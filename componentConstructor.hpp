@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "helper.hpp"
+#include "memoryAllocator.hpp"
 
 #ifdef NDEBUG
     const bool enableValidationLayers = false;
@@ -34,18 +35,19 @@ private:
     // Instance of application helper to assist in information retrieval
     ApplicationHelper helper;
     
+    // Every image and buffer the constructor creates is sub-allocated from here
+    DeviceMemoryAllocator memoryAllocator;
+    
     // Start of static helper functions
     using VkDUMessageSeverity = VkDebugUtilsMessageSeverityFlagBitsEXT;
     using VkDUMessageType = VkDebugUtilsMessageTypeFlagsEXT;
     using VkDUMCallBackData = VkDebugUtilsMessengerCallbackDataEXT;
     
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDUMessageSeverity messageSeverity, VkDUMessageType messageType, const VkDUMCallBackData* pCallBackData, void* pUserData);
-    
-    static std::vector<char> readFile(const std::string &fileName);
     // End of static helper functions
     
     // INSTANCE CREATION FUNCTIONS
-    VkInstance* createInstance() const;
+    VkInstance* createInstance(const bool &headless) const;
     
     // DEBUG MESSENGER CREATION FUNCTIONS
     VkResult CreateDebugeUtilsMessengerEXT(VkInstance* const instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) const;
@@ -62,8 +64,17 @@ private:
     // LOGICAL DEVICE CREATION FUNCTIONS
     std::pair<VkDevice*, VkQueue*> createLogicalDevice(VkPhysicalDevice const &device, VkSurfaceKHR* const surface) const;
     
+    // MEMORY ALLOCATOR CREATION FUNCTIONS
+    void createMemoryAllocator(VkPhysicalDevice const &physicalDevice, VkDevice* const device);
+    
+    void destroyMemoryAllocator();
+    
+    // OFFSCREEN TARGET CREATION FUNCTIONS
+    std::pair<std::vector<VkImage>, std::vector<MemoryAllocation>> createOffscreenImages(VkDevice* const device, VkFormat const format, VkExtent2D const extent, uint32_t const imageCount);
+    
     // SWAPCHAIN CREATION FUNCTIONS
-    std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> createSwapChain(VkPhysicalDevice const &physicalDevice, VkDevice* const device, VkSurfaceKHR* const surface) const;
+    // oldSwapChain is retired by the new swapchain but still has to be destroyed by the caller
+    std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> createSwapChain(VkPhysicalDevice const &physicalDevice, VkDevice* const device, VkSurfaceKHR* const surface, GLFWwindow* const window, VkSwapchainKHR const oldSwapChain) const;
     
     std::vector<VkImage> getSwapChainImages(VkDevice* const device, VkSwapchainKHR const swapChain) const;
     
@@ -0,0 +1,219 @@
+//
+//  computePipeline.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "computePipeline.hpp"
+
+#include <stdexcept>
+
+void ComputePipeline::destroy(VkDevice device)
+{
+    vkDestroyPipeline(device, pipeline, nullptr);
+    vkDestroyPipelineLayout(device, layout, nullptr);
+    
+    pipeline = VK_NULL_HANDLE;
+    layout = VK_NULL_HANDLE;
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::setShader(VkShaderModule module, const char* entryPoint)
+{
+    shaderModule = module;
+    this->entryPoint = entryPoint;
+    
+    return *this;
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::addDescriptorSetLayout(VkDescriptorSetLayout setLayout)
+{
+    setLayouts.push_back(setLayout);
+    
+    return *this;
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::setPushConstantSize(uint32_t size)
+{
+    pushConstantSize = size;
+    
+    return *this;
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::setSpecializationConstants(const std::vector<uint32_t> &constants)
+{
+    specializationConstants = constants;
+    
+    return *this;
+}
+
+ComputePipelineBuilder &ComputePipelineBuilder::setPipelineCache(VkPipelineCache cache)
+{
+    pipelineCache = cache;
+    
+    return *this;
+}
+
+ComputePipeline ComputePipelineBuilder::build(VkDevice device) const
+{
+    if (shaderModule == VK_NULL_HANDLE)
+        throw std::runtime_error("Compute pipeline has no shader!");
+    
+    ComputePipeline computePipeline;
+    computePipeline.pushConstantSize = pushConstantSize;
+    
+    VkPushConstantRange pushConstantRange {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = pushConstantSize;
+    
+    VkPipelineLayoutCreateInfo layoutInfo {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    layoutInfo.pSetLayouts = setLayouts.data();
+    layoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+    layoutInfo.pPushConstantRanges = &pushConstantRange;
+    
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &computePipeline.layout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create compute pipeline layout!");
+    
+    std::vector<VkSpecializationMapEntry> specializationEntries;
+    
+    for (uint32_t i = 0; i < specializationConstants.size(); i++)
+        specializationEntries.push_back({i, static_cast<uint32_t>(i * sizeof(uint32_t)), sizeof(uint32_t)});
+    
+    VkSpecializationInfo specializationInfo {};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+    specializationInfo.pMapEntries = specializationEntries.data();
+    specializationInfo.dataSize = specializationConstants.size() * sizeof(uint32_t);
+    specializationInfo.pData = specializationConstants.data();
+    
+    VkComputePipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = entryPoint;
+    pipelineInfo.stage.pSpecializationInfo = specializationEntries.empty() ? nullptr : &specializationInfo;
+    pipelineInfo.layout = computePipeline.layout;
+    
+    if (vkCreateComputePipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &computePipeline.pipeline) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create compute pipeline!");
+    
+    return computePipeline;
+}
+
+void recordDispatch(VkCommandBuffer commandBuffer, const ComputePipeline &pipeline, const std::vector<VkDescriptorSet> &descriptorSets, const void* pushConstants, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+    
+    if (!descriptorSets.empty())
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+    
+    if (pipeline.pushConstantSize > 0)
+        vkCmdPushConstants(commandBuffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pipeline.pushConstantSize, pushConstants);
+    
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void ComputeQueue::create(VkDevice device, uint32_t queueFamily, VkQueue queue, uint32_t slotCount)
+{
+    this->device = device;
+    this->queueFamily = queueFamily;
+    this->queue = queue;
+    
+    slots.resize(slotCount);
+    
+    for (auto &slot : slots)
+    {
+        VkCommandPoolCreateInfo poolInfo {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = queueFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &slot.commandPool) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create compute command pool!");
+        
+        VkCommandBufferAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = slot.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        
+        if (vkAllocateCommandBuffers(device, &allocInfo, &slot.commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create compute command buffer!");
+        
+        VkFenceCreateInfo fenceInfo {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        
+        VkSemaphoreCreateInfo semaphoreInfo {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        
+        if (vkCreateFence(device, &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS || vkCreateSemaphore(device, &semaphoreInfo, nullptr, &slot.semaphore) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create compute sync objects!");
+    }
+}
+
+void ComputeQueue::destroy()
+{
+    waitIdle();
+    
+    for (const auto &slot : slots)
+    {
+        vkDestroySemaphore(device, slot.semaphore, nullptr);
+        vkDestroyFence(device, slot.fence, nullptr);
+        vkDestroyCommandPool(device, slot.commandPool, nullptr);
+    }
+    
+    slots.clear();
+}
+
+VkCommandBuffer ComputeQueue::begin(uint32_t slot)
+{
+    ComputeSlot &computeSlot = slots[slot];
+    
+    vkWaitForFences(device, 1, &computeSlot.fence, VK_TRUE, UINT64_MAX);
+    vkResetCommandPool(device, computeSlot.commandPool, 0);
+    
+    VkCommandBufferBeginInfo beginInfo {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    
+    if (vkBeginCommandBuffer(computeSlot.commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("Failed to begin recording compute command buffer!");
+    
+    return computeSlot.commandBuffer;
+}
+
+VkSemaphore ComputeQueue::submit(uint32_t slot, VkSemaphore waitSemaphore, VkPipelineStageFlags waitStage, bool signal)
+{
+    ComputeSlot &computeSlot = slots[slot];
+    
+    if (vkEndCommandBuffer(computeSlot.commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to record compute command buffer!");
+    
+    VkSubmitInfo submitInfo {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pWaitSemaphores = &waitSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &computeSlot.commandBuffer;
+    submitInfo.signalSemaphoreCount = signal ? 1 : 0;
+    submitInfo.pSignalSemaphores = &computeSlot.semaphore;
+    
+    vkResetFences(device, 1, &computeSlot.fence);
+    
+    if (vkQueueSubmit(queue, 1, &submitInfo, computeSlot.fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to submit compute command buffer!");
+    
+    return signal ? computeSlot.semaphore : VK_NULL_HANDLE;
+}
+
+void ComputeQueue::waitIdle() const
+{
+    for (const auto &slot : slots)
+        vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+}
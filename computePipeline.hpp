@@ -0,0 +1,93 @@
+//
+//  computePipeline.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef computePipeline_hpp
+#define computePipeline_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <vector>
+
+struct ComputePipeline
+{
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    
+    uint32_t pushConstantSize = 0;
+    
+    void destroy(VkDevice device);
+};
+
+class ComputePipelineBuilder
+{
+public:
+    // The module stays owned by the caller, usually the ShaderLibrary
+    ComputePipelineBuilder &setShader(VkShaderModule module, const char* entryPoint = "main");
+    ComputePipelineBuilder &addDescriptorSetLayout(VkDescriptorSetLayout setLayout);
+    ComputePipelineBuilder &setPushConstantSize(uint32_t size);
+    
+    // Element i is the value of constant_id i
+    ComputePipelineBuilder &setSpecializationConstants(const std::vector<uint32_t> &constants);
+    ComputePipelineBuilder &setPipelineCache(VkPipelineCache cache);
+    
+    ComputePipeline build(VkDevice device) const;
+
+private:
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    const char* entryPoint = "main";
+    
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    uint32_t pushConstantSize = 0;
+    
+    std::vector<uint32_t> specializationConstants;
+    
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+};
+
+// Binds the pipeline and its sets, pushes the constants (pushConstantSize bytes, may be null when that is 0) and dispatches
+void recordDispatch(VkCommandBuffer commandBuffer, const ComputePipeline &pipeline, const std::vector<VkDescriptorSet> &descriptorSets, const void* pushConstants, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+// Per-slot command buffers on the compute queue, with a semaphore per slot for handing results to another queue
+class ComputeQueue
+{
+public:
+    void create(VkDevice device, uint32_t queueFamily, VkQueue queue, uint32_t slotCount);
+    void destroy();
+    
+    // Waits for the previous submission from the slot, then returns its command buffer ready for recording
+    VkCommandBuffer begin(uint32_t slot);
+    
+    // Ends and submits the slot. With signal set it returns a semaphore that exactly one later submit,
+    // usually on the graphics queue, must wait on before this slot is submitted again
+    VkSemaphore submit(uint32_t slot, VkSemaphore waitSemaphore = VK_NULL_HANDLE, VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, bool signal = true);
+    
+    void waitIdle() const;
+    
+    uint32_t getQueueFamily() const { return queueFamily; }
+
+private:
+    struct ComputeSlot
+    {
+        VkCommandPool commandPool;
+        VkCommandBuffer commandBuffer;
+        VkFence fence;
+        VkSemaphore semaphore;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    uint32_t queueFamily = 0;
+    VkQueue queue = VK_NULL_HANDLE;
+    
+    std::vector<ComputeSlot> slots;
+};
+
+#endif /* computePipeline_hpp */
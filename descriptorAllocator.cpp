@@ -0,0 +1,172 @@
+//
+//  descriptorAllocator.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "descriptorAllocator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+void FrameDescriptorAllocator::create(VkDevice device, uint32_t slotCount, uint32_t workerCount, const std::vector<DescriptorPoolRatio> &ratios, uint32_t setsPerPool)
+{
+    this->device = device;
+    this->ratios = ratios;
+    
+    workers.resize(std::max(workerCount, 1u));
+    
+    for (auto &worker : workers)
+    {
+        worker.slotPools.resize(slotCount);
+        worker.nextPoolSize = setsPerPool;
+    }
+}
+
+void FrameDescriptorAllocator::destroy()
+{
+    for (auto &worker : workers)
+    {
+        for (const auto &pools : worker.slotPools)
+            for (auto pool : pools)
+                vkDestroyDescriptorPool(device, pool, nullptr);
+        
+        for (auto pool : worker.freePools)
+            vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    
+    workers.clear();
+}
+
+void FrameDescriptorAllocator::beginFrame(uint32_t slot)
+{
+    currentSlot = slot;
+    
+    uint32_t framePools = 0;
+    
+    for (const auto &worker : workers)
+        framePools += static_cast<uint32_t>(worker.slotPools[slot].size());
+    
+    peakFramePools = std::max(peakFramePools, framePools);
+    
+    // One reset returns every set of the pool, no vkFreeDescriptorSets and no fragmentation
+    for (auto &worker : workers)
+    {
+        for (auto pool : worker.slotPools[slot])
+        {
+            vkResetDescriptorPool(device, pool, 0);
+            worker.freePools.push_back(pool);
+            worker.poolResets++;
+        }
+        
+        worker.slotPools[slot].clear();
+    }
+}
+
+VkDescriptorSet FrameDescriptorAllocator::allocate(VkDescriptorSetLayout layout, uint32_t worker)
+{
+    WorkerPools &pools = workers[worker];
+    std::vector<VkDescriptorPool> &slotPools = pools.slotPools[currentSlot];
+    
+    bool freshPool = false;
+    
+    if (slotPools.empty())
+    {
+        slotPools.push_back(acquirePool(pools));
+        freshPool = true;
+    }
+    
+    VkDescriptorSetAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = slotPools.back();
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+    
+    VkDescriptorSet descriptorSet;
+    
+    // 1.0 drivers do not all report VK_ERROR_OUT_OF_POOL_MEMORY, so any failure is taken to mean the pool is full
+    while (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+    {
+        if (freshPool)
+            throw std::runtime_error("Failed to allocate descriptor set!");
+        
+        slotPools.push_back(acquirePool(pools));
+        allocInfo.descriptorPool = slotPools.back();
+        freshPool = true;
+    }
+    
+    pools.setsAllocated++;
+    
+    return descriptorSet;
+}
+
+DescriptorAllocatorStats FrameDescriptorAllocator::getStats() const
+{
+    DescriptorAllocatorStats stats;
+    
+    for (const auto &worker : workers)
+    {
+        stats.setsAllocated += worker.setsAllocated;
+        stats.poolsCreated += worker.poolsCreated;
+        stats.poolResets += worker.poolResets;
+    }
+    
+    stats.peakFramePools = peakFramePools;
+    
+    return stats;
+}
+
+void FrameDescriptorAllocator::resetStats()
+{
+    for (auto &worker : workers)
+    {
+        worker.setsAllocated = 0;
+        worker.poolsCreated = 0;
+        worker.poolResets = 0;
+    }
+    
+    peakFramePools = 0;
+}
+
+VkDescriptorPool FrameDescriptorAllocator::acquirePool(WorkerPools &worker)
+{
+    if (!worker.freePools.empty())
+    {
+        VkDescriptorPool pool = worker.freePools.back();
+        worker.freePools.pop_back();
+        
+        return pool;
+    }
+    
+    // Every new pool is twice the size of the last, so a frame that needs many sets settles on a few large pools
+    VkDescriptorPool pool = createPool(worker.nextPoolSize);
+    
+    worker.nextPoolSize = std::min(worker.nextPoolSize * 2, MAX_SETS_PER_POOL);
+    worker.poolsCreated++;
+    
+    return pool;
+}
+
+VkDescriptorPool FrameDescriptorAllocator::createPool(uint32_t maxSets) const
+{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    
+    for (const auto &ratio : ratios)
+        poolSizes.push_back({ratio.type, std::max(1u, static_cast<uint32_t>(std::ceil(ratio.descriptorsPerSet * maxSets)))});
+    
+    VkDescriptorPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = maxSets;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    
+    VkDescriptorPool pool;
+    
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor pool!");
+    
+    return pool;
+}
@@ -0,0 +1,88 @@
+//
+//  descriptorAllocator.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef descriptorAllocator_hpp
+#define descriptorAllocator_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <cstdint>
+#include <vector>
+
+const uint32_t DEFAULT_SETS_PER_POOL = 256;
+const uint32_t MAX_SETS_PER_POOL = 4096;
+
+// Descriptors of one type a pool holds per set it can allocate
+struct DescriptorPoolRatio
+{
+    VkDescriptorType type;
+    float descriptorsPerSet;
+};
+
+struct DescriptorAllocatorStats
+{
+    uint64_t setsAllocated = 0;
+    uint32_t poolsCreated = 0;
+    uint32_t poolResets = 0;
+    
+    // Most pools a single frame needed, updated when the slot comes around again
+    uint32_t peakFramePools = 0;
+};
+
+// Descriptor sets that live for one frame. Every frame slot owns a growable list of pools per worker, sets are never
+// freed one by one and beginFrame() resets every pool the slot used once its fence has signaled
+class FrameDescriptorAllocator
+{
+public:
+    // Worker 0 is the recording thread itself, like the worker ranges of ParallelCommandRecorder
+    void create(VkDevice device, uint32_t slotCount, uint32_t workerCount, const std::vector<DescriptorPoolRatio> &ratios, uint32_t setsPerPool = DEFAULT_SETS_PER_POOL);
+    void destroy();
+    
+    // Call after the slot's fence has been waited on
+    void beginFrame(uint32_t slot);
+    
+    // Safe to call from several threads as long as each one passes its own worker index
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout, uint32_t worker = 0);
+    
+    // Only meaningful between frames, the counters are kept per worker
+    DescriptorAllocatorStats getStats() const;
+    void resetStats();
+
+private:
+    struct WorkerPools
+    {
+        // Pools handed out in each slot, the last one is allocated from
+        std::vector<std::vector<VkDescriptorPool>> slotPools;
+        
+        // Reset pools ready for any slot of this worker
+        std::vector<VkDescriptorPool> freePools;
+        
+        uint32_t nextPoolSize = DEFAULT_SETS_PER_POOL;
+        
+        uint64_t setsAllocated = 0;
+        uint32_t poolsCreated = 0;
+        uint32_t poolResets = 0;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    std::vector<DescriptorPoolRatio> ratios;
+    
+    std::vector<WorkerPools> workers;
+    uint32_t currentSlot = 0;
+    
+    uint32_t peakFramePools = 0;
+    
+    VkDescriptorPool acquirePool(WorkerPools &worker);
+    VkDescriptorPool createPool(uint32_t maxSets) const;
+};
+
+#endif /* descriptorAllocator_hpp */
@@ -0,0 +1,247 @@
+//
+//  deviceSelector.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "deviceSelector.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+static const char* deviceTypeName(VkPhysicalDeviceType type)
+{
+    switch (type)
+    {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            return "discrete";
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            return "integrated";
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            return "virtual";
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            return "cpu";
+        default:
+            return "other";
+    }
+}
+
+static std::string toLower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    
+    return text;
+}
+
+static std::string formatUUID(const uint8_t* uuid)
+{
+    static const char digits[] = "0123456789abcdef";
+    
+    std::string text;
+    
+    for (uint32_t i = 0; i < VK_UUID_SIZE; i++)
+    {
+        if (i == 4 || i == 6 || i == 8 || i == 10)
+            text += '-';
+        
+        text += digits[uuid[i] >> 4];
+        text += digits[uuid[i] & 0xF];
+    }
+    
+    return text;
+}
+
+static VkDeviceSize largestLocalHeap(const PhysicalDeviceDescription &description)
+{
+    VkDeviceSize largest = 0;
+    
+    for (uint32_t i = 0; i < description.memoryProperties.memoryHeapCount; i++)
+        if (description.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            largest = std::max(largest, description.memoryProperties.memoryHeaps[i].size);
+    
+    return largest;
+}
+
+static bool hasQueueFamily(const PhysicalDeviceDescription &description, VkQueueFlags required, VkQueueFlags excluded)
+{
+    for (const auto &queueFamily : description.queueFamilies)
+        if ((queueFamily.queueFlags & required) == required && !(queueFamily.queueFlags & excluded))
+            return true;
+    
+    return false;
+}
+
+bool isDeviceUUIDQuerySupported()
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+    
+    auto hasExtension = [&extensions](const char* name)
+    {
+        return std::any_of(extensions.begin(), extensions.end(), [name](const VkExtensionProperties &extension) { return strcmp(extension.extensionName, name) == 0; });
+    };
+    
+    return hasExtension(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) && hasExtension(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
+}
+
+PhysicalDeviceDescription describePhysicalDevice(VkInstance instance, VkPhysicalDevice device, bool suitable, bool queryDeviceUUID)
+{
+    PhysicalDeviceDescription description;
+    description.suitable = suitable;
+    
+    vkGetPhysicalDeviceProperties(device, &description.properties);
+    vkGetPhysicalDeviceMemoryProperties(device, &description.memoryProperties);
+    vkGetPhysicalDeviceFeatures(device, &description.features);
+    
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+    
+    description.queueFamilies.resize(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, description.queueFamilies.data());
+    
+    auto getProperties2 = queryDeviceUUID ? (PFN_vkGetPhysicalDeviceProperties2KHR) vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR") : nullptr;
+    
+    if (getProperties2 != nullptr)
+    {
+        VkPhysicalDeviceIDPropertiesKHR idProperties {};
+        idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES_KHR;
+        
+        VkPhysicalDeviceProperties2 properties {};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+        properties.pNext = &idProperties;
+        
+        getProperties2(device, &properties);
+        
+        memcpy(description.deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+        description.hasDeviceUUID = true;
+    }
+    
+    return description;
+}
+
+uint64_t scorePhysicalDevice(const PhysicalDeviceDescription &description)
+{
+    uint64_t score = 0;
+    
+    // Type alone has to outweigh everything else, integrated GPUs report shared system memory as device local
+    switch (description.properties.deviceType)
+    {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            score += 10000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            score += 5000;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            score += 2500;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:
+            score += 100;
+            break;
+        default:
+            break;
+    }
+    
+    // One point per 16 MB, capped at 64 GB so a huge shared heap cannot outrank a device type
+    score += std::min<uint64_t>(largestLocalHeap(description) / (16 * 1024 * 1024), 4096);
+    
+    if (hasQueueFamily(description, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+        score += 300;
+    
+    if (hasQueueFamily(description, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT))
+        score += 300;
+    
+    const VkBool32 wantedFeatures[] = {
+        description.features.samplerAnisotropy,
+        description.features.multiDrawIndirect,
+        description.features.drawIndirectFirstInstance,
+        description.features.textureCompressionBC,
+        description.features.textureCompressionASTC_LDR,
+        description.features.fillModeNonSolid
+    };
+    
+    for (VkBool32 feature : wantedFeatures)
+        if (feature)
+            score += 50;
+    
+    return score;
+}
+
+bool matchesDeviceOverride(const PhysicalDeviceDescription &description, const std::string &deviceOverride)
+{
+    std::string wanted = toLower(deviceOverride);
+    
+    if (description.hasDeviceUUID)
+    {
+        std::string uuid = formatUUID(description.deviceUUID);
+        std::string compactUUID = uuid;
+        compactUUID.erase(std::remove(compactUUID.begin(), compactUUID.end(), '-'), compactUUID.end());
+        
+        if (wanted == uuid || wanted == compactUUID)
+            return true;
+    }
+    
+    return toLower(description.properties.deviceName).find(wanted) != std::string::npos;
+}
+
+std::string getDeviceOverride(const std::string &configured)
+{
+    if (!configured.empty())
+        return configured;
+    
+    const char* environment = std::getenv(DEVICE_OVERRIDE_VARIABLE);
+    
+    return environment != nullptr ? environment : "";
+}
+
+size_t selectPhysicalDevice(const std::vector<PhysicalDeviceDescription> &descriptions, const std::string &deviceOverride)
+{
+    size_t selected = descriptions.size();
+    size_t overridden = descriptions.size();
+    uint64_t bestScore = 0;
+    
+    for (size_t i = 0; i < descriptions.size(); i++)
+    {
+        const PhysicalDeviceDescription &description = descriptions[i];
+        uint64_t score = scorePhysicalDevice(description);
+        
+        printf("GPU %zu: %s (%s, %llu MB local, %s transfer, %s compute) uuid %s score %llu%s\n", i, description.properties.deviceName, deviceTypeName(description.properties.deviceType), static_cast<unsigned long long>(largestLocalHeap(description) / (1024 * 1024)), hasQueueFamily(description, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT) ? "dedicated" : "shared", hasQueueFamily(description, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT) ? "async" : "shared", description.hasDeviceUUID ? formatUUID(description.deviceUUID).c_str() : "unknown", static_cast<unsigned long long>(score), description.suitable ? "" : " (unsuitable)");
+        
+        if (!description.suitable)
+            continue;
+        
+        // Ties keep the lower index, so the same machine always makes the same choice
+        if (selected == descriptions.size() || score > bestScore)
+        {
+            selected = i;
+            bestScore = score;
+        }
+        
+        if (!deviceOverride.empty() && overridden == descriptions.size() && matchesDeviceOverride(description, deviceOverride))
+            overridden = i;
+    }
+    
+    if (selected == descriptions.size())
+        throw std::runtime_error("Failed to find a suitable GPU!");
+    
+    if (overridden != descriptions.size())
+    {
+        printf("Selected GPU %zu: %s (override \"%s\")\n", overridden, descriptions[overridden].properties.deviceName, deviceOverride.c_str());
+        return overridden;
+    }
+    
+    if (!deviceOverride.empty())
+        printf("No suitable GPU matches \"%s\", falling back to the highest score\n", deviceOverride.c_str());
+    
+    printf("Selected GPU %zu: %s (highest score)\n", selected, descriptions[selected].properties.deviceName);
+    
+    return selected;
+}
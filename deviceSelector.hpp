@@ -0,0 +1,59 @@
+//
+//  deviceSelector.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef deviceSelector_hpp
+#define deviceSelector_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Environment variable checked for a GPU override when none is given on the command line
+const char* const DEVICE_OVERRIDE_VARIABLE = "VULKAN_PROJECT_DEVICE";
+
+// Everything a score depends on, gathered up front so made-up devices can be scored without a driver
+struct PhysicalDeviceDescription
+{
+    VkPhysicalDeviceProperties properties {};
+    VkPhysicalDeviceMemoryProperties memoryProperties {};
+    VkPhysicalDeviceFeatures features {};
+    
+    std::vector<VkQueueFamilyProperties> queueFamilies;
+    
+    // Identifies the device across driver updates, unlike the pipeline cache UUID. Zero when it could not be queried
+    uint8_t deviceUUID[VK_UUID_SIZE] {};
+    bool hasDeviceUUID = false;
+    
+    // Whether the device passed isDeviceSuitable, unsuitable devices are listed but never picked
+    bool suitable = false;
+};
+
+// Whether the instance can enable the extensions the device UUID is read through on a 1.0 instance
+bool isDeviceUUIDQuerySupported();
+
+// queryDeviceUUID only when the instance was created with the extensions above
+PhysicalDeviceDescription describePhysicalDevice(VkInstance instance, VkPhysicalDevice device, bool suitable, bool queryDeviceUUID);
+
+// Higher is better. Device type dominates, then local memory, queue layout and optional features
+uint64_t scorePhysicalDevice(const PhysicalDeviceDescription &description);
+
+// Case-insensitive substring of the device name, or the device UUID as 32 hex digits with or without dashes
+bool matchesDeviceOverride(const PhysicalDeviceDescription &description, const std::string &deviceOverride);
+
+// The configured override if there is one, otherwise the environment variable, otherwise empty
+std::string getDeviceOverride(const std::string &configured);
+
+// Logs every device with its score and returns the index of the one to use
+size_t selectPhysicalDevice(const std::vector<PhysicalDeviceDescription> &descriptions, const std::string &deviceOverride);
+
+#endif /* deviceSelector_hpp */
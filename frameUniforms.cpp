@@ -0,0 +1,126 @@
+//
+//  frameUniforms.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "frameUniforms.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+void FrameUniformBuffer::create(VkPhysicalDevice physicalDevice, VkDevice device, DeviceMemoryAllocator* memoryAllocator, uint32_t slotCount, VkDeviceSize elementSize, uint32_t elementsPerSlot)
+{
+    this->device = device;
+    this->memoryAllocator = memoryAllocator;
+    this->elementsPerSlot = std::max(elementsPerSlot, 1u);
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    
+    if (elementSize > properties.limits.maxUniformBufferRange)
+        throw std::runtime_error("Frame uniform element is larger than maxUniformBufferRange!");
+    
+    VkDeviceSize alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+    
+    stride = (elementSize + alignment - 1) / alignment * alignment;
+    slotSize = stride * this->elementsPerSlot;
+    
+    // Dynamic offsets are 32 bits wide
+    if (slotSize * slotCount > UINT32_MAX)
+        throw std::runtime_error("Frame uniform buffer does not fit in 32-bit dynamic offsets!");
+    
+    VkBufferCreateInfo bufferInfo {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = slotSize * slotCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create frame uniform buffer!");
+    
+    // Coherent, so writes need no flush before the submit
+    allocation = memoryAllocator->allocateForBuffer(buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    mappedData = static_cast<char*>(allocation.mapped);
+    
+    VkDescriptorSetLayoutBinding uniformBinding {};
+    uniformBinding.binding = 0;
+    uniformBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    uniformBinding.descriptorCount = 1;
+    uniformBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &uniformBinding;
+    
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create frame uniform descriptor set layout!");
+    
+    VkDescriptorPoolSize poolSize {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1};
+    
+    VkDescriptorPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create frame uniform descriptor pool!");
+    
+    VkDescriptorSetAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+    
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate frame uniform descriptor set!");
+    
+    // The only write the set ever gets, every slot and element is reached through the dynamic offset
+    VkDescriptorBufferInfo descriptorBufferInfo {buffer, 0, elementSize};
+    
+    VkWriteDescriptorSet descriptorWrite {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &descriptorBufferInfo;
+    
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
+
+void FrameUniformBuffer::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+    
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+    
+    vkDestroyBuffer(device, buffer, nullptr);
+    memoryAllocator->free(allocation);
+    
+    mappedData = nullptr;
+    device = VK_NULL_HANDLE;
+}
+
+void FrameUniformBuffer::beginFrame(uint32_t slot)
+{
+    currentSlot = slot;
+    head.store(0, std::memory_order_relaxed);
+}
+
+uint32_t FrameUniformBuffer::allocate(uint32_t count)
+{
+    uint32_t first = head.fetch_add(count, std::memory_order_relaxed);
+    
+    if (static_cast<uint64_t>(first) + count > elementsPerSlot)
+        throw std::runtime_error("Frame uniform buffer is full!");
+    
+    return first;
+}
@@ -0,0 +1,76 @@
+//
+//  frameUniforms.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef frameUniforms_hpp
+#define frameUniforms_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <atomic>
+#include <cstdint>
+
+#include "memoryAllocator.hpp"
+
+// Per-draw uniforms written straight into persistently mapped memory, one region per frame slot. Shaders see a single
+// dynamic uniform buffer descriptor that is written once at creation, each draw only binds it with another offset
+class FrameUniformBuffer
+{
+public:
+    // elementSize is the structure the shader sees at every offset, elements are spaced minUniformBufferOffsetAlignment apart
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, DeviceMemoryAllocator* memoryAllocator, uint32_t slotCount, VkDeviceSize elementSize, uint32_t elementsPerSlot);
+    void destroy();
+    
+    // Rewinds the slot's region, the slot's fence must already have been waited on
+    void beginFrame(uint32_t slot);
+    
+    // Reserves count consecutive elements and returns the first one. Safe to call from several threads at once
+    uint32_t allocate(uint32_t count);
+    
+    template <typename T>
+    T* getElement(uint32_t element) const
+    {
+        return reinterpret_cast<T*>(mappedData + getDynamicOffset(element));
+    }
+    
+    // Offset to pass to vkCmdBindDescriptorSets for an element of the current slot
+    uint32_t getDynamicOffset(uint32_t element) const
+    {
+        return static_cast<uint32_t>(currentSlot * slotSize + element * stride);
+    }
+    
+    VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+    VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+    
+    VkDeviceSize getStride() const { return stride; }
+    uint32_t getElementsUsed() const { return head.load(std::memory_order_relaxed); }
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    DeviceMemoryAllocator* memoryAllocator = nullptr;
+    
+    VkBuffer buffer = VK_NULL_HANDLE;
+    MemoryAllocation allocation;
+    char* mappedData = nullptr;
+    
+    VkDeviceSize stride = 0;
+    VkDeviceSize slotSize = 0;
+    uint32_t elementsPerSlot = 0;
+    
+    uint32_t currentSlot = 0;
+    std::atomic<uint32_t> head {0};
+    
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+};
+
+#endif /* frameUniforms_hpp */
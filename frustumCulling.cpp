@@ -0,0 +1,364 @@
+//
+//  frustumCulling.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "frustumCulling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CULLING_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define CULLING_X86 0
+#endif
+
+// Lets a single translation unit hold AVX2 code without building everything for AVX2
+#if defined(__GNUC__) || defined(__clang__)
+#define CULLING_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CULLING_TARGET(isa)
+#endif
+
+Frustum extractFrustum(const float* viewProjection)
+{
+    // Row i of the column major matrix
+    auto row = [viewProjection](int i, int column) { return viewProjection[column * 4 + i]; };
+    
+    Frustum frustum;
+    
+    for (int column = 0; column < 4; column++)
+    {
+        frustum.planes[0][column] = row(3, column) + row(0, column);
+        frustum.planes[1][column] = row(3, column) - row(0, column);
+        frustum.planes[2][column] = row(3, column) + row(1, column);
+        frustum.planes[3][column] = row(3, column) - row(1, column);
+        frustum.planes[4][column] = row(2, column);
+        frustum.planes[5][column] = row(3, column) - row(2, column);
+    }
+    
+    // Normalized so the plane distance of a sphere's center can be compared with its radius
+    for (auto &plane : frustum.planes)
+    {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        
+        for (float &value : plane)
+            value /= length;
+    }
+    
+    return frustum;
+}
+
+bool sphereInFrustum(const Frustum &frustum, const float* center, float radius)
+{
+    for (const auto &plane : frustum.planes)
+        if (plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3] < -radius)
+            return false;
+    
+    return true;
+}
+
+// SCENE OBJECT TABLE FUNCTIONS START
+
+uint32_t SceneObjectTable::add(const float* center, float radius, uint32_t flags)
+{
+    centersX.push_back(center[0]);
+    centersY.push_back(center[1]);
+    centersZ.push_back(center[2]);
+    radii.push_back(radius);
+    this->flags.push_back(flags);
+    
+    return size() - 1;
+}
+
+void SceneObjectTable::setSphere(uint32_t object, const float* center, float radius)
+{
+    centersX[object] = center[0];
+    centersY[object] = center[1];
+    centersZ[object] = center[2];
+    radii[object] = radius;
+}
+
+void SceneObjectTable::reserve(uint32_t count)
+{
+    centersX.reserve(count);
+    centersY.reserve(count);
+    centersZ.reserve(count);
+    radii.reserve(count);
+    flags.reserve(count);
+}
+
+void SceneObjectTable::clear()
+{
+    centersX.clear();
+    centersY.clear();
+    centersZ.clear();
+    radii.clear();
+    flags.clear();
+}
+
+// SCENE OBJECT TABLE FUNCTIONS END
+
+// CULLING KERNEL FUNCTIONS START
+
+static uint32_t cullScalar(const Frustum &frustum, const SceneObjectTable &objects, uint32_t first, uint32_t last, uint32_t* visibleIndices)
+{
+    uint32_t count = 0;
+    
+    for (uint32_t object = first; object < last; object++)
+    {
+        uint32_t flags = objects.getFlags()[object];
+        float center[3] = {objects.getCentersX()[object], objects.getCentersY()[object], objects.getCentersZ()[object]};
+        
+        bool visible = (flags & SCENE_OBJECT_ACTIVE) && ((flags & SCENE_OBJECT_ALWAYS_VISIBLE) || sphereInFrustum(frustum, center, objects.getRadii()[object]));
+        
+        // Written either way and only kept when visible, which keeps the loop free of hard to predict branches
+        visibleIndices[count] = object;
+        count += visible ? 1 : 0;
+    }
+    
+    return count;
+}
+
+#if CULLING_X86
+
+CULLING_TARGET("sse2")
+static uint32_t cullSse(const Frustum &frustum, const SceneObjectTable &objects, uint32_t first, uint32_t last, uint32_t* visibleIndices)
+{
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    
+    for (int i = 0; i < 6; i++)
+    {
+        planeX[i] = _mm_set1_ps(frustum.planes[i][0]);
+        planeY[i] = _mm_set1_ps(frustum.planes[i][1]);
+        planeZ[i] = _mm_set1_ps(frustum.planes[i][2]);
+        planeW[i] = _mm_set1_ps(frustum.planes[i][3]);
+    }
+    
+    const __m128i activeBit = _mm_set1_epi32(SCENE_OBJECT_ACTIVE);
+    const __m128i alwaysVisibleBit = _mm_set1_epi32(SCENE_OBJECT_ALWAYS_VISIBLE);
+    
+    uint32_t count = 0;
+    uint32_t object = first;
+    
+    for (; object + 4 <= last; object += 4)
+    {
+        __m128 x = _mm_loadu_ps(objects.getCentersX() + object);
+        __m128 y = _mm_loadu_ps(objects.getCentersY() + object);
+        __m128 z = _mm_loadu_ps(objects.getCentersZ() + object);
+        __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(objects.getRadii() + object));
+        
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        
+        for (int i = 0; i < 6; i++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planeX[i]), _mm_mul_ps(y, planeY[i])), _mm_mul_ps(z, planeZ[i])), planeW[i]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        
+        __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(objects.getFlags() + object));
+        __m128 active = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags, activeBit), activeBit));
+        __m128 alwaysVisible = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags, alwaysVisibleBit), alwaysVisibleBit));
+        
+        int mask = _mm_movemask_ps(_mm_and_ps(active, _mm_or_ps(inside, alwaysVisible)));
+        
+        for (uint32_t lane = 0; lane < 4; lane++)
+        {
+            visibleIndices[count] = object + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+    
+    return count + cullScalar(frustum, objects, object, last, visibleIndices + count);
+}
+
+CULLING_TARGET("avx2")
+static uint32_t cullAvx2(const Frustum &frustum, const SceneObjectTable &objects, uint32_t first, uint32_t last, uint32_t* visibleIndices)
+{
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    
+    for (int i = 0; i < 6; i++)
+    {
+        planeX[i] = _mm256_set1_ps(frustum.planes[i][0]);
+        planeY[i] = _mm256_set1_ps(frustum.planes[i][1]);
+        planeZ[i] = _mm256_set1_ps(frustum.planes[i][2]);
+        planeW[i] = _mm256_set1_ps(frustum.planes[i][3]);
+    }
+    
+    const __m256i activeBit = _mm256_set1_epi32(SCENE_OBJECT_ACTIVE);
+    const __m256i alwaysVisibleBit = _mm256_set1_epi32(SCENE_OBJECT_ALWAYS_VISIBLE);
+    
+    uint32_t count = 0;
+    uint32_t object = first;
+    
+    for (; object + 8 <= last; object += 8)
+    {
+        __m256 x = _mm256_loadu_ps(objects.getCentersX() + object);
+        __m256 y = _mm256_loadu_ps(objects.getCentersY() + object);
+        __m256 z = _mm256_loadu_ps(objects.getCentersZ() + object);
+        __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(objects.getRadii() + object));
+        
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        
+        // Same order of operations as sphereInFrustum() and no FMA, so every kernel rounds alike
+        for (int i = 0; i < 6; i++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, planeX[i]), _mm256_mul_ps(y, planeY[i])), _mm256_mul_ps(z, planeZ[i])), planeW[i]);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+        
+        __m256i flags = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(objects.getFlags() + object));
+        __m256 active = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(flags, activeBit), activeBit));
+        __m256 alwaysVisible = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(flags, alwaysVisibleBit), alwaysVisibleBit));
+        
+        int mask = _mm256_movemask_ps(_mm256_and_ps(active, _mm256_or_ps(inside, alwaysVisible)));
+        
+        for (uint32_t lane = 0; lane < 8; lane++)
+        {
+            visibleIndices[count] = object + lane;
+            count += (mask >> lane) & 1;
+        }
+    }
+    
+    return count + cullScalar(frustum, objects, object, last, visibleIndices + count);
+}
+
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#if defined(_MSC_VER)
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+    
+    for (int i = 0; i < 4; i++)
+        registers[i] = static_cast<uint32_t>(values[i]);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// Which register states the OS saves on a context switch
+static uint64_t readXcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t low, high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    
+    return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+}
+
+#endif
+
+CullingKernel detectCullingKernel()
+{
+#if CULLING_X86
+    uint32_t registers[4];
+    
+    cpuid(0, 0, registers);
+    uint32_t maxLeaf = registers[0];
+    
+    cpuid(1, 0, registers);
+    
+    bool sse2 = registers[3] & (1u << 26);
+    bool osxsave = registers[2] & (1u << 27);
+    bool avx = registers[2] & (1u << 28);
+    
+    // AVX registers are only usable when the OS saves both the XMM and YMM state
+    bool avxEnabled = osxsave && avx && (readXcr0() & 0x6) == 0x6;
+    
+    if (avxEnabled && maxLeaf >= 7)
+    {
+        cpuid(7, 0, registers);
+        
+        if (registers[1] & (1u << 5))
+            return CullingKernel::Avx2;
+    }
+    
+    if (sse2)
+        return CullingKernel::Sse;
+#endif
+    
+    return CullingKernel::Scalar;
+}
+
+const char* getCullingKernelName(CullingKernel kernel)
+{
+    switch (kernel)
+    {
+        case CullingKernel::Avx2:
+            return "AVX2";
+        case CullingKernel::Sse:
+            return "SSE2";
+        default:
+            return "scalar";
+    }
+}
+
+uint32_t cullSpheres(CullingKernel kernel, const Frustum &frustum, const SceneObjectTable &objects, uint32_t first, uint32_t last, uint32_t* visibleIndices)
+{
+#if CULLING_X86
+    if (kernel == CullingKernel::Avx2)
+        return cullAvx2(frustum, objects, first, last, visibleIndices);
+    
+    if (kernel == CullingKernel::Sse)
+        return cullSse(frustum, objects, first, last, visibleIndices);
+#endif
+    
+    return cullScalar(frustum, objects, first, last, visibleIndices);
+}
+
+void cullSpheresParallel(ThreadPool &pool, CullingKernel kernel, const Frustum &frustum, const SceneObjectTable &objects, std::vector<uint32_t> &visibleIndices)
+{
+    uint32_t objectCount = objects.size();
+    visibleIndices.resize(objectCount);
+    
+    // A few chunks per worker evens out the load, multiples of 8 keep every chunk on the vector path
+    uint32_t chunkSize = std::max(MIN_CULLING_CHUNK, (objectCount + pool.getThreadCount() * 4 - 1) / (pool.getThreadCount() * 4));
+    chunkSize = (chunkSize + 7) & ~7u;
+    
+    uint32_t chunkCount = (objectCount + chunkSize - 1) / chunkSize;
+    
+    // Every chunk writes into its own part of the output, so the workers never share a counter
+    std::vector<std::future<uint32_t>> chunkCounts;
+    
+    for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+    {
+        uint32_t first = chunk * chunkSize;
+        uint32_t last = std::min(first + chunkSize, objectCount);
+        
+        chunkCounts.push_back(pool.submit([&, first, last]()
+        {
+            return cullSpheres(kernel, frustum, objects, first, last, visibleIndices.data() + first);
+        }));
+    }
+    
+    // The calling thread takes the first chunk instead of only waiting
+    uint32_t visibleCount = chunkCount > 0 ? cullSpheres(kernel, frustum, objects, 0, std::min(chunkSize, objectCount), visibleIndices.data()) : 0;
+    
+    for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+    {
+        uint32_t count = chunkCounts[chunk - 1].get();
+        
+        memmove(visibleIndices.data() + visibleCount, visibleIndices.data() + chunk * chunkSize, count * sizeof(uint32_t));
+        visibleCount += count;
+    }
+    
+    visibleIndices.resize(visibleCount);
+}
+
+// CULLING KERNEL FUNCTIONS END
@@ -0,0 +1,85 @@
+//
+//  frustumCulling.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef frustumCulling_hpp
+#define frustumCulling_hpp
+
+#include <stdio.h>
+#include <cstdint>
+#include <vector>
+
+#include "threadPool.hpp"
+
+// Bits of the per-object flags, objects without SCENE_OBJECT_ACTIVE are never visible
+const uint32_t SCENE_OBJECT_ACTIVE = 1;
+const uint32_t SCENE_OBJECT_ALWAYS_VISIBLE = 2;
+
+// Smallest piece of the table a worker culls on its own
+const uint32_t MIN_CULLING_CHUNK = 4096;
+
+// Normalized planes pointing inwards, a point p is inside while dot(plane.xyz, p) + plane.w >= 0 for all six
+struct Frustum
+{
+    float planes[6][4];
+};
+
+// Planes of a column major view-projection matrix with Vulkan's 0..1 clip depth
+Frustum extractFrustum(const float* viewProjection);
+
+bool sphereInFrustum(const Frustum &frustum, const float* center, float radius);
+
+// Bounding spheres of the scene as structure of arrays, so the kernels below load several objects with one instruction
+class SceneObjectTable
+{
+public:
+    uint32_t add(const float* center, float radius, uint32_t flags = SCENE_OBJECT_ACTIVE);
+    void setSphere(uint32_t object, const float* center, float radius);
+    void setFlags(uint32_t object, uint32_t flags) { this->flags[object] = flags; }
+    
+    void reserve(uint32_t count);
+    void clear();
+    
+    uint32_t size() const { return static_cast<uint32_t>(radii.size()); }
+    
+    const float* getCentersX() const { return centersX.data(); }
+    const float* getCentersY() const { return centersY.data(); }
+    const float* getCentersZ() const { return centersZ.data(); }
+    const float* getRadii() const { return radii.data(); }
+    const uint32_t* getFlags() const { return flags.data(); }
+
+private:
+    std::vector<float> centersX;
+    std::vector<float> centersY;
+    std::vector<float> centersZ;
+    std::vector<float> radii;
+    std::vector<uint32_t> flags;
+};
+
+// Narrowest first, every kernel writes the same visible indices in the same order
+enum class CullingKernel
+{
+    Scalar,
+    Sse,    // SSE2, 4 objects at a time
+    Avx2    // 8 objects at a time
+};
+
+// The widest kernel this CPU and OS support, checked once with CPUID. Always Scalar on non-x86 builds
+CullingKernel detectCullingKernel();
+
+const char* getCullingKernelName(CullingKernel kernel);
+
+// Tests objects [first, last) and writes the indices of the visible ones to visibleIndices, which needs room for
+// last - first of them. Returns how many were written. The kernel must not be wider than detectCullingKernel()
+uint32_t cullSpheres(CullingKernel kernel, const Frustum &frustum, const SceneObjectTable &objects, uint32_t first, uint32_t last, uint32_t* visibleIndices);
+
+// Culls chunks of the table on the pool and packs the results, visibleIndices ends up with the visible objects in table order
+void cullSpheresParallel(ThreadPool &pool, CullingKernel kernel, const Frustum &frustum, const SceneObjectTable &objects, std::vector<uint32_t> &visibleIndices);
+
+#endif /* frustumCulling_hpp */
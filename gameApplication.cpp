@@ -20,44 +20,78 @@ void GameApplication::run()
 
 void GameApplication::initWindow()
 {
+    if (settings.headless)
+        return;
+    
     glfwInit();
     
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
     
     window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Vulkan Window", nullptr, nullptr);
+    
+    glfwSetWindowUserPointer(window, this);
+    glfwSetFramebufferSizeCallback(window, FramebufferResizeCallback);
 }
 
 void GameApplication::initVulkan()
 {
     glfwSetErrorCallback(ErrorCallback);
     
-    instance = componentConstructor.createInstance();
+    instance = componentConstructor.createInstance(settings.headless);
     debugMessenger = componentConstructor.setupDebugMessenger(instance);
-    surface = componentConstructor.createSurface(instance, window);
-    physicalDevice = std::move(componentConstructor.helper.pickPhysicalDevice(instance, surface));
+    
+    if (!settings.headless)
+        surface = componentConstructor.createSurface(instance, window);
+    
+    physicalDevice = std::move(componentConstructor.helper.pickPhysicalDevice(instance, surface, settings.deviceOverride));
 
     std::pair<VkDevice*, VkQueue*> deviceAndQueue = componentConstructor.createLogicalDevice(physicalDevice, surface);
 
     device = deviceAndQueue.first;
     graphicsQueue = deviceAndQueue.second;
 
-    std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> swapChainAndInfo = componentConstructor.createSwapChain(physicalDevice, device, surface);
+    componentConstructor.createMemoryAllocator(physicalDevice, device);
+    
+    if (settings.headless)
+    {
+        swapChain = VK_NULL_HANDLE;
+        swapChainFormat = componentConstructor.helper.chooseOffscreenFormat(physicalDevice);
+        swapChainExtent = {WINDOW_WIDTH, WINDOW_HEIGHT};
 
-    swapChain = swapChainAndInfo.first;
-    swapChainFormat = std::move(swapChainAndInfo.second.first);
-    swapChainExtent = std::move(swapChainAndInfo.second.second);
+        std::pair<std::vector<VkImage>, std::vector<MemoryAllocation>> imagesAndMemory = componentConstructor.createOffscreenImages(device, swapChainFormat, swapChainExtent, MAX_FRAMES_IN_FLIGHT);
 
-    swapChainImages = componentConstructor.getSwapChainImages(device, swapChain);
+        swapChainImages = imagesAndMemory.first;
+        offscreenImageMemory = imagesAndMemory.second;
+    }
+    else
+    {
+        std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> swapChainAndInfo = componentConstructor.createSwapChain(physicalDevice, device, surface, window, VK_NULL_HANDLE);
+        
+        swapChain = swapChainAndInfo.first;
+        swapChainFormat = std::move(swapChainAndInfo.second.first);
+        swapChainExtent = std::move(swapChainAndInfo.second.second);
+        
+        swapChainImages = componentConstructor.getSwapChainImages(device, swapChain);
+    }
+    
     swapChainImageViews = componentConstructor.createImageViews(device, swapChainImages, swapChainFormat);
 }
 
-void GameApplication::mainLoop() const
+void GameApplication::mainLoop()
 {
-    while (!glfwWindowShouldClose(window))
+    uint32_t frameCount = 0;
+    
+    while ((window == nullptr || !glfwWindowShouldClose(window)) && (settings.frameLimit == 0 || frameCount < settings.frameLimit))
     {
-        glfwPollEvents();
+        if (window != nullptr)
+            glfwPollEvents();
+        
+        if (framebufferResized)
+            recreateSwapChain();
+        
         drawFrame();
+        frameCount++;
     }
 }
 
@@ -66,6 +100,35 @@ void GameApplication::drawFrame() const
     
 }
 
+void GameApplication::recreateSwapChain()
+{
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+    
+    // Nothing to render to while minimized
+    if (width == 0 || height == 0)
+        return;
+    
+    framebufferResized = false;
+    
+    // No frames are submitted yet, so the old image views can go immediately
+    for (auto &imageView : swapChainImageViews)
+        vkDestroyImageView((*device), imageView, nullptr);
+    
+    VkSwapchainKHR oldSwapChain = swapChain;
+    
+    std::pair<VkSwapchainKHR, std::pair<VkFormat, VkExtent2D>> swapChainAndInfo = componentConstructor.createSwapChain(physicalDevice, device, surface, window, oldSwapChain);
+    
+    swapChain = swapChainAndInfo.first;
+    swapChainFormat = std::move(swapChainAndInfo.second.first);
+    swapChainExtent = std::move(swapChainAndInfo.second.second);
+    
+    vkDestroySwapchainKHR((*device), oldSwapChain, nullptr);
+    
+    swapChainImages = componentConstructor.getSwapChainImages(device, swapChain);
+    swapChainImageViews = componentConstructor.createImageViews(device, swapChainImages, swapChainFormat);
+}
+
 void GameApplication::cleanup()
 {
     for (auto &imageView : swapChainImageViews)
@@ -73,7 +136,20 @@ void GameApplication::cleanup()
     
     std::vector<VkImageView>().swap(swapChainImageViews);
     
-    vkDestroySwapchainKHR((*device), swapChain, nullptr);
+    if (settings.headless)
+    {
+        for (size_t i = 0; i < swapChainImages.size(); i++)
+        {
+            vkDestroyImage((*device), swapChainImages[i], nullptr);
+            componentConstructor.memoryAllocator.free(offscreenImageMemory[i]);
+        }
+        
+        std::vector<MemoryAllocation>().swap(offscreenImageMemory);
+    }
+    else
+        vkDestroySwapchainKHR((*device), swapChain, nullptr);
+    
+    componentConstructor.destroyMemoryAllocator();
     
     vkDestroyDevice((*device), nullptr);
     delete device;
@@ -86,14 +162,20 @@ void GameApplication::cleanup()
         debugMessenger = nullptr;
     }
     
-    vkDestroySurfaceKHR((*instance), (*surface), nullptr);
-    delete surface;
-    surface = nullptr;
+    if (surface != nullptr)
+    {
+        vkDestroySurfaceKHR((*instance), (*surface), nullptr);
+        delete surface;
+        surface = nullptr;
+    }
     
     vkDestroyInstance((*instance), nullptr);
     delete instance;
     instance = nullptr;
     
+    if (window == nullptr)
+        return;
+    
     glfwDestroyWindow(window);
     glfwTerminate();
 }
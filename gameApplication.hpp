@@ -19,18 +19,23 @@
 #include <string>
 
 #include "componentConstructor.hpp"
+#include "settings.hpp"
 
 class GameApplication
 {
 public:
+    GameApplication(const ApplicationSettings &settings) : settings(settings) {}
+    
     void run();
     
 private:
+    ApplicationSettings settings;
+    
     // Instance of component constructor for VK object generation
     ApplicationComponentConstructor componentConstructor;
     
-    GLFWwindow* window;
-    VkSurfaceKHR* surface;
+    GLFWwindow* window = nullptr;
+    VkSurfaceKHR* surface = nullptr;
     
     VkInstance* instance;
     VkDebugUtilsMessengerEXT* debugMessenger;
@@ -46,6 +51,11 @@ private:
     std::vector<VkImage> swapChainImages;
     std::vector<VkImageView> swapChainImageViews;
     
+    // Backing memory of the images that stand in for the swapchain in headless mode
+    std::vector<MemoryAllocation> offscreenImageMemory;
+    
+    bool framebufferResized = false;
+    
     // Start of init functions
     void initWindow();
     
@@ -53,10 +63,12 @@ private:
     // End of init functions
     
     // Start of main functions
-    void mainLoop() const;
+    void mainLoop();
     
     void drawFrame() const;
     
+    void recreateSwapChain();
+    
     void cleanup();
     // End of main functions
     
@@ -64,6 +76,11 @@ private:
     {
         std::cout << "GLFW Error: " << err_str << std::endl;
     }
+    
+    static void FramebufferResizeCallback(GLFWwindow* window, int, int)
+    {
+        reinterpret_cast<GameApplication*>(glfwGetWindowUserPointer(window))->framebufferResized = true;
+    }
 };
 
 #endif /* gameApplication_hpp */
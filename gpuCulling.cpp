@@ -0,0 +1,205 @@
+//
+//  gpuCulling.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "gpuCulling.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+void GpuCuller::create(VkDevice device, BufferManager* bufferManager, const IndirectDrawSupport &support, VkShaderModule cullShader, VkPipelineCache pipelineCache, uint32_t slotCount, const std::vector<CullObject> &objects)
+{
+    // The object index reaches the vertex shader as the instance index
+    if (!support.drawIndirectFirstInstance)
+        throw std::runtime_error("GPU culling needs drawIndirectFirstInstance!");
+    
+    this->device = device;
+    this->bufferManager = bufferManager;
+    this->support = support;
+    
+    objectCount = static_cast<uint32_t>(objects.size());
+    compacting = support.drawIndexedIndirectCount != nullptr && objectCount <= support.maxDrawIndirectCount;
+    
+    VkDeviceSize objectSize = std::max<VkDeviceSize>(sizeof(CullObject) * objects.size(), sizeof(CullObject));
+    VkDeviceSize commandSize = std::max<VkDeviceSize>(sizeof(VkDrawIndexedIndirectCommand) * objects.size(), sizeof(VkDrawIndexedIndirectCommand));
+    
+    objectBuffer = bufferManager->createDeviceBuffer(objectSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    
+    for (uint32_t slot = 0; slot < slotCount; slot++)
+    {
+        commandBuffers.push_back(bufferManager->createDeviceBuffer(commandSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT));
+        countBuffers.push_back(bufferManager->createDeviceBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT));
+    }
+    
+    if (!objects.empty())
+        bufferManager->upload(objectBuffer, 0, objects.data(), sizeof(CullObject) * objects.size());
+    
+    bufferManager->flush();
+    bufferManager->waitIdle();
+    
+    createDescriptorSets(slotCount);
+    
+    cullPipeline = ComputePipelineBuilder()
+        .setShader(cullShader)
+        .addDescriptorSetLayout(cullSetLayout)
+        .setPushConstantSize(sizeof(CullParameters))
+        .setSpecializationConstants({compacting ? 1u : 0u})
+        .setPipelineCache(pipelineCache)
+        .build(device);
+}
+
+void GpuCuller::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+    
+    cullPipeline.destroy(device);
+    
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, cullSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, objectSetLayout, nullptr);
+    
+    for (auto &buffer : commandBuffers)
+        bufferManager->destroyBuffer(buffer);
+    
+    for (auto &buffer : countBuffers)
+        bufferManager->destroyBuffer(buffer);
+    
+    bufferManager->destroyBuffer(objectBuffer);
+    
+    commandBuffers.clear();
+    countBuffers.clear();
+    cullSets.clear();
+    
+    device = VK_NULL_HANDLE;
+}
+
+void GpuCuller::recordClear(VkCommandBuffer commandBuffer, uint32_t slot)
+{
+    vkCmdFillBuffer(commandBuffer, countBuffers[slot].buffer, 0, sizeof(uint32_t), 0);
+}
+
+void GpuCuller::recordCull(VkCommandBuffer commandBuffer, uint32_t slot, const Frustum &frustum)
+{
+    CullParameters parameters;
+    memcpy(parameters.planes, frustum.planes, sizeof(parameters.planes));
+    parameters.objectCount = objectCount;
+    
+    recordDispatch(commandBuffer, cullPipeline, {cullSets[slot]}, &parameters, (objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE);
+}
+
+void GpuCuller::recordDraws(VkCommandBuffer commandBuffer, uint32_t slot) const
+{
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    
+    if (compacting)
+    {
+        support.drawIndexedIndirectCount(commandBuffer, commandBuffers[slot].buffer, 0, countBuffers[slot].buffer, 0, objectCount, stride);
+        return;
+    }
+    
+    // Culled objects are draws with no instances. Without multiDrawIndirect every indirect draw holds a single command
+    uint32_t batchSize = support.multiDrawIndirect ? std::max(support.maxDrawIndirectCount, 1u) : 1;
+    
+    for (uint32_t first = 0; first < objectCount; first += batchSize)
+        vkCmdDrawIndexedIndirect(commandBuffer, commandBuffers[slot].buffer, static_cast<VkDeviceSize>(first) * stride, std::min(batchSize, objectCount - first), stride);
+}
+
+void GpuCuller::createDescriptorSets(uint32_t slotCount)
+{
+    VkDescriptorSetLayoutBinding cullBindings[3] {};
+    
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        cullBindings[i].binding = i;
+        cullBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        cullBindings[i].descriptorCount = 1;
+        cullBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 3;
+    layoutInfo.pBindings = cullBindings;
+    
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &cullSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create cull descriptor set layout!");
+    
+    VkDescriptorSetLayoutBinding objectBinding {};
+    objectBinding.binding = 0;
+    objectBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    objectBinding.descriptorCount = 1;
+    objectBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &objectBinding;
+    
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &objectSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create object descriptor set layout!");
+    
+    VkDescriptorPoolSize poolSize {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * slotCount + 1};
+    
+    VkDescriptorPoolCreateInfo poolInfo {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = slotCount + 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create cull descriptor pool!");
+    
+    std::vector<VkDescriptorSetLayout> setLayouts(slotCount, cullSetLayout);
+    setLayouts.push_back(objectSetLayout);
+    
+    std::vector<VkDescriptorSet> descriptorSets(setLayouts.size());
+    
+    VkDescriptorSetAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+    allocInfo.pSetLayouts = setLayouts.data();
+    
+    if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate cull descriptor sets!");
+    
+    objectSet = descriptorSets.back();
+    descriptorSets.pop_back();
+    cullSets = descriptorSets;
+    
+    // Every set is written once, nothing about the buffers changes after creation
+    std::vector<VkDescriptorBufferInfo> bufferInfos;
+    bufferInfos.reserve(3 * slotCount + 1);
+    
+    std::vector<VkWriteDescriptorSet> descriptorWrites;
+    
+    auto addWrite = [&](VkDescriptorSet set, uint32_t binding, const DeviceBuffer &buffer)
+    {
+        bufferInfos.push_back({buffer.buffer, 0, VK_WHOLE_SIZE});
+        
+        VkWriteDescriptorSet descriptorWrite {};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = set;
+        descriptorWrite.dstBinding = binding;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo = &bufferInfos.back();
+        
+        descriptorWrites.push_back(descriptorWrite);
+    };
+    
+    for (uint32_t slot = 0; slot < slotCount; slot++)
+    {
+        addWrite(cullSets[slot], 0, objectBuffer);
+        addWrite(cullSets[slot], 1, commandBuffers[slot]);
+        addWrite(cullSets[slot], 2, countBuffers[slot]);
+    }
+    
+    addWrite(objectSet, 0, objectBuffer);
+    
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
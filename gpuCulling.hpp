@@ -0,0 +1,115 @@
+//
+//  gpuCulling.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef gpuCulling_hpp
+#define gpuCulling_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <cstdint>
+#include <vector>
+
+#include "bufferManager.hpp"
+#include "computePipeline.hpp"
+#include "frustumCulling.hpp"
+
+const uint32_t CULL_GROUP_SIZE = 64;
+
+// One object of Shaders/cull.comp and Shaders/culled.vert, laid out like the std430 struct
+struct CullObject
+{
+    float center[3];
+    float radius;
+    
+    // The indexed draw that renders the object
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    
+    uint32_t materialIndex;
+};
+
+// What the device offers for indirect draws, filled in once the logical device exists
+struct IndirectDrawSupport
+{
+    bool multiDrawIndirect = false;
+    bool drawIndirectFirstInstance = false;
+    uint32_t maxDrawIndirectCount = 1;
+    
+    // From VK_KHR_draw_indirect_count, null when the extension is not enabled
+    PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+};
+
+// Culls a fixed list of objects on the GPU and draws the survivors with indirect draws. A compute dispatch tests every
+// bounding sphere against the frustum and writes a VkDrawIndexedIndirectCommand per visible object, so the CPU records
+// the same few commands however many objects there are
+class GpuCuller
+{
+public:
+    // Each frame slot gets its own command and count buffers, so a slot can be culled while the previous one still draws
+    void create(VkDevice device, BufferManager* bufferManager, const IndirectDrawSupport &support, VkShaderModule cullShader, VkPipelineCache pipelineCache, uint32_t slotCount, const std::vector<CullObject> &objects);
+    void destroy();
+    
+    // Outside a render pass and before recordCull, compacting only. Zeroes the slot's draw count
+    void recordClear(VkCommandBuffer commandBuffer, uint32_t slot);
+    
+    // Outside a render pass. Culls every object into the slot's buffers, the caller orders the clear before it and the
+    // indirect draws after it
+    void recordCull(VkCommandBuffer commandBuffer, uint32_t slot, const Frustum &frustum);
+    
+    // Inside the render pass, with a pipeline that reads the object set and the vertex and index buffers already bound
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t slot) const;
+    
+    // The objects as a storage buffer for vertex shaders, firstInstance of every draw is the object index
+    VkDescriptorSetLayout getObjectSetLayout() const { return objectSetLayout; }
+    VkDescriptorSet getObjectSet() const { return objectSet; }
+    
+    // Compacting writes only the visible draws behind a count, otherwise culled objects keep a draw with no instances
+    bool isCompacting() const { return compacting; }
+    
+    // Written by the cull and read by the indirect draws of the slot
+    const DeviceBuffer &getCommandBuffer(uint32_t slot) const { return commandBuffers[slot]; }
+    const DeviceBuffer &getCountBuffer(uint32_t slot) const { return countBuffers[slot]; }
+    uint32_t getObjectCount() const { return objectCount; }
+
+private:
+    // Push constants of Shaders/cull.comp
+    struct CullParameters
+    {
+        float planes[6][4];
+        uint32_t objectCount;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    BufferManager* bufferManager = nullptr;
+    IndirectDrawSupport support;
+    
+    uint32_t objectCount = 0;
+    bool compacting = false;
+    
+    DeviceBuffer objectBuffer;
+    std::vector<DeviceBuffer> commandBuffers;
+    std::vector<DeviceBuffer> countBuffers;
+    
+    VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout objectSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    
+    std::vector<VkDescriptorSet> cullSets;
+    VkDescriptorSet objectSet = VK_NULL_HANDLE;
+    
+    ComputePipeline cullPipeline;
+    
+    void createDescriptorSets(uint32_t slotCount);
+};
+
+#endif /* gpuCulling_hpp */
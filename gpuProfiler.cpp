@@ -0,0 +1,294 @@
+//
+//  gpuProfiler.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "gpuProfiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+static const char* timelineName(ProfileTimeline timeline)
+{
+    return timeline == ProfileTimeline::Gpu ? "gpu" : "cpu";
+}
+
+// CSV doubles quotes inside a quoted field
+static std::string escapeCsv(const std::string &name)
+{
+    std::string escaped;
+    
+    for (char character : name)
+        escaped += character == '"' ? std::string("\"\"") : std::string(1, character);
+    
+    return escaped;
+}
+
+static std::string escapeJson(const std::string &name)
+{
+    std::string escaped;
+    
+    for (char character : name)
+    {
+        if (character == '"' || character == '\\')
+            escaped += '\\';
+        
+        escaped += character;
+    }
+    
+    return escaped;
+}
+
+void GpuProfiler::create(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t slotCount)
+{
+    this->device = device;
+    
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    
+    uint32_t validBits = queueFamilies[queueFamily].timestampValidBits;
+    
+    // CPU samples still work without timestamps, GPU scopes just turn into no-ops
+    if (validBits == 0)
+        return;
+    
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    timestampPeriod = properties.limits.timestampPeriod;
+    
+    slots.resize(slotCount);
+    
+    for (auto &slot : slots)
+    {
+        VkQueryPoolCreateInfo queryPoolInfo {};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = MAX_PROFILER_QUERIES;
+        
+        if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &slot.queryPool) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create timestamp query pool!");
+        
+        slot.queryCount = 0;
+        slot.pending = false;
+    }
+}
+
+void GpuProfiler::destroy()
+{
+    for (const auto &slot : slots)
+        vkDestroyQueryPool(device, slot.queryPool, nullptr);
+    
+    slots.clear();
+}
+
+void GpuProfiler::collect(uint32_t slot)
+{
+    if (slot >= slots.size() || !slots[slot].pending)
+        return;
+    
+    ProfilerSlot &profilerSlot = slots[slot];
+    profilerSlot.pending = false;
+    
+    std::vector<uint64_t> timestamps(profilerSlot.queryCount);
+    
+    // The fence has been waited on so every query is available, no WAIT flag needed
+    VkResult result = vkGetQueryPoolResults(device, profilerSlot.queryPool, 0, profilerSlot.queryCount, timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    
+    if (result == VK_SUCCESS)
+    {
+        for (const auto &scope : profilerSlot.scopes)
+        {
+            if (scope.endQuery == UINT32_MAX)
+                continue;
+            
+            uint64_t ticks = (timestamps[scope.endQuery] - timestamps[scope.beginQuery]) & timestampMask;
+            addSample(ProfileTimeline::Gpu, scope.name, static_cast<double>(ticks) * timestampPeriod / 1e6);
+        }
+    }
+    
+    profilerSlot.scopes.clear();
+    profilerSlot.queryCount = 0;
+}
+
+void GpuProfiler::beginCommands(VkCommandBuffer commandBuffer, uint32_t slot)
+{
+    activeSlot = slot;
+    openScopes.clear();
+    
+    if (slot >= slots.size())
+        return;
+    
+    ProfilerSlot &profilerSlot = slots[slot];
+    profilerSlot.scopes.clear();
+    profilerSlot.queryCount = 0;
+    profilerSlot.pending = false;
+    
+    vkCmdResetQueryPool(commandBuffer, profilerSlot.queryPool, 0, MAX_PROFILER_QUERIES);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string &name, VkPipelineStageFlagBits stage)
+{
+    if (activeSlot >= slots.size())
+        return;
+    
+    ProfilerSlot &profilerSlot = slots[activeSlot];
+    
+    // Both ends have to fit, otherwise the scope is dropped but still has to be balanced by endScope
+    if (profilerSlot.queryCount + 2 > MAX_PROFILER_QUERIES)
+    {
+        openScopes.push_back(SIZE_MAX);
+        return;
+    }
+    
+    vkCmdWriteTimestamp(commandBuffer, stage, profilerSlot.queryPool, profilerSlot.queryCount);
+    
+    openScopes.push_back(profilerSlot.scopes.size());
+    profilerSlot.scopes.push_back({name, profilerSlot.queryCount, UINT32_MAX});
+    
+    // The end query is reserved now so nested scopes cannot use it up
+    profilerSlot.queryCount += 2;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits stage)
+{
+    if (activeSlot >= slots.size() || openScopes.empty())
+        return;
+    
+    size_t scopeIndex = openScopes.back();
+    openScopes.pop_back();
+    
+    if (scopeIndex == SIZE_MAX)
+        return;
+    
+    RecordedScope &scope = slots[activeSlot].scopes[scopeIndex];
+    scope.endQuery = scope.beginQuery + 1;
+    
+    vkCmdWriteTimestamp(commandBuffer, stage, slots[activeSlot].queryPool, scope.endQuery);
+}
+
+void GpuProfiler::submitted(uint32_t slot)
+{
+    if (slot < slots.size())
+        slots[slot].pending = !slots[slot].scopes.empty();
+}
+
+void GpuProfiler::addCpuSample(const std::string &name, double milliseconds)
+{
+    addSample(ProfileTimeline::Cpu, name, milliseconds);
+}
+
+void GpuProfiler::addSample(ProfileTimeline timeline, const std::string &name, double milliseconds)
+{
+    ScopeHistory &scope = history[{timeline, name}];
+    
+    scope.min = scope.count == 0 ? milliseconds : std::min(scope.min, milliseconds);
+    scope.max = scope.count == 0 ? milliseconds : std::max(scope.max, milliseconds);
+    scope.total += milliseconds;
+    scope.count++;
+    
+    if (scope.samples.size() < PROFILER_HISTORY_SIZE)
+        scope.samples.push_back(milliseconds);
+    else
+        scope.samples[scope.nextSample] = milliseconds;
+    
+    scope.nextSample = (scope.nextSample + 1) % PROFILER_HISTORY_SIZE;
+}
+
+ProfileScopeStats GpuProfiler::getScopeStats(const std::string &name, ProfileTimeline timeline) const
+{
+    ProfileScopeStats stats;
+    stats.name = name;
+    stats.timeline = timeline;
+    
+    auto found = history.find({timeline, name});
+    
+    if (found == history.end() || found->second.count == 0)
+        return stats;
+    
+    const ScopeHistory &scope = found->second;
+    
+    stats.count = scope.count;
+    stats.min = scope.min;
+    stats.average = scope.total / scope.count;
+    stats.max = scope.max;
+    
+    std::vector<double> samples = scope.samples;
+    size_t rank = static_cast<size_t>(std::ceil(samples.size() * 0.99)) - 1;
+    
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    stats.p99 = samples[rank];
+    
+    return stats;
+}
+
+std::vector<ProfileScopeStats> GpuProfiler::getStats() const
+{
+    std::vector<ProfileScopeStats> stats;
+    
+    for (const auto &scope : history)
+        stats.push_back(getScopeStats(scope.first.second, scope.first.first));
+    
+    return stats;
+}
+
+void GpuProfiler::reset()
+{
+    history.clear();
+}
+
+void GpuProfiler::write(const std::string &path) const
+{
+    const std::string extension = ".json";
+    
+    if (path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0)
+        writeJson(path);
+    else
+        writeCsv(path);
+}
+
+void GpuProfiler::writeCsv(const std::string &path) const
+{
+    std::ofstream file(path);
+    
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open profile output!");
+    
+    file << "timeline,scope,count,min_ms,avg_ms,p99_ms,max_ms\n";
+    
+    for (const auto &scope : getStats())
+        file << timelineName(scope.timeline) << ",\"" << escapeCsv(scope.name) << "\"," << scope.count << "," << scope.min << "," << scope.average << "," << scope.p99 << "," << scope.max << "\n";
+}
+
+void GpuProfiler::writeJson(const std::string &path) const
+{
+    std::ofstream file(path);
+    
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open profile output!");
+    
+    std::vector<ProfileScopeStats> stats = getStats();
+    
+    file << "{\n    \"scopes\": [\n";
+    
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        const ProfileScopeStats &scope = stats[i];
+        
+        file << "        {\"timeline\": \"" << timelineName(scope.timeline) << "\", \"name\": \"" << escapeJson(scope.name) << "\", \"count\": " << scope.count;
+        file << ", \"min_ms\": " << scope.min << ", \"avg_ms\": " << scope.average << ", \"p99_ms\": " << scope.p99 << ", \"max_ms\": " << scope.max << "}";
+        file << (i + 1 < stats.size() ? ",\n" : "\n");
+    }
+    
+    file << "    ]\n}\n";
+}
@@ -0,0 +1,123 @@
+//
+//  gpuProfiler.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef gpuProfiler_hpp
+#define gpuProfiler_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+const uint32_t MAX_PROFILER_QUERIES = 64;
+const uint32_t PROFILER_HISTORY_SIZE = 4096;
+
+enum class ProfileTimeline
+{
+    Cpu,
+    Gpu
+};
+
+// Summary of one named scope, all times in milliseconds
+struct ProfileScopeStats
+{
+    std::string name;
+    ProfileTimeline timeline = ProfileTimeline::Gpu;
+    
+    uint64_t count = 0;
+    double min = 0.0;
+    double average = 0.0;
+    double max = 0.0;
+    
+    // Taken over the last PROFILER_HISTORY_SIZE samples so long runs stay bounded
+    double p99 = 0.0;
+};
+
+// Timestamp queries around named scopes of the recorded command buffers, plus CPU timings in the same report.
+// Every frame slot owns its own query pool and is only read back after its fence, so reading never stalls
+class GpuProfiler
+{
+public:
+    // Leaves GPU scopes disabled when the queue family has no valid timestamp bits
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t slotCount);
+    void destroy();
+    
+    bool hasGpuTimestamps() const { return !slots.empty(); }
+    
+    // Call once the fence of the slot has been waited on, folds its previous results into the stats
+    void collect(uint32_t slot);
+    
+    // Resets the slot's queries from inside the command buffer, must come before any scope of the frame
+    void beginCommands(VkCommandBuffer commandBuffer, uint32_t slot);
+    
+    // Scopes may nest, those past MAX_PROFILER_QUERIES in a frame are dropped
+    void beginScope(VkCommandBuffer commandBuffer, const std::string &name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    void endScope(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    
+    // Marks the slot's scopes as submitted, only those are ever read back
+    void submitted(uint32_t slot);
+    
+    void addCpuSample(const std::string &name, double milliseconds);
+    
+    ProfileScopeStats getScopeStats(const std::string &name, ProfileTimeline timeline) const;
+    std::vector<ProfileScopeStats> getStats() const;
+    
+    void reset();
+    
+    // Picks the format from the extension, .json or anything else for CSV
+    void write(const std::string &path) const;
+    void writeCsv(const std::string &path) const;
+    void writeJson(const std::string &path) const;
+
+private:
+    struct RecordedScope
+    {
+        std::string name;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+    };
+    
+    struct ProfilerSlot
+    {
+        VkQueryPool queryPool;
+        
+        std::vector<RecordedScope> scopes;
+        uint32_t queryCount;
+        bool pending;
+    };
+    
+    struct ScopeHistory
+    {
+        uint64_t count = 0;
+        double min = 0.0;
+        double total = 0.0;
+        double max = 0.0;
+        
+        std::vector<double> samples;
+        size_t nextSample = 0;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    float timestampPeriod = 0.0f;
+    uint64_t timestampMask = ~0ull;
+    
+    std::vector<ProfilerSlot> slots;
+    uint32_t activeSlot = 0;
+    std::vector<size_t> openScopes;
+    
+    std::map<std::pair<ProfileTimeline, std::string>, ScopeHistory> history;
+    
+    void addSample(ProfileTimeline timeline, const std::string &name, double milliseconds);
+};
+
+#endif /* gpuProfiler_hpp */
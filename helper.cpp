@@ -7,12 +7,15 @@
 //
 #include <cstring>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "helper.hpp"
+#include "deviceSelector.hpp"
+#include "renderPassBuilder.hpp"
 
-bool ApplicationHelper::checkDeviceExtensionSupport(const VkPhysicalDevice* device) const
+bool ApplicationHelper::checkDeviceExtensionSupport(const VkPhysicalDevice* device, const bool &headless) const
 {
     uint32_t extensionCount = 0;
     vkEnumerateDeviceExtensionProperties((*device), nullptr, &extensionCount, nullptr);
@@ -20,7 +23,8 @@ bool ApplicationHelper::checkDeviceExtensionSupport(const VkPhysicalDevice* devi
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties((*device), nullptr, &extensionCount, availableExtensions.data());
     
-    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+    std::vector<const char*> extensions = getRequiredDeviceExtensions(headless);
+    std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
     
     for (const auto &extension : availableExtensions)
         requiredExtensions.erase(extension.extensionName);
@@ -58,9 +62,14 @@ bool ApplicationHelper::checkLayerValidationSupport() const
 
 bool ApplicationHelper::isDeviceSuitable(VkPhysicalDevice const device, VkSurfaceKHR* const surface) const
 {
-    QueueFamilyIndices indices = findQueueFamilies((device), (*surface));
+    bool headless = surface == nullptr;
     
-    bool extensionsSupported = checkDeviceExtensionSupport(&device);
+    QueueFamilyIndices indices = findQueueFamilies((device), headless ? VK_NULL_HANDLE : (*surface));
+    
+    bool extensionsSupported = checkDeviceExtensionSupport(&device, headless);
+    
+    if (headless)
+        return indices.graphicsFamily.has_value() && extensionsSupported;
     
     bool swapChainAdequate = false;
     if (extensionsSupported)
@@ -72,19 +81,40 @@ bool ApplicationHelper::isDeviceSuitable(VkPhysicalDevice const device, VkSurfac
     return indices.isComplete() && extensionsSupported && swapChainAdequate;
 }
 
-std::vector<const char*> ApplicationHelper::getRequiredExtensions(const bool &enableValidationLayers) const
+std::vector<const char*> ApplicationHelper::getRequiredExtensions(const bool &enableValidationLayers, const bool &headless) const
 {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char*> extensions;
+    
+    if (!headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
     
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
     if (enableValidationLayers)
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     
+    // Optional, the device UUID a GPU override can match is read through them
+    if (isDeviceUUIDQuerySupported())
+    {
+        extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        extensions.push_back(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
+    }
+    
     return extensions;
 }
 
+std::vector<const char*> ApplicationHelper::getRequiredDeviceExtensions(const bool &headless) const
+{
+    if (headless)
+        return {};
+    
+    return deviceExtensions;
+}
+
 QueueFamilyIndices ApplicationHelper::findQueueFamilies(const VkPhysicalDevice &device, const VkSurfaceKHR &surface) const
 {
     QueueFamilyIndices indices;
@@ -101,18 +131,43 @@ QueueFamilyIndices ApplicationHelper::findQueueFamilies(const VkPhysicalDevice &
         if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
             indices.graphicsFamily = i;
         
-        VkBool32 presentSupport;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        VkBool32 presentSupport = VK_FALSE;
+        
+        if (surface != VK_NULL_HANDLE)
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
         
         if (presentSupport)
             indices.presentFamily = i;
         
-        if (indices.isComplete())
+        if (indices.isComplete() || (surface == VK_NULL_HANDLE && indices.graphicsFamily.has_value()))
             break;
         
         i++;
     }
     
+    // A transfer-only family is usually a dedicated DMA engine, a compute family without graphics is the next best thing
+    for (uint32_t j = 0; j < queueFamilies.size(); j++)
+    {
+        VkQueueFlags flags = queueFamilies[j].queueFlags;
+        
+        if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+            continue;
+        
+        if (!indices.transferFamily.has_value() || !(flags & VK_QUEUE_COMPUTE_BIT))
+            indices.transferFamily = j;
+    }
+    
+    if (!indices.transferFamily.has_value())
+        indices.transferFamily = indices.graphicsFamily;
+    
+    // Async compute needs a family without graphics, otherwise compute goes through the graphics family
+    for (uint32_t j = 0; j < queueFamilies.size() && !indices.computeFamily.has_value(); j++)
+        if ((queueFamilies[j].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamilies[j].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            indices.computeFamily = j;
+    
+    if (!indices.computeFamily.has_value())
+        indices.computeFamily = indices.graphicsFamily;
+    
     return indices;
 }
 
@@ -143,39 +198,36 @@ SwapChainSupportDetails ApplicationHelper::querySwapChainSupport(const VkPhysica
     return details;
 }
 
-VkPhysicalDevice ApplicationHelper::pickPhysicalDevice(VkInstance* const instance, VkSurfaceKHR* const surface) const
+VkPhysicalDevice ApplicationHelper::pickPhysicalDevice(VkInstance* const instance, VkSurfaceKHR* const surface, const std::string &deviceOverride) const
 {
-    VkPhysicalDevice newDevice;
-    newDevice = VK_NULL_HANDLE;
-    
-    uint32_t deviceCount;
+    uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices((*instance), &deviceCount, nullptr);
     
+    if (deviceCount == 0)
+        throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+    
     std::vector<VkPhysicalDevice> devices(deviceCount);
     vkEnumeratePhysicalDevices((*instance), &deviceCount, devices.data());
     
-    for (const auto &device : devices)
-    {
-        if (isDeviceSuitable(device, surface))
-        {
-            newDevice = device;
-            break;
-        }
-    }
+    std::vector<PhysicalDeviceDescription> descriptions;
     
-    if (newDevice == VK_NULL_HANDLE)
-        throw std::runtime_error("Failed to find a suitable GPU!");
+    for (const auto &device : devices)
+        descriptions.push_back(describePhysicalDevice((*instance), device, isDeviceSuitable(device, surface), isDeviceUUIDQuerySupported()));
     
-    return newDevice;
+    return devices[selectPhysicalDevice(descriptions, getDeviceOverride(deviceOverride))];
 }
 
-VkExtent2D ApplicationHelper::chooseSwapSurfaceExtent(const VkSurfaceCapabilitiesKHR &capabilities) const
+VkExtent2D ApplicationHelper::chooseSwapSurfaceExtent(const VkSurfaceCapabilitiesKHR &capabilities, GLFWwindow* const window) const
 {
     if (capabilities.currentExtent.width != UINT32_MAX)
         return capabilities.currentExtent;
     else
     {
-        VkExtent2D actualExtent {WINDOW_WIDTH, WINDOW_HEIGHT};
+        // The window may have been resized since creation, so ask for its current framebuffer size
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        
+        VkExtent2D actualExtent {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
         
         actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
         actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
@@ -201,3 +253,8 @@ VkSurfaceFormatKHR ApplicationHelper::chooseSwapSurfaceFormat(const std::vector<
     
     return availableFormats[0];
 }
+
+VkFormat ApplicationHelper::chooseOffscreenFormat(const VkPhysicalDevice &device) const
+{
+    return ::chooseOffscreenFormat(device);
+}
@@ -16,6 +16,7 @@
 
 #include <optional>
 #include <stdio.h>
+#include <string>
 #include <vector>
 
 const int WINDOW_WIDTH = 750;
@@ -35,6 +36,10 @@ struct QueueFamilyIndices
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
     
+    // Both fall back to the graphics family when the device has nothing better
+    std::optional<uint32_t> transferFamily;
+    std::optional<uint32_t> computeFamily;
+    
     bool isComplete()
     {
         return graphicsFamily.has_value() && presentFamily.has_value();
@@ -57,25 +62,31 @@ public:
     friend class ApplicationComponentConstructor;
     
 private:
-    bool checkDeviceExtensionSupport(const VkPhysicalDevice* device) const;
+    bool checkDeviceExtensionSupport(const VkPhysicalDevice* device, const bool &headless) const;
     
     bool checkLayerValidationSupport() const;
     
+    // A null surface means headless, which drops the present and swapchain requirements
     bool isDeviceSuitable(VkPhysicalDevice const device, VkSurfaceKHR* const surface) const;
     
-    std::vector<const char*> getRequiredExtensions(const bool &enableValidationLayers) const;
+    std::vector<const char*> getRequiredExtensions(const bool &enableValidationLayers, const bool &headless) const;
+    
+    std::vector<const char*> getRequiredDeviceExtensions(const bool &headless) const;
     
     QueueFamilyIndices findQueueFamilies(const VkPhysicalDevice &device, const VkSurfaceKHR &surface) const;
     
     SwapChainSupportDetails querySwapChainSupport(const VkPhysicalDevice &device, const VkSurfaceKHR &surface) const;
     
-    VkPhysicalDevice pickPhysicalDevice(VkInstance* const instance, VkSurfaceKHR* const surface) const;
+    // deviceOverride picks a GPU by name or UUID instead of by score, see deviceSelector.hpp
+    VkPhysicalDevice pickPhysicalDevice(VkInstance* const instance, VkSurfaceKHR* const surface, const std::string &deviceOverride) const;
     
-    VkExtent2D chooseSwapSurfaceExtent(const VkSurfaceCapabilitiesKHR &capabilities) const;
+    VkExtent2D chooseSwapSurfaceExtent(const VkSurfaceCapabilitiesKHR &capabilities, GLFWwindow* const window) const;
     
     VkPresentModeKHR chooseSwapSurfacePresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes) const;
     
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats) const;
+    
+    VkFormat chooseOffscreenFormat(const VkPhysicalDevice &device) const;
 };
 
 #endif /* helper_hpp */
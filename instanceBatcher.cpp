@@ -0,0 +1,111 @@
+//
+//  instanceBatcher.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "instanceBatcher.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+void InstanceBatcher::create(VkDevice device, DeviceMemoryAllocator* memoryAllocator, uint32_t slotCount, uint32_t instanceStride, uint32_t maxInstances)
+{
+    this->device = device;
+    this->memoryAllocator = memoryAllocator;
+    this->instanceStride = instanceStride;
+    this->maxInstances = maxInstances;
+    
+    slotSize = static_cast<VkDeviceSize>(instanceStride) * maxInstances;
+    
+    VkBufferCreateInfo bufferInfo {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = slotSize * slotCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create instance buffer!");
+    
+    // Rewritten every frame and read once, so it stays in host memory rather than going through a copy
+    allocation = memoryAllocator->allocateForBuffer(buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    mappedData = static_cast<char*>(allocation.mapped);
+}
+
+void InstanceBatcher::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+    
+    vkDestroyBuffer(device, buffer, nullptr);
+    memoryAllocator->free(allocation);
+    
+    pendingBatches.clear();
+    batchLookup.clear();
+    batches.clear();
+    
+    mappedData = nullptr;
+    device = VK_NULL_HANDLE;
+}
+
+void InstanceBatcher::beginFrame(uint32_t slot)
+{
+    currentSlot = slot;
+    instanceCount = 0;
+    
+    for (auto &batch : pendingBatches)
+        batch.instances.clear();
+    
+    batches.clear();
+}
+
+void InstanceBatcher::add(uint32_t mesh, uint32_t material, const void* instances, uint32_t count)
+{
+    uint64_t key = static_cast<uint64_t>(mesh) << 32 | material;
+    
+    if (key != lastKey)
+    {
+        auto [entry, inserted] = batchLookup.try_emplace(key, static_cast<uint32_t>(pendingBatches.size()));
+        
+        if (inserted)
+            pendingBatches.push_back({mesh, material, {}});
+        
+        lastKey = key;
+        lastBatch = entry->second;
+    }
+    
+    const char* data = static_cast<const char*>(instances);
+    std::vector<char> &batchInstances = pendingBatches[lastBatch].instances;
+    
+    batchInstances.insert(batchInstances.end(), data, data + static_cast<size_t>(count) * instanceStride);
+    instanceCount += count;
+}
+
+const std::vector<InstanceBatch> &InstanceBatcher::build()
+{
+    if (instanceCount > maxInstances)
+        throw std::runtime_error("Instance buffer is full!");
+    
+    char* slotData = mappedData + getSlotOffset();
+    uint32_t firstInstance = 0;
+    
+    batches.clear();
+    
+    for (const auto &batch : pendingBatches)
+    {
+        uint32_t count = static_cast<uint32_t>(batch.instances.size() / instanceStride);
+        
+        // Pairs that showed up in earlier frames but not this one
+        if (count == 0)
+            continue;
+        
+        memcpy(slotData + static_cast<size_t>(firstInstance) * instanceStride, batch.instances.data(), batch.instances.size());
+        
+        batches.push_back({batch.mesh, batch.material, firstInstance, count});
+        firstInstance += count;
+    }
+    
+    return batches;
+}
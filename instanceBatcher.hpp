@@ -0,0 +1,92 @@
+//
+//  instanceBatcher.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef instanceBatcher_hpp
+#define instanceBatcher_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "memoryAllocator.hpp"
+
+// One instanced draw, firstInstance counts from the start of the frame slot's region
+struct InstanceBatch
+{
+    uint32_t mesh;
+    uint32_t material;
+    
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+};
+
+// Collects the instances of a frame and groups them so every mesh and material pair becomes a single instanced draw.
+// The grouped data is written into a persistently mapped buffer, one region per frame slot, bound as an instance-rate
+// vertex buffer
+class InstanceBatcher
+{
+public:
+    void create(VkDevice device, DeviceMemoryAllocator* memoryAllocator, uint32_t slotCount, uint32_t instanceStride, uint32_t maxInstances);
+    void destroy();
+    
+    // Drops the instances of the last frame, the slot's fence must already have been waited on
+    void beginFrame(uint32_t slot);
+    
+    // Copies count instances of instanceStride bytes each
+    void add(uint32_t mesh, uint32_t material, const void* instances, uint32_t count = 1);
+    
+    // Writes every instance added since beginFrame into the slot's region, batch after batch
+    const std::vector<InstanceBatch> &build();
+    
+    const std::vector<InstanceBatch> &getBatches() const { return batches; }
+    uint32_t getInstanceCount() const { return instanceCount; }
+    
+    // Bind at getSlotOffset(), the batches index from there
+    VkBuffer getBuffer() const { return buffer; }
+    VkDeviceSize getSlotOffset() const { return currentSlot * slotSize; }
+
+private:
+    struct PendingBatch
+    {
+        uint32_t mesh;
+        uint32_t material;
+        
+        // Kept between frames so a steady scene stops allocating
+        std::vector<char> instances;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    DeviceMemoryAllocator* memoryAllocator = nullptr;
+    
+    VkBuffer buffer = VK_NULL_HANDLE;
+    MemoryAllocation allocation;
+    char* mappedData = nullptr;
+    
+    uint32_t instanceStride = 0;
+    uint32_t maxInstances = 0;
+    VkDeviceSize slotSize = 0;
+    uint32_t currentSlot = 0;
+    
+    std::vector<PendingBatch> pendingBatches;
+    std::unordered_map<uint64_t, uint32_t> batchLookup;
+    
+    // Instances usually arrive in runs of the same pair, so the last lookup is remembered
+    uint64_t lastKey = UINT64_MAX;
+    uint32_t lastBatch = 0;
+    
+    std::vector<InstanceBatch> batches;
+    uint32_t instanceCount = 0;
+};
+
+#endif /* instanceBatcher_hpp */
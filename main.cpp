@@ -22,6 +22,44 @@
 #include <cstdint>
 #include <algorithm>
 #include <fstream>
+#include <chrono>
+#include <array>
+#include <random>
+#include <filesystem>
+#include <cstring>
+#include <cmath>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "assetArchive.hpp"
+#include "bindlessTable.hpp"
+#include "bufferManager.hpp"
+#include "commandRecorder.hpp"
+#include "computePipeline.hpp"
+#include "descriptorAllocator.hpp"
+#include "deviceSelector.hpp"
+#include "frameUniforms.hpp"
+#include "frustumCulling.hpp"
+#include "gpuCulling.hpp"
+#include "gpuProfiler.hpp"
+#include "instanceBatcher.hpp"
+#include "mappedFile.hpp"
+#include "memoryAllocator.hpp"
+#include "meshFormat.hpp"
+#include "meshStreamer.hpp"
+#include "pipelineCache.hpp"
+#include "pipelineCompiler.hpp"
+#include "pipelineRegistry.hpp"
+#include "renderGraph.hpp"
+#include "renderPassBuilder.hpp"
+#include "settings.hpp"
+#include "shaderLibrary.hpp"
+#include "textureFormat.hpp"
+#include "textureStreamer.hpp"
+#include "threadPool.hpp"
+#include "tlsfAllocator.hpp"
 
 #ifdef NDEBUG
     const bool enableValidationLayers = false;
@@ -32,8 +70,6 @@
 const uint32_t WINDOW_WIDTH = 800;
 const uint32_t WINDOW_HEIGHT = 600;
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
-
 const std::vector<const char*> validationLayers = {
     "VK_LAYER_KHRONOS_validation"
 };
@@ -47,6 +83,10 @@ struct QueueFamilyIndices
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
 
+    // Both fall back to the graphics family when the device has nothing better
+    std::optional<uint32_t> transferFamily;
+    std::optional<uint32_t> computeFamily;
+    
     bool isComplete()
     {
         return graphicsFamily.has_value() && presentFamily.has_value();
@@ -61,6 +101,230 @@ struct SwapChainSupportDetails
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+struct Vertex
+{
+    float position[2];
+    float color[3];
+    
+    static VkVertexInputBindingDescription getBindingDescription()
+    {
+        VkVertexInputBindingDescription bindingDescription {};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(Vertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        
+        return bindingDescription;
+    }
+    
+    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions()
+    {
+        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions {};
+        
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[0].offset = offsetof(Vertex, position);
+        
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[1].offset = offsetof(Vertex, color);
+        
+        return attributeDescriptions;
+    }
+};
+
+const std::vector<Vertex> triangleVertices = {
+    {{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
+    {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
+    {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
+};
+
+const std::vector<uint16_t> triangleIndices = {
+    0, 1, 2
+};
+
+// Stored after the triangle in the same vertex and index buffers
+const std::vector<Vertex> quadVertices = {
+    {{-0.5f, -0.5f}, {1.0f, 1.0f, 0.0f}},
+    {{0.5f, -0.5f}, {0.0f, 1.0f, 1.0f}},
+    {{0.5f, 0.5f}, {1.0f, 0.0f, 1.0f}},
+    {{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}
+};
+
+const std::vector<uint16_t> quadIndices = {
+    0, 1, 2, 2, 3, 0
+};
+
+// Where a mesh lives in the shared vertex and index buffers
+struct MeshRange
+{
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+};
+
+const std::array<MeshRange, 2> meshRanges = {{
+    {3, 0, 0},  // Triangle
+    {6, 3, 3}   // Quad
+}};
+
+// Per-instance vertex input of Shaders/instanced.vert, read from binding 1 once per instance
+struct InstanceData
+{
+    float offset[2];
+    float scale;
+    
+    static VkVertexInputBindingDescription getBindingDescription()
+    {
+        VkVertexInputBindingDescription bindingDescription {};
+        bindingDescription.binding = 1;
+        bindingDescription.stride = sizeof(InstanceData);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        
+        return bindingDescription;
+    }
+    
+    static VkVertexInputAttributeDescription getAttributeDescription()
+    {
+        VkVertexInputAttributeDescription attributeDescription {};
+        attributeDescription.binding = 1;
+        attributeDescription.location = 2;
+        attributeDescription.format = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescription.offset = offsetof(InstanceData, offset);
+        
+        return attributeDescription;
+    }
+};
+
+// Instance counts the instancing benchmark renders, each with and without batching
+const uint32_t INSTANCING_BENCHMARK_COUNTS[] = {10000, 100000, 1000000};
+
+// Uniforms of Shaders/shader.vert, one per draw at its own dynamic offset
+struct ObjectUniforms
+{
+    float transform[16];
+};
+
+// Push constants of Shaders/shader.vert, small enough to be pushed per draw
+struct DrawConstants
+{
+    uint32_t materialIndex;
+};
+
+// Tints in Shaders/shader.vert, material 0 leaves the vertex colors alone
+const uint32_t MATERIAL_COUNT = 4;
+
+// Push constants of Shaders/overlap.comp
+struct OverlapParameters
+{
+    uint32_t iterations;
+    uint32_t baseIndex;
+};
+
+const uint32_t OVERLAP_GROUP_SIZE = 64;
+const uint32_t OVERLAP_GROUPS = 2048;
+const uint32_t OVERLAP_ITERATIONS = 2048;
+
+// Half of them share their contents with another file
+const uint32_t SHADER_BENCHMARK_COUNT = 512;
+
+const uint32_t ARCHIVE_BENCHMARK_FILES = 2048;
+
+// Generated grids from 16x16 to 512x512 vertices, the largest ones need 32-bit indices
+const uint32_t MESH_BENCHMARK_COUNT = 48;
+
+// Push constants of Shaders/layered.vert
+struct LayerConstants
+{
+    float offset[2];
+    float scale;
+    float depth;
+};
+
+// Screen-sized quads at random depths, drawn over each other about this many times per pixel on average
+const uint32_t DEPTH_BENCHMARK_LAYERS = 512;
+
+// Loop count of Shaders/shaded.frag
+const uint32_t DEPTH_BENCHMARK_SHADE_ITERATIONS = 32;
+
+// Few layers and no shading loop, so the pass is bound by attachment traffic instead of fragment work
+const uint32_t TRANSIENT_BENCHMARK_LAYERS = 8;
+
+// Builds of the example graph in the render graph benchmark, each one creates and aliases its images again
+const uint32_t RENDER_GRAPH_BENCHMARK_BUILDS = 100;
+
+// Attachments of createRenderPass(), albedo only exists with the G-buffer subpass
+const uint32_t SWAPCHAIN_ATTACHMENT = 0;
+const uint32_t DEPTH_ATTACHMENT = 1;
+const uint32_t ALBEDO_ATTACHMENT = 2;
+
+// Workers of the mesh streamer, kept apart from the recording threads
+const uint32_t MESH_STREAMING_THREADS = 2;
+
+// Generated square textures with full mip chains, in the first of BC1, ASTC 4x4 and RGBA8 the device can sample
+const uint32_t TEXTURE_BENCHMARK_COUNT = 32;
+const uint32_t TEXTURE_BENCHMARK_EXTENT = 2048;
+
+const uint32_t MATERIALS_PER_PIPELINE = 4;
+
+// Draws cycle through this many small storage buffers, each one offsets the triangle
+const uint32_t BINDLESS_BENCHMARK_BUFFERS = 256;
+
+// Culling benchmark objects are scattered over a square this many screens across, the camera circles inside it
+const float CULLING_FIELD_SCREENS = 4.0f;
+const float CULLING_OBJECT_RADIUS = 0.01f;
+
+// How recordDraws() hands each draw its resources
+enum class DrawPath
+{
+    Default,    // No descriptors at all
+    Bindless,   // The table is bound once, every draw pushes a handle
+    Classic,    // Every draw allocates, writes and binds a descriptor set of its own
+    CpuCulled,  // The object table is culled with SIMD kernels and the visible objects are drawn directly
+    GpuCulled,  // A compute pass culls the objects and the survivors are drawn indirectly
+    Unbatched,  // One draw per instance, reading the same instance buffer as Instanced
+    Instanced,  // One instanced draw per mesh and material pair
+    Layered     // Overlapping quads of the depth benchmark, optionally behind a depth-only pre-pass
+};
+
+// Accumulated over a run of frames, all times in milliseconds. GPU time comes from the profiler
+struct FramePacingStats
+{
+    double cpuTime = 0.0;
+    double frameTime = 0.0;
+    
+    uint32_t frames = 0;
+    
+    double averageCpuTime() const { return frames > 0 ? cpuTime / frames : 0.0; }
+    double averageFrameTime() const { return frames > 0 ? frameTime / frames : 0.0; }
+    
+    // 0 when CPU and GPU work fully serialize, 1 when the shorter of the two is completely hidden
+    double overlap(double gpu) const
+    {
+        double cpu = averageCpuTime(), frame = averageFrameTime();
+        
+        if (std::min(cpu, gpu) <= 0.0)
+            return 0.0;
+        
+        return std::clamp((cpu + gpu - frame) / std::min(cpu, gpu), 0.0, 1.0);
+    }
+};
+
+// Everything that belonged to a replaced swapchain, kept alive until the frames that used it retire
+struct RetiredSwapChain
+{
+    VkSwapchainKHR swapChain;
+    
+    std::vector<VkImageView> imageViews;
+    std::vector<VkFramebuffer> frameBuffers;
+    
+    AttachmentImage depthImage;
+    AttachmentImage albedoImage;
+    
+    uint64_t retiredAtFrame;
+};
+
 VkResult CreateDebugeUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger)
 {
     auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
@@ -87,215 +351,3012 @@ void ErrorCallback(int, const char* err_str)
 class HelloTriangleApplication
 {
 public:
+    HelloTriangleApplication(const ApplicationSettings &settings) : settings(settings), recordingThreads(settings.recordThreads), framesInFlight(settings.framesInFlight) {}
+    
     void run()
     {
+        // Purely CPU side, so it runs without a window or device
+        if (settings.benchmarkAllocator)
+        {
+            runAllocatorBenchmark();
+            return;
+        }
+        
+        if (settings.benchmarkArchive)
+        {
+            runArchiveBenchmark();
+            return;
+        }
+        
+        if (settings.benchmarkCpuCulling)
+        {
+            runCpuCullingBenchmark();
+            return;
+        }
+        
+        if (settings.benchmarkMeshDecode)
+        {
+            runMeshDecodeBenchmark();
+            return;
+        }
+        
         initWindow();
         initVulkan();
-        mainLoop();
+        
+        if (settings.benchmarkFramePacing)
+            runFramePacingBenchmark();
+        else if (settings.benchmarkRecording)
+            runCommandRecordingBenchmark();
+        else if (settings.benchmarkUploads)
+            runUploadBenchmark();
+        else if (settings.benchmarkAsyncCompute)
+            runAsyncComputeBenchmark();
+        else if (settings.benchmarkShaders)
+            runShaderLoadingBenchmark();
+        else if (settings.benchmarkPipelines)
+            runPipelineCompilationBenchmark();
+        else if (settings.benchmarkBindless)
+            runBindlessBenchmark();
+        else if (settings.benchmarkCulling)
+            runCullingBenchmark();
+        else if (settings.benchmarkInstancing)
+            runInstancingBenchmark();
+        else if (settings.benchmarkTextures)
+            runTextureStreamingBenchmark();
+        else if (settings.benchmarkDepth)
+            runDepthBenchmark();
+        else if (settings.benchmarkTransient)
+            runTransientAttachmentBenchmark();
+        else if (settings.benchmarkRenderGraph)
+            runRenderGraphBenchmark();
+        else
+            mainLoop();
+        
+        if (!settings.profileOutputPath.empty())
+            writeProfile(settings.profileOutputPath);
+        
         cleanup();
     }
     
 private:
-    GLFWwindow* window;
+    ApplicationSettings settings;
+    
+    GLFWwindow* window = nullptr;
     
     VkInstance instance;
     VkDebugUtilsMessengerEXT debugMessenger;
     
-    VkSurfaceKHR surface;
+    // Set with the instance extensions, device UUIDs are only read when it could enable them
+    bool deviceUUIDQueryEnabled = false;
+    
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
     
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkDevice device;
     VkQueue graphicsQueue;
+    VkQueue transferQueue;
+    VkQueue computeQueue;
     
     VkSwapchainKHR swapChain;
     std::vector<VkImage> swapChainImages;
     std::vector<VkImageView> swapChainImageViews;
     std::vector<VkFramebuffer> swapChainFrameBuffers;
     
+    // Headless mode renders into these in place of the swapchain images
+    std::vector<MemoryAllocation> offscreenImageMemory;
+    uint32_t nextOffscreenImage = 0;
+    
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
     
+    // Shared by every frame, the render pass orders each frame's use of them after the previous frame's. Neither is
+    // loaded or stored, so they are transient and on a tiler may never be backed by memory at all
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    AttachmentImage depthImage;
+    
+    // G-buffer mode only, written by the scene subpass and read back at the same pixel by the composite subpass
+    AttachmentImage albedoImage;
+    
+    // Stores the intermediates in ordinary memory instead, only for comparison in the transient attachment benchmark
+    bool storeIntermediates = false;
+    
+    // The current render pass, the intermediate images take their usage from it
+    RenderPassBuilder renderPassBuilder;
+    
+    // Every barrier and layout transition of a frame, see buildFrameGraph()
+    RenderGraph frameGraph;
+    bool frameGraphDirty = true;
+    bool frameGraphCulling = false;
+    
+    uint32_t frameGraphSwapchain = 0;
+    uint32_t frameGraphDepth = 0;
+    uint32_t frameGraphAlbedo = 0;
+    uint32_t frameGraphCommands = 0;
+    uint32_t frameGraphCounts = 0;
+    
+    // Swapchain image of the frame being recorded, for the passes of the frame graph
+    uint32_t recordingImage = 0;
+    
     VkRenderPass renderPass;
     VkPipelineLayout pipelineLayout;
     
     VkPipeline graphicsPipeline;
+    std::shared_future<VkPipeline> pendingGraphicsPipeline;
+    
+    PersistentPipelineCache pipelineCache;
+    
+    // Shares the recording threads, nothing is recorded until every startup pipeline is built
+    PipelineCompiler pipelineCompiler;
+    
+    // Owns the render pass, pipeline layout and pipeline above, along with any earlier versions of them
+    PipelineRegistry pipelineRegistry;
+    
+    // Every storage buffer and sampled image shaders can reach, addressed by handle
+    DescriptorIndexingSupport descriptorIndexing;
+    BindlessTable bindlessTable;
+    
+    // Only the bindless benchmark leaves the default path, the pipeline and layout then belong to the registry
+    DrawPath drawPath = DrawPath::Default;
+    VkPipeline drawPathPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout drawPathLayout = VK_NULL_HANDLE;
+    
+    std::vector<DeviceBuffer> drawDataBuffers;
+    std::vector<uint32_t> drawDataHandles;
+    
+    // Classic path only, its sets come from the frame descriptor allocator
+    VkDescriptorSetLayout classicSetLayout = VK_NULL_HANDLE;
+    
+    // Composite subpass of G-buffer mode, its set is written every frame as the albedo view changes with the swapchain
+    VkDescriptorSetLayout compositeSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout compositeLayout = VK_NULL_HANDLE;
+    VkPipeline compositePipeline = VK_NULL_HANDLE;
+    
+    IndirectDrawSupport indirectDraws;
+    
+    // Objects of the culling paths, drawn with cullingViewProjection and culled against cullingFrustum
+    GpuCuller gpuCuller;
+    std::vector<CullObject> cullObjects;
+    
+    // The same objects' bounding spheres for CPU culling, with the indices that survived the current frame
+    SceneObjectTable sceneObjects;
+    std::vector<uint32_t> visibleObjects;
+    CullingKernel cullingKernel = detectCullingKernel();
+    float cullingViewProjection[16] {};
+    Frustum cullingFrustum {};
+    
+    // Instances of the instancing paths, regenerated every frame
+    InstanceBatcher instanceBatcher;
+    uint32_t sceneInstances = 0;
+    
+    // Quads of the layered path. With the pre-pass pipeline set every layer is drawn twice, depth only first
+    std::vector<LayerConstants> sceneLayers;
+    VkPipeline layerPrepassPipeline = VK_NULL_HANDLE;
     
-    VkCommandPool commandPool;
-    std::vector<VkCommandBuffer> commandBuffers;
+    // Counts fragment shader invocations of the main pass per frame slot while it exists
+    VkQueryPool statisticsQueryPool = VK_NULL_HANDLE;
+    
+    // Per-frame sets for anything that is not in the bindless table, reset with the slot's fence
+    FrameDescriptorAllocator descriptorAllocator;
+    
+    // Object transforms of the default path, one element per draw
+    FrameUniformBuffer frameUniforms;
+    
+    DeviceMemoryAllocator memoryAllocator;
+    
+    BufferManager bufferManager;
+    DeviceBuffer vertexBuffer;
+    DeviceBuffer indexBuffer;
+    
+    // Signaled by the geometry upload, the first frame submitted afterwards waits on it
+    VkSemaphore uploadSemaphore = VK_NULL_HANDLE;
+    
+    ComputeQueue asyncCompute;
+    
+    // Signaled by compute work whose results the next graphics submit reads
+    VkSemaphore computeSemaphore = VK_NULL_HANDLE;
+    
+    // Busy work for the async compute benchmark, only created when it runs
+    ComputePipeline overlapPipeline;
+    VkDescriptorSetLayout overlapSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool overlapDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet overlapDescriptorSet = VK_NULL_HANDLE;
+    DeviceBuffer overlapResults;
+    
+    // Command buffers are recorded again every frame, the draw list is split across these threads
+    ThreadPool recordingThreads;
+    ParallelCommandRecorder commandRecorder;
     
     std::vector<VkSemaphore> imageAvailableSemaphore;
     std::vector<VkSemaphore> renderFinishedSemaphore;
     std::vector<VkFence> inFlightFences;
     std::vector<VkFence> imagesInFlight;
     
+    uint32_t framesInFlight;
     size_t currentFrame = 0;
+    uint64_t submittedFrames = 0;
+    
+    std::vector<RetiredSwapChain> retiredSwapChains;
+    
+    bool framebufferResized = false;
+    std::chrono::steady_clock::time_point resizeStart;
+    bool measuringResize = false;
+    
+    // Every shader module, shared by all pipelines that use the same SPIR-V
+    ShaderLibrary shaderLibrary;
+    
+    // Looked up before loose files when it exists
+    AssetArchive assetArchive;
+    
+    // Meshes from --mesh, uploaded a few per frame as they finish decoding
+    MeshStreamer meshStreamer;
+    std::chrono::steady_clock::time_point meshStreamingStart;
+    bool meshStreamingDone = false;
+    
+    // Textures from --texture, sampled through the bindless table at whatever resolution is resident
+    TextureStreamer textureStreamer;
+    bool textureStreamingDone = false;
+    
+    // GPU scopes of the graphics command buffers and the CPU phases of drawFrame
+    GpuProfiler profiler;
+    bool profileRequested = false;
+    
+    FramePacingStats frameStats;
+    std::chrono::steady_clock::time_point lastFrameStart;
+    bool hasLastFrameStart = false;
     
     void initWindow()
     {
+        if (settings.headless)
+            return;
+        
         glfwInit();
         
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
         
         window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Vulkan Window", nullptr, nullptr);
+        
+        glfwSetWindowUserPointer(window, this);
+        glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+        glfwSetKeyCallback(window, keyCallback);
+    }
+    
+    static void keyCallback(GLFWwindow* window, int key, int, int action, int)
+    {
+        auto application = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+        
+        // The profile is written between frames, never from inside a callback
+        if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+            application->profileRequested = true;
+    }
+    
+    static void framebufferResizeCallback(GLFWwindow* window, int, int)
+    {
+        auto application = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+        
+        // Latency is measured from the first resize event of a burst
+        if (!application->measuringResize)
+        {
+            application->resizeStart = std::chrono::steady_clock::now();
+            application->measuringResize = true;
+        }
+        
+        application->framebufferResized = true;
     }
     
     void initVulkan()
     {
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        
+        Clock::time_point startupStart = Clock::now();
+        
         glfwSetErrorCallback(ErrorCallback);
         
         createInstance();
         setupDebugMessenger();
-        createSurface();
+        if (!settings.headless)
+            createSurface();
+        
         pickPhysicalDevice();
         createLogicalDevice();
-        createSwapChain();
+        memoryAllocator.create(physicalDevice, device);
+        shaderLibrary.create(device);
+        openAssetArchive();
+        
+        if (settings.headless)
+            createOffscreenImages();
+        else
+            createSwapChain();
+        
         createImageViews();
+        createPipelineCache();
+        pipelineCompiler.create(device, pipelineCache.getHandle(), &recordingThreads);
+        pipelineRegistry.create(device, &pipelineCompiler);
+        frameGraph.create(device, &memoryAllocator);
+        
+        depthFormat = findDepthFormat();
         createRenderPass();
+        
+        createFrameUniforms();
+        
+        Clock::time_point pipelineStart = Clock::now();
         createGraphicsPipeline();
+        
+        createAttachmentImages();
         createFrameBuffers();
-        createCommanPool();
-        createCommandBuffers();
+        createGeometryBuffers();
+        createMeshStreamer();
+        createProfiler();
+        createBindlessTable();
+        createTextureStreamer();
+        createDescriptorAllocator();
+        createCommandRecorder();
         createSyncObjects();
+        createComputeQueue();
+        
+        // The first frame needs the pipeline, everything above overlapped with building it
+        waitForGraphicsPipeline();
+        Milliseconds pipelineTime = Clock::now() - pipelineStart;
+        
+        Milliseconds startupTime = Clock::now() - startupStart;
+        uint32_t compileThreads = recordingThreads.getThreadCount();
+        
+        // Run twice to compare: the first launch on a machine is cold, later ones should be warm
+        if (settings.pipelineCachePath.empty())
+            printf("Startup: %.2f ms (pipelines ready after %.2f ms on %u threads, pipeline cache disabled)\n", startupTime.count(), pipelineTime.count(), compileThreads);
+        else
+            printf("Startup: %.2f ms (pipelines ready after %.2f ms on %u threads, %s pipeline cache, %zu bytes loaded)\n", startupTime.count(), pipelineTime.count(), compileThreads, pipelineCache.isWarm() ? "warm" : "cold", pipelineCache.getLoadedSize());
+    }
+    
+    void openAssetArchive()
+    {
+        if (settings.assetArchivePath.empty() || !std::filesystem::exists(settings.assetArchivePath))
+            return;
+        
+        assetArchive.open(settings.assetArchivePath);
+        shaderLibrary.setArchive(&assetArchive);
+        
+        std::cout << "Loading assets from " << settings.assetArchivePath << " (" << assetArchive.getEntryCount() << " entries)" << std::endl;
+    }
+    
+    void createPipelineCache()
+    {
+        if (settings.pipelineCachePath.empty())
+            return;
+        
+        pipelineCache.create(physicalDevice, device, settings.pipelineCachePath);
     }
     
     void mainLoop()
     {
-        while (!glfwWindowShouldClose(window))
+        auto start = std::chrono::steady_clock::now();
+        uint32_t frameCount = 0;
+        
+        while (!windowShouldClose() && (settings.frameLimit == 0 || frameCount < settings.frameLimit))
+        {
+            pollEvents();
+            updateStreaming();
+            drawFrame();
+            
+            frameCount++;
+            
+            if (profileRequested)
+            {
+                writeProfile(settings.profileOutputPath.empty() ? DEFAULT_PROFILE_PATH : settings.profileOutputPath);
+                profileRequested = false;
+            }
+        }
+        
+        vkDeviceWaitIdle(device);
+        
+        if (settings.headless)
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            printf("Headless: %u frames in %.3f s (%.1f frames/s, GPU %.3f ms/frame)\n", frameCount, seconds, frameCount / seconds, profiler.getScopeStats("frame", ProfileTimeline::Gpu).average);
+        }
+    }
+    
+    void writeProfile(const std::string &path)
+    {
+        // Whatever is still in flight would otherwise be missing from the report
+        vkDeviceWaitIdle(device);
+        
+        for (uint32_t slot = 0; slot < MAX_FRAMES_IN_FLIGHT; slot++)
+            profiler.collect(slot);
+        
+        profiler.write(path);
+        
+        std::cout << "Profile written to " << path << std::endl;
+    }
+    
+    bool windowShouldClose() const
+    {
+        return window != nullptr && glfwWindowShouldClose(window);
+    }
+    
+    void pollEvents() const
+    {
+        if (window != nullptr)
+            glfwPollEvents();
+    }
+    
+    void drawFrame()
+    {
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        
+        Clock::time_point frameStart = Clock::now();
+        Milliseconds waitTime {0.0};
+        
+        if (hasLastFrameStart)
+            frameStats.frameTime += Milliseconds(frameStart - lastFrameStart).count();
+        
+        lastFrameStart = frameStart;
+        hasLastFrameStart = true;
+        
+        // The fence of this slot is the only thing that limits how far ahead of the GPU the CPU may run
+        Clock::time_point waitStart = Clock::now();
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        
+        Clock::time_point acquireStart = Clock::now();
+        profiler.addCpuSample("fence wait", Milliseconds(acquireStart - waitStart).count());
+        
+        destroyRetiredSwapChains(false);
+        
+        uint32_t imageIndex = 0;
+        
+        if (settings.headless)
+            imageIndex = nextOffscreenImage++ % static_cast<uint32_t>(swapChainImages.size());
+        else
+        {
+            VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphore[currentFrame], VK_NULL_HANDLE, &imageIndex);
+            
+            // Nothing was submitted for this slot, so its fence stays signaled and the frame can simply be retried
+            if (result == VK_ERROR_OUT_OF_DATE_KHR)
+            {
+                recreateSwapChain();
+                return;
+            }
+            else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+                throw std::runtime_error("Failed to acquire swapchain image!");
+        }
+        
+        if (imagesInFlight[imageIndex] != VK_NULL_HANDLE)
+            vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        
+        Clock::time_point recordStart = Clock::now();
+        
+        waitTime += recordStart - waitStart;
+        profiler.addCpuSample("acquire", Milliseconds(recordStart - acquireStart).count());
+        
+        imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+        
+        // The previous submission from this slot has retired, so its timestamps are ready and its pools can be reset
+        profiler.collect(static_cast<uint32_t>(currentFrame));
+        bindlessTable.beginFrame(static_cast<uint32_t>(currentFrame));
+        descriptorAllocator.beginFrame(static_cast<uint32_t>(currentFrame));
+        
+        VkCommandBuffer commandBuffer = recordCommandBuffer(imageIndex);
+        
+        Clock::time_point submitStart = Clock::now();
+        profiler.addCpuSample("record", Milliseconds(submitStart - recordStart).count());
+        
+        VkSubmitInfo submitInfo {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<VkPipelineStageFlags> waitStages;
+        
+        if (!settings.headless)
+        {
+            waitSemaphores.push_back(imageAvailableSemaphore[currentFrame]);
+            waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        }
+        
+        if (uploadSemaphore != VK_NULL_HANDLE)
+        {
+            waitSemaphores.push_back(uploadSemaphore);
+            waitStages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+            
+            uploadSemaphore = VK_NULL_HANDLE;
+        }
+        
+        if (computeSemaphore != VK_NULL_HANDLE)
+        {
+            waitSemaphores.push_back(computeSemaphore);
+            waitStages.push_back(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+            
+            computeSemaphore = VK_NULL_HANDLE;
+        }
+        
+        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+        submitInfo.pWaitSemaphores = waitSemaphores.data();
+        submitInfo.pWaitDstStageMask = waitStages.data();
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        
+        VkSemaphore signalSemaphores[] = {renderFinishedSemaphore[currentFrame]};
+        submitInfo.signalSemaphoreCount = settings.headless ? 0 : 1;
+        submitInfo.pSignalSemaphores = signalSemaphores;
+        
+         vkResetFences(device, 1, &inFlightFences[currentFrame]);
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
+            throw std::runtime_error("Failed to submit draw command buffer!");
+        
+        submittedFrames++;
+        profiler.submitted(static_cast<uint32_t>(currentFrame));
+        
+        Clock::time_point presentStart = Clock::now();
+        profiler.addCpuSample("submit", Milliseconds(presentStart - submitStart).count());
+        
+        if (!settings.headless)
+        {
+            presentImage(imageIndex, signalSemaphores[0], waitTime);
+            profiler.addCpuSample("present", Milliseconds(Clock::now() - presentStart).count());
+        }
+        
+        profiler.addCpuSample("frame", Milliseconds(Clock::now() - frameStart).count());
+        
+        frameStats.cpuTime += (Milliseconds(Clock::now() - frameStart) - waitTime).count();
+        frameStats.frames++;
+        
+        currentFrame = (currentFrame + 1) % framesInFlight;
+    }
+    
+    void presentImage(uint32_t imageIndex, VkSemaphore renderFinished, std::chrono::duration<double, std::milli> &waitTime)
+    {
+        VkPresentInfoKHR presentInfo {};
+        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        
+        presentInfo.waitSemaphoreCount = 1;
+        presentInfo.pWaitSemaphores = &renderFinished;
+        
+        VkSwapchainKHR swapChains[] = {swapChain};
+        presentInfo.swapchainCount = 1;
+        presentInfo.pSwapchains = swapChains;
+        presentInfo.pImageIndices = &imageIndex;
+        
+        // Present may block on FIFO surfaces, which is waiting rather than CPU work
+        auto waitStart = std::chrono::steady_clock::now();
+        VkResult result = vkQueuePresentKHR(graphicsQueue, &presentInfo);
+        waitTime += std::chrono::steady_clock::now() - waitStart;
+        
+        if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR && result != VK_ERROR_OUT_OF_DATE_KHR)
+            throw std::runtime_error("Failed to present swapchain image!");
+        
+        if (measuringResize && !framebufferResized && result == VK_SUCCESS)
+        {
+            double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - resizeStart).count();
+            printf("Resized to %ux%u, resize-to-first-frame %.2f ms\n", swapChainExtent.width, swapChainExtent.height, latency);
+            
+            measuringResize = false;
+        }
+        
+        if (result != VK_SUCCESS || framebufferResized)
+            recreateSwapChain();
+    }
+    
+    void recreateSwapChain()
+    {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(window, &width, &height);
+        
+        // A minimized window has no area to render to
+        while ((width == 0 || height == 0) && !glfwWindowShouldClose(window))
+        {
+            glfwWaitEvents();
+            glfwGetFramebufferSize(window, &width, &height);
+        }
+        
+        if (width == 0 || height == 0)
+            return;
+        
+        framebufferResized = false;
+        
+        auto rebuildStart = std::chrono::steady_clock::now();
+        
+        // Frames already in flight keep rendering into the old images, so those are retired instead of destroyed
+        RetiredSwapChain retired;
+        retired.swapChain = swapChain;
+        retired.imageViews = std::move(swapChainImageViews);
+        retired.frameBuffers = std::move(swapChainFrameBuffers);
+        retired.depthImage = depthImage;
+        retired.albedoImage = albedoImage;
+        retired.retiredAtFrame = submittedFrames;
+        
+        VkFormat oldFormat = swapChainImageFormat;
+        
+        createSwapChain(retired.swapChain);
+        retiredSwapChains.push_back(std::move(retired));
+        
+        // Only a format change needs another render pass. The old one stays in the registry, so frames in flight can keep using it
+        if (swapChainImageFormat != oldFormat)
+        {
+            createRenderPass();
+            createGraphicsPipeline();
+            waitForGraphicsPipeline();
+        }
+        
+        createImageViews();
+        createAttachmentImages();
+        createFrameBuffers();
+        
+        imagesInFlight.assign(swapChainImages.size(), VK_NULL_HANDLE);
+        frameGraphDirty = true;
+        
+        double rebuildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - rebuildStart).count();
+        printf("Swapchain recreated at %ux%u in %.2f ms\n", swapChainExtent.width, swapChainExtent.height, rebuildTime);
+    }
+    
+    void destroyRetiredSwapChains(bool force)
+    {
+        // Every slot has waited on its fence since retirement once framesInFlight more frames were submitted
+        auto isIdle = [&](const RetiredSwapChain &retired)
+        {
+            return force || submittedFrames >= retired.retiredAtFrame + framesInFlight;
+        };
+        
+        for (auto &retired : retiredSwapChains)
+        {
+            if (!isIdle(retired))
+                continue;
+            
+            for (auto framebuffer : retired.frameBuffers)
+                vkDestroyFramebuffer(device, framebuffer, nullptr);
+            
+            for (auto imageView : retired.imageViews)
+                vkDestroyImageView(device, imageView, nullptr);
+            
+            destroyAttachmentImage(device, &memoryAllocator, retired.depthImage);
+            destroyAttachmentImage(device, &memoryAllocator, retired.albedoImage);
+            
+            vkDestroySwapchainKHR(device, retired.swapChain, nullptr);
+        }
+        
+        retiredSwapChains.erase(std::remove_if(retiredSwapChains.begin(), retiredSwapChains.end(), isIdle), retiredSwapChains.end());
+    }
+    
+    void runFramePacingBenchmark()
+    {
+        const uint32_t warmupFrames = 60;
+        
+        std::cout << "Frame pacing benchmark, " << settings.benchmarkFrames << " frames per depth" << std::endl;
+        
+        if (!profiler.hasGpuTimestamps())
+            std::cout << "GPU timestamps are not supported on this queue, GPU time and overlap will read as 0" << std::endl;
+        
+        for (uint32_t depth = MIN_FRAMES_IN_FLIGHT; depth <= MAX_FRAMES_IN_FLIGHT; depth++)
+        {
+            setFramesInFlight(depth);
+            
+            for (uint32_t i = 0; i < warmupFrames + settings.benchmarkFrames && !windowShouldClose(); i++)
+            {
+                if (i == warmupFrames)
+                {
+                    frameStats = FramePacingStats();
+                    hasLastFrameStart = false;
+                    
+                    profiler.reset();
+                }
+                
+                pollEvents();
+                drawFrame();
+            }
+            
+            double gpuTime = profiler.getScopeStats("frame", ProfileTimeline::Gpu).average;
+            
+            printf("Frames in flight: %u | CPU %.3f ms | GPU %.3f ms | frame %.3f ms | overlap %.0f%%\n", depth, frameStats.averageCpuTime(), gpuTime, frameStats.averageFrameTime(), frameStats.overlap(gpuTime) * 100.0);
+        }
+        
+        vkDeviceWaitIdle(device);
+    }
+    
+    void runCommandRecordingBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const uint32_t warmupIterations = 10;
+        uint32_t maxWorkers = commandRecorder.getWorkerCount();
+        
+        printf("Command recording benchmark, %u draws, %u iterations per worker count\n", settings.drawCount, settings.benchmarkFrames);
+        
+        // Nothing recorded here is submitted, so slot 0 can be reset over and over
+        vkDeviceWaitIdle(device);
+        currentFrame = 0;
+        
+        double serialTime = 0.0;
+        
+        for (uint32_t workers = 1; workers <= maxWorkers; workers = (workers * 2 > maxWorkers && workers != maxWorkers) ? maxWorkers : workers * 2)
+        {
+            commandRecorder.setMaxWorkers(workers);
+            
+            for (uint32_t i = 0; i < warmupIterations; i++)
+                recordCommandBuffer(0);
+            
+            Clock::time_point start = Clock::now();
+            
+            for (uint32_t i = 0; i < settings.benchmarkFrames; i++)
+                recordCommandBuffer(0);
+            
+            double recordTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / std::max(settings.benchmarkFrames, 1u);
+            
+            if (workers == 1)
+                serialTime = recordTime;
+            
+            printf("Workers: %u | record %.3f ms | speedup %.2fx\n", workers, recordTime, serialTime / recordTime);
+        }
+        
+        commandRecorder.setMaxWorkers(0);
+    }
+    
+    void setFramesInFlight(uint32_t depth)
+    {
+        vkDeviceWaitIdle(device);
+        
+        destroySyncObjects();
+        commandRecorder.destroy();
+        
+        framesInFlight = depth;
+        currentFrame = 0;
+        
+        createCommandRecorder();
+        createSyncObjects();
+    }
+    
+    void createProfiler()
+    {
+        QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+        
+        profiler.create(physicalDevice, device, indices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT);
+    }
+    
+    void createBindlessTable()
+    {
+        // Sized for the deepest frame pacing setting, so it survives setFramesInFlight()
+        bindlessTable.create(physicalDevice, device, MAX_FRAMES_IN_FLIGHT, descriptorIndexing);
+        
+        std::cout << "Bindless table: " << (bindlessTable.isBindless() ? "descriptor indexing" : "fallback") << ", " << bindlessTable.getCapacity(BindlessResourceType::StorageBuffer) << " storage buffers, " << bindlessTable.getCapacity(BindlessResourceType::SampledImage) << " sampled images" << std::endl;
+    }
+    
+    void createTextureStreamer()
+    {
+        textureStreamer.create(physicalDevice, device, &bufferManager, &bindlessTable, &assetArchive, MAX_FRAMES_IN_FLIGHT, static_cast<VkDeviceSize>(settings.textureBudgetMegabytes) * 1024 * 1024);
+        
+        for (const auto &path : settings.texturePaths)
+            textureStreamer.request(path);
+    }
+    
+    void createFrameUniforms()
+    {
+        frameUniforms.create(physicalDevice, device, &memoryAllocator, MAX_FRAMES_IN_FLIGHT, sizeof(ObjectUniforms), settings.drawCount);
+    }
+    
+    void createDescriptorAllocator()
+    {
+        const std::vector<DescriptorPoolRatio> ratios = {
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
+            {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+            {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.1f}
+        };
+        
+        // One worker per recording thread, matching the secondary buffers of the command recorder
+        descriptorAllocator.create(device, MAX_FRAMES_IN_FLIGHT, recordingThreads.getThreadCount(), ratios);
+    }
+    
+    void createSyncObjects()
+    {
+        imageAvailableSemaphore.resize(framesInFlight);
+        renderFinishedSemaphore.resize(framesInFlight);
+        inFlightFences.resize(framesInFlight);
+        imagesInFlight.assign(swapChainImages.size(), VK_NULL_HANDLE);
+        
+        VkSemaphoreCreateInfo semaphoreInfo {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        
+        VkFenceCreateInfo fenceInfo {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        
+        for (size_t i = 0; i < framesInFlight; i++)
+            if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphore[i]) || vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphore[i]) != VK_SUCCESS || vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]))
+                throw std::runtime_error("Failed to create semaphores!");
+    }
+    
+    void destroySyncObjects() const
+    {
+        for (size_t i = 0; i < framesInFlight; i++)
+        {
+            vkDestroySemaphore(device, imageAvailableSemaphore[i], nullptr);
+            vkDestroySemaphore(device, renderFinishedSemaphore[i], nullptr);
+            vkDestroyFence(device, inFlightFences[i], nullptr);
+        }
+    }
+    
+    void createGeometryBuffers()
+    {
+        QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+        
+        bufferManager.create(physicalDevice, device, &memoryAllocator, queueFamilyIndices.graphicsFamily.value(), queueFamilyIndices.transferFamily.value(), transferQueue);
+        bufferManager.shareWithQueueFamily(queueFamilyIndices.computeFamily.value());
+        
+        VkDeviceSize triangleVertexSize = sizeof(triangleVertices[0]) * triangleVertices.size();
+        VkDeviceSize triangleIndexSize = sizeof(triangleIndices[0]) * triangleIndices.size();
+        VkDeviceSize quadVertexSize = sizeof(quadVertices[0]) * quadVertices.size();
+        VkDeviceSize quadIndexSize = sizeof(quadIndices[0]) * quadIndices.size();
+        
+        vertexBuffer = bufferManager.createDeviceBuffer(triangleVertexSize + quadVertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        indexBuffer = bufferManager.createDeviceBuffer(triangleIndexSize + quadIndexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        
+        // Laid out as described by meshRanges
+        bufferManager.upload(vertexBuffer, 0, triangleVertices.data(), triangleVertexSize);
+        bufferManager.upload(vertexBuffer, triangleVertexSize, quadVertices.data(), quadVertexSize);
+        bufferManager.upload(indexBuffer, 0, triangleIndices.data(), triangleIndexSize);
+        bufferManager.upload(indexBuffer, triangleIndexSize, quadIndices.data(), quadIndexSize);
+        
+        bufferManager.flush(&uploadSemaphore);
+    }
+    
+    void createMeshStreamer()
+    {
+        if (settings.meshPaths.empty())
+            return;
+        
+        meshStreamer.create(&bufferManager, &assetArchive, MESH_STREAMING_THREADS);
+        meshStreamingStart = std::chrono::steady_clock::now();
+        
+        for (const auto &path : settings.meshPaths)
+            meshStreamer.request(path);
+    }
+    
+    // Mesh and texture uploads of a frame go out in one transfer submit, which the frame's draws wait on
+    void updateStreaming()
+    {
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        
+        // A flush can only hand out a new upload semaphore once a submit has waited on the last one
+        if (uploadSemaphore != VK_NULL_HANDLE)
+            return;
+        
+        bool streamMeshes = meshStreamer.getMeshCount() > 0 && !meshStreamingDone;
+        bool streamTextures = textureStreamer.getTextureCount() > 0 && !textureStreamer.isSettled();
+        
+        if (!streamMeshes && !streamTextures)
+            return;
+        
+        Clock::time_point start = Clock::now();
+        
+        if (streamMeshes)
+            meshStreamer.update(DEFAULT_MESH_UPLOAD_BUDGET);
+        
+        if (streamTextures)
+            textureStreamer.update(DEFAULT_TEXTURE_UPLOAD_BUDGET);
+        
+        bufferManager.flush(&uploadSemaphore);
+        profiler.addCpuSample("streaming upload", Milliseconds(Clock::now() - start).count());
+        
+        if (streamMeshes)
+            reportMeshStreaming();
+        
+        if (streamTextures && textureStreamer.isSettled() && !textureStreamingDone)
+        {
+            textureStreamingDone = true;
+            printTextureStreamingStats();
+        }
+    }
+    
+    void reportMeshStreaming()
+    {
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        
+        if (!meshStreamer.isIdle())
+            return;
+        
+        meshStreamingDone = true;
+        
+        MeshDecodeStats stats = meshStreamer.getStats();
+        
+        printf("Streamed %u meshes in %.2f ms, %.2f MB read, %.2f MB decoded, at most %.2f MB waiting for upload\n", stats.meshesDecoded, Milliseconds(Clock::now() - meshStreamingStart).count(), stats.bytesRead / (1024.0 * 1024.0), stats.bytesDecoded / (1024.0 * 1024.0), stats.peakPendingBytes / (1024.0 * 1024.0));
+        
+        for (uint32_t i = 0; i < meshStreamer.getMeshCount(); i++)
+            if (meshStreamer.getMesh(i).state == MeshState::Failed)
+                std::cout << "Failed to stream mesh " << meshStreamer.getMesh(i).error << std::endl;
+    }
+    
+    void printTextureStreamingStats() const
+    {
+        const TextureStreamingStats &stats = textureStreamer.getStats();
+        
+        double firstVisible = 0.0;
+        double allVisible = 0.0;
+        uint32_t visible = 0;
+        uint32_t complete = 0;
+        
+        for (uint32_t i = 0; i < textureStreamer.getTextureCount(); i++)
+        {
+            double time = textureStreamer.getTimeToVisible(i);
+            
+            if (time < 0.0)
+                continue;
+            
+            firstVisible = visible == 0 ? time : std::min(firstVisible, time);
+            allVisible = std::max(allVisible, time);
+            visible++;
+            
+            if (textureStreamer.getResidentLevel(i) == 0)
+                complete++;
+        }
+        
+        printf("Streamed %u textures, %u visible, %u at full resolution | first visible after %.2f ms, last after %.2f ms\n", textureStreamer.getTextureCount(), visible, complete, firstVisible, allVisible);
+        printf("%.2f MB uploaded over %u frames, %.2f MB per frame on average, %.2f MB at most | %.2f of %.2f MB resident | %u upgrades, %u downgrades\n", stats.bytesUploaded / (1024.0 * 1024.0), stats.framesWithUploads, stats.framesWithUploads > 0 ? stats.bytesUploaded / (1024.0 * 1024.0) / stats.framesWithUploads : 0.0, stats.maxBytesUploadedPerFrame / (1024.0 * 1024.0), stats.residentBytes / (1024.0 * 1024.0), textureStreamer.getBudget() / (1024.0 * 1024.0), stats.upgrades, stats.downgrades);
+    }
+    
+    void runTextureStreamingBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        
+        const std::pair<VkFormat, const char*> formats[] = {{VK_FORMAT_BC1_RGB_UNORM_BLOCK, "BC1"}, {VK_FORMAT_ASTC_4x4_UNORM_BLOCK, "ASTC 4x4"}, {VK_FORMAT_R8G8B8A8_UNORM, "RGBA8"}};
+        const std::pair<VkFormat, const char*>* format = nullptr;
+        
+        for (const auto &candidate : formats)
+        {
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, candidate.first, &properties);
+            
+            if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+            {
+                format = &candidate;
+                break;
+            }
+        }
+        
+        if (format == nullptr)
+            throw std::runtime_error("Failed to find a texture format the device can sample!");
+        
+        FormatBlock block;
+        getFormatBlock(format->first, block);
+        
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "VulkanProjectTextures";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        
+        uint32_t levelCount = static_cast<uint32_t>(std::floor(std::log2(TEXTURE_BENCHMARK_EXTENT))) + 1;
+        std::mt19937 random(7);
+        
+        std::vector<std::string> paths;
+        uint64_t fileBytes = 0;
+        
+        // Random blocks, the contents do not matter to the upload
+        for (uint32_t i = 0; i < TEXTURE_BENCHMARK_COUNT; i++)
+        {
+            std::vector<std::vector<uint8_t>> levels(levelCount);
+            
+            for (uint32_t level = 0; level < levelCount; level++)
+            {
+                levels[level].resize(getLevelSize(block, TEXTURE_BENCHMARK_EXTENT, TEXTURE_BENCHMARK_EXTENT, level));
+                
+                for (auto &byte : levels[level])
+                    byte = static_cast<uint8_t>(random());
+            }
+            
+            std::vector<uint8_t> encoded = writeKtx2(format->first, TEXTURE_BENCHMARK_EXTENT, TEXTURE_BENCHMARK_EXTENT, levels);
+            std::string path = (directory / ("texture" + std::to_string(i) + ".ktx2")).string();
+            
+            std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            
+            paths.push_back(path);
+            fileBytes += encoded.size();
+        }
+        
+        printf("Texture streaming benchmark, %u %ux%u %s textures, %.2f MB of files, %.2f MB budget\n", TEXTURE_BENCHMARK_COUNT, TEXTURE_BENCHMARK_EXTENT, TEXTURE_BENCHMARK_EXTENT, format->second, fileBytes / (1024.0 * 1024.0), textureStreamer.getBudget() / (1024.0 * 1024.0));
+        
+        // Streamed while frames keep going, updateStreaming() prints the streamer's own stats once it settles
+        vkDeviceWaitIdle(device);
+        
+        Clock::time_point start = Clock::now();
+        double longestFrame = 0.0;
+        uint32_t frames = 0;
+        
+        for (const auto &path : paths)
+            textureStreamer.request(path);
+        
+        while (!textureStreamer.isSettled() && !windowShouldClose())
+        {
+            Clock::time_point frameStart = Clock::now();
+            
+            pollEvents();
+            updateStreaming();
+            drawFrame();
+            
+            longestFrame = std::max(longestFrame, Milliseconds(Clock::now() - frameStart).count());
+            frames++;
+        }
+        
+        vkDeviceWaitIdle(device);
+        
+        printf("Streaming: settled after %.2f ms over %u frames, longest frame %.2f ms\n", Milliseconds(Clock::now() - start).count(), frames, longestFrame);
+        
+        // Every full chain in one frame, the way a loader without streaming makes textures resident
+        std::vector<DeviceImage> images;
+        VkDeviceSize uploadedBytes = 0;
+        
+        start = Clock::now();
+        
+        for (const auto &path : paths)
+        {
+            MappedFile file(path);
+            TextureLayout layout = parseKtx2(file.data(), file.size());
+            
+            DeviceImage image = bufferManager.createDeviceImage(layout.format, layout.width, layout.height, static_cast<uint32_t>(layout.levels.size()), VK_IMAGE_USAGE_SAMPLED_BIT);
+            
+            for (uint32_t level = 0; level < layout.levels.size(); level++)
+            {
+                bufferManager.uploadImage(image, level, layout.block.height, layout.levels[level].rowPitch, file.data() + layout.levels[level].offset);
+                uploadedBytes += layout.levels[level].size;
+            }
+            
+            images.push_back(image);
+        }
+        
+        pollEvents();
+        
+        if (uploadSemaphore == VK_NULL_HANDLE)
+            bufferManager.flush(&uploadSemaphore);
+        
+        drawFrame();
+        
+        double frameTime = Milliseconds(Clock::now() - start).count();
+        
+        vkDeviceWaitIdle(device);
+        
+        printf("All at once: resident after %.2f ms, %.2f MB in a single frame taking %.2f ms\n", Milliseconds(Clock::now() - start).count(), uploadedBytes / (1024.0 * 1024.0), frameTime);
+        
+        for (auto &image : images)
+            bufferManager.destroyImage(image);
+        
+        std::filesystem::remove_all(directory);
+    }
+    
+    void runUploadBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const VkDeviceSize totalSize = 256 * 1024 * 1024;
+        const VkDeviceSize uploadSizes[] = {256, 4 * 1024, 64 * 1024, 1024 * 1024, 64 * 1024 * 1024};
+        
+        printf("Upload benchmark, %llu MB per run, %s transfer queue\n", static_cast<unsigned long long>(totalSize / (1024 * 1024)), bufferManager.hasDedicatedTransferQueue() ? "dedicated" : "graphics");
+        
+        DeviceBuffer destination = bufferManager.createDeviceBuffer(totalSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        std::vector<char> source(totalSize, 1);
+        
+        for (VkDeviceSize uploadSize : uploadSizes)
+        {
+            bufferManager.waitIdle();
+            bufferManager.resetStats();
+            
+            Clock::time_point start = Clock::now();
+            
+            for (VkDeviceSize offset = 0; offset < totalSize; offset += uploadSize)
+                bufferManager.upload(destination, offset, source.data() + offset, uploadSize);
+            
+            bufferManager.waitIdle();
+            
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            const UploadStats &stats = bufferManager.getStats();
+            
+            printf("Upload size: %llu bytes | %llu uploads | %llu copy regions | %llu submits | %.1f MB/s\n", static_cast<unsigned long long>(uploadSize), static_cast<unsigned long long>(stats.uploads), static_cast<unsigned long long>(stats.copyRegions), static_cast<unsigned long long>(stats.submits), stats.bytesUploaded / (1024.0 * 1024.0) / seconds);
+        }
+        
+        bufferManager.destroyBuffer(destination);
+    }
+    
+    
+    // Drops a file from the page cache so the next read has to go to the disk. Pages have to be clean for that
+    static bool evictFromPageCache(const std::string &path)
+    {
+#ifdef POSIX_FADV_DONTNEED
+        int descriptor = open(path.c_str(), O_RDONLY);
+        
+        if (descriptor < 0)
+            return false;
+        
+        bool evicted = fdatasync(descriptor) == 0 && posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(descriptor);
+        
+        return evicted;
+#else
+        return false;
+#endif
+    }
+    
+    void runArchiveBenchmark() const
+    {
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "VulkanProjectAssets";
+        std::filesystem::remove_all(directory);
+        
+        // Text-like contents of mixed sizes, so compression has something to find
+        std::mt19937 random(42);
+        std::uniform_int_distribution<uint32_t> sizeDistribution(256, 64 * 1024);
+        std::vector<ArchiveSource> sources;
+        
+        for (uint32_t i = 0; i < ARCHIVE_BENCHMARK_FILES; i++)
+        {
+            ArchiveSource source;
+            source.name = "assets/group" + std::to_string(i % 16) + "/asset" + std::to_string(i) + ".bin";
+            source.data.resize(sizeDistribution(random));
+            
+            for (auto &byte : source.data)
+                byte = static_cast<uint8_t>('a' + random() % 8);
+            
+            std::filesystem::create_directories((directory / source.name).parent_path());
+            std::ofstream(directory / source.name, std::ios::binary).write(reinterpret_cast<const char*>(source.data.data()), source.data.size());
+            
+            sources.push_back(std::move(source));
+        }
+        
+        std::string archivePath = (directory / "assets.pak").string();
+        std::string compressedPath = (directory / "assets_compressed.pak").string();
+        
+        writeAssetArchive(archivePath, sources, false);
+        writeAssetArchive(compressedPath, sources, true);
+        
+        bool cold = true;
+        
+        auto evictAll = [&]()
+        {
+            for (const auto &source : sources)
+                cold = evictFromPageCache((directory / source.name).string()) && cold;
+            
+            cold = evictFromPageCache(archivePath) && evictFromPageCache(compressedPath) && cold;
+        };
+        
+        uint64_t checksum = 0;
+        
+        evictAll();
+        Clock::time_point start = Clock::now();
+        
+        for (const auto &source : sources)
+        {
+            std::ifstream file(directory / source.name, std::ios::ate | std::ios::binary);
+            std::vector<char> data(static_cast<size_t>(file.tellg()));
+            
+            file.seekg(0);
+            file.read(data.data(), data.size());
+            
+            checksum += static_cast<uint8_t>(data.back());
+        }
+        
+        double looseTime = Milliseconds(Clock::now() - start).count();
+        
+        auto readArchive = [&](const std::string &path)
+        {
+            evictAll();
+            Clock::time_point archiveStart = Clock::now();
+            
+            AssetArchive archive;
+            archive.open(path);
+            
+            for (const auto &source : sources)
+            {
+                const ArchiveEntry* entry = archive.find(source.name);
+                
+                if (entry == nullptr)
+                    throw std::runtime_error("Missing archive entry: " + source.name);
+                
+                checksum += archive.read(*entry).back();
+            }
+            
+            return Milliseconds(Clock::now() - archiveStart).count();
+        };
+        
+        double archiveTime = readArchive(archivePath);
+        double compressedTime = readArchive(compressedPath);
+        
+        printf("Archive benchmark, %u files, %s page cache (checksum %llu)\n", ARCHIVE_BENCHMARK_FILES, cold ? "cold" : "warm, could not evict", static_cast<unsigned long long>(checksum));
+        printf("Loose files: %.3f ms | %.2f us per file\n", looseTime, looseTime * 1000.0 / ARCHIVE_BENCHMARK_FILES);
+        printf("Archive: %.3f ms | %.2f us per file | %ju bytes\n", archiveTime, archiveTime * 1000.0 / ARCHIVE_BENCHMARK_FILES, static_cast<uintmax_t>(std::filesystem::file_size(archivePath)));
+        printf("Compressed archive: %.3f ms | %.2f us per file | %ju bytes\n", compressedTime, compressedTime * 1000.0 / ARCHIVE_BENCHMARK_FILES, static_cast<uintmax_t>(std::filesystem::file_size(compressedPath)));
+        
+        std::filesystem::remove_all(directory);
+    }
+    
+    void runCpuCullingBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        using Nanoseconds = std::chrono::duration<double, std::nano>;
+        
+        const uint32_t iterations = 50;
+        const float fieldSize = 100.0f;
+        
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> position(-fieldSize, fieldSize);
+        std::uniform_real_distribution<float> radius(0.1f, 2.0f);
+        
+        // A few objects are switched off or never culled, so the flag handling is part of what is measured
+        SceneObjectTable table;
+        table.reserve(settings.drawCount);
+        
+        for (uint32_t i = 0; i < settings.drawCount; i++)
+        {
+            float center[3] = {position(random), position(random), position(random)};
+            uint32_t flags = i % 16 == 0 ? 0 : (i % 256 == 1 ? SCENE_OBJECT_ACTIVE | SCENE_OBJECT_ALWAYS_VISIBLE : SCENE_OBJECT_ACTIVE);
+            
+            table.add(center, radius(random), flags);
+        }
+        
+        // 60 degree perspective from the middle of the field down -z, column major with 0..1 depth
+        const float nearPlane = 0.1f, farPlane = fieldSize;
+        const float focal = 1.0f / std::tan(0.5f * 60.0f * 3.14159265f / 180.0f);
+        
+        float viewProjection[16] = {
+            focal / (16.0f / 9.0f), 0.0f, 0.0f, 0.0f,
+            0.0f, focal, 0.0f, 0.0f,
+            0.0f, 0.0f, farPlane / (nearPlane - farPlane), -1.0f,
+            0.0f, 0.0f, nearPlane * farPlane / (nearPlane - farPlane), 0.0f
+        };
+        
+        Frustum frustum = extractFrustum(viewProjection);
+        CullingKernel widest = detectCullingKernel();
+        
+        printf("CPU culling benchmark, %u objects, %u iterations, widest kernel %s\n", table.size(), iterations, getCullingKernelName(widest));
+        
+        std::vector<uint32_t> visible(table.size());
+        std::vector<uint32_t> expected;
+        
+        for (CullingKernel kernel : {CullingKernel::Scalar, CullingKernel::Sse, CullingKernel::Avx2})
+        {
+            if (kernel > widest)
+                break;
+            
+            uint32_t count = 0;
+            Clock::time_point start = Clock::now();
+            
+            for (uint32_t i = 0; i < iterations; i++)
+                count = cullSpheres(kernel, frustum, table, 0, table.size(), visible.data());
+            
+            Nanoseconds time = Clock::now() - start;
+            
+            if (kernel == CullingKernel::Scalar)
+                expected.assign(visible.begin(), visible.begin() + count);
+            else if (!std::equal(expected.begin(), expected.end(), visible.begin(), visible.begin() + count))
+                throw std::runtime_error("Culling kernels disagree on the visible set!");
+            
+            printf("%s, 1 thread: %.3f objects/ns | %u visible\n", getCullingKernelName(kernel), static_cast<double>(table.size()) * iterations / time.count(), count);
+        }
+        
+        Clock::time_point start = Clock::now();
+        
+        for (uint32_t i = 0; i < iterations; i++)
+            cullSpheresParallel(recordingThreads, widest, frustum, table, visible);
+        
+        Nanoseconds time = Clock::now() - start;
+        
+        if (visible != expected)
+            throw std::runtime_error("Parallel culling disagrees on the visible set!");
+        
+        printf("%s, %u threads: %.3f objects/ns | %zu visible\n", getCullingKernelName(widest), recordingThreads.getThreadCount(), static_cast<double>(table.size()) * iterations / time.count(), visible.size());
+    }
+    
+    // A unit square of side x side vertices with gentle waves, so the normals are not all the same
+    static SourceMesh createGridMesh(uint32_t side)
+    {
+        SourceMesh mesh;
+        mesh.vertices.reserve(static_cast<size_t>(side) * side);
+        mesh.indices.reserve(static_cast<size_t>(side - 1) * (side - 1) * 6);
+        
+        for (uint32_t row = 0; row < side; row++)
+        {
+            for (uint32_t column = 0; column < side; column++)
+            {
+                float x = static_cast<float>(column) / (side - 1) - 0.5f;
+                float z = static_cast<float>(row) / (side - 1) - 0.5f;
+                
+                MeshVertex vertex {};
+                vertex.position[0] = x;
+                vertex.position[1] = 0.1f * std::sin(x * 6.0f) * std::cos(z * 6.0f);
+                vertex.position[2] = z;
+                
+                float slopeX = 0.6f * std::cos(x * 6.0f) * std::cos(z * 6.0f);
+                float slopeZ = -0.6f * std::sin(x * 6.0f) * std::sin(z * 6.0f);
+                float length = std::sqrt(slopeX * slopeX + 1.0f + slopeZ * slopeZ);
+                
+                vertex.normal[0] = -slopeX / length;
+                vertex.normal[1] = 1.0f / length;
+                vertex.normal[2] = -slopeZ / length;
+                
+                mesh.vertices.push_back(vertex);
+            }
+        }
+        
+        for (uint32_t row = 0; row + 1 < side; row++)
+        {
+            for (uint32_t column = 0; column + 1 < side; column++)
+            {
+                uint32_t corner = row * side + column;
+                
+                mesh.indices.insert(mesh.indices.end(), {corner, corner + side, corner + 1, corner + 1, corner + side, corner + side + 1});
+            }
+        }
+        
+        return mesh;
+    }
+    
+    // ru_maxrss is in kilobytes on Linux and in bytes on macOS
+    static double getPeakResidentMegabytes()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+        return usage.ru_maxrss / 1024.0;
+#endif
+    }
+    
+    void runMeshDecodeBenchmark() const
+    {
+        using Clock = std::chrono::steady_clock;
+        using Seconds = std::chrono::duration<double>;
+        
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "VulkanProjectMeshes";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        
+        std::vector<std::string> paths;
+        uint64_t encodedBytes = 0;
+        
+        for (uint32_t i = 0; i < MESH_BENCHMARK_COUNT; i++)
+        {
+            std::vector<uint8_t> encoded = encodeMesh(createGridMesh(16u << (i % 6)));
+            std::string path = (directory / ("mesh" + std::to_string(i) + ".vmesh")).string();
+            
+            std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+            
+            paths.push_back(path);
+            encodedBytes += encoded.size();
+        }
+        
+        double megabytes = encodedBytes / (1024.0 * 1024.0);
+        double startResident = getPeakResidentMegabytes();
+        
+        printf("Mesh decode benchmark, %u meshes, %.2f MB encoded, warm page cache\n", MESH_BENCHMARK_COUNT, megabytes);
+        
+        // Straight through on this thread, as a loader without the decoder would do it
+        uint64_t decodedBytes = 0;
+        Clock::time_point start = Clock::now();
+        
+        for (const auto &path : paths)
+        {
+            MappedFile file(path);
+            decodedBytes += decodeMesh(file.data(), file.size()).getByteSize();
+        }
+        
+        Seconds serialTime = Clock::now() - start;
+        
+        printf("Serial: %.1f MB/s read | %.1f MB/s decoded\n", megabytes / serialTime.count(), decodedBytes / (1024.0 * 1024.0) / serialTime.count());
+        
+        uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        
+        for (uint32_t threads = 1; threads <= maxThreads; threads = (threads * 2 > maxThreads && threads != maxThreads) ? maxThreads : threads * 2)
+        {
+            MeshDecoder decoder;
+            decoder.create(nullptr, threads);
+            
+            start = Clock::now();
+            
+            for (const auto &path : paths)
+                decoder.request(path);
+            
+            // Taken as soon as they finish, the way the streamer's per-frame update would if it had no budget
+            DecodedMesh mesh;
+            
+            while (decoder.waitFinished(mesh))
+            {
+                if (!mesh.error.empty())
+                    throw std::runtime_error("Failed to decode " + mesh.error);
+            }
+            
+            Seconds time = Clock::now() - start;
+            MeshDecodeStats stats = decoder.getStats();
+            
+            decoder.destroy();
+            
+            printf("Decoder, %u threads: %.1f MB/s read | %.1f MB/s decoded | speedup %.2fx | at most %.2f MB waiting\n", threads, megabytes / time.count(), stats.bytesDecoded / (1024.0 * 1024.0) / time.count(), serialTime.count() / time.count(), stats.peakPendingBytes / (1024.0 * 1024.0));
+        }
+        
+        printf("Peak resident set: %.1f MB (%.1f MB before decoding)\n", getPeakResidentMegabytes(), startResident);
+        
+        std::filesystem::remove_all(directory);
+    }
+    
+    void runAllocatorBenchmark() const
+    {
+        using Clock = std::chrono::steady_clock;
+        using Nanoseconds = std::chrono::duration<double, std::nano>;
+        
+        const uint64_t heapSize = 512ull * 1024 * 1024;
+        const uint32_t liveAllocations = 4096;
+        const uint32_t batchSize = 256;
+        const uint32_t batches = 4000;
+        
+        // Buffer and small image shaped requests: 256 B to 256 KB, aligned anywhere from 16 B to 4 KB
+        struct Request
+        {
+            uint32_t slot;
+            uint64_t size;
+            uint64_t alignment;
+        };
+        
+        std::mt19937 random(1234);
+        
+        auto makeRequest = [&](uint32_t slot)
+        {
+            return Request {slot, (256ull << (random() % 11)) + random() % 256, 16ull << (random() % 9)};
+        };
+        
+        std::vector<Request> requests;
+        requests.reserve(batches * batchSize);
+        
+        for (uint32_t i = 0; i < batches * batchSize; i++)
+            requests.push_back(makeRequest(random() % liveAllocations));
+        
+        printf("Allocator churn benchmark, %u live allocations, %u frees and allocations\n", liveAllocations, batches * batchSize);
+        
+        TlsfAllocator allocator(heapSize);
+        std::vector<uint32_t> handles(liveAllocations);
+        uint64_t offset = 0;
+        
+        for (uint32_t i = 0; i < liveAllocations; i++)
+        {
+            Request request = makeRequest(i);
+            handles[i] = allocator.allocate(request.size, request.alignment, offset);
+        }
+        
+        Nanoseconds allocTime {0.0}, freeTime {0.0};
+        uint32_t failures = 0;
+        
+        // Timed a batch at a time so the clock itself stays out of the numbers
+        for (uint32_t batch = 0; batch < batches; batch++)
+        {
+            const Request* batchRequests = &requests[batch * batchSize];
+            
+            Clock::time_point start = Clock::now();
+            
+            for (uint32_t i = 0; i < batchSize; i++)
+            {
+                uint32_t &handle = handles[batchRequests[i].slot];
+                
+                if (handle != TlsfAllocator::INVALID_HANDLE)
+                    allocator.free(handle);
+                
+                handle = TlsfAllocator::INVALID_HANDLE;
+            }
+            
+            Clock::time_point middle = Clock::now();
+            
+            for (uint32_t i = 0; i < batchSize; i++)
+            {
+                uint32_t &handle = handles[batchRequests[i].slot];
+                
+                if (handle == TlsfAllocator::INVALID_HANDLE)
+                    handle = allocator.allocate(batchRequests[i].size, batchRequests[i].alignment, offset);
+                
+                failures += handle == TlsfAllocator::INVALID_HANDLE;
+            }
+            
+            freeTime += middle - start;
+            allocTime += Clock::now() - middle;
+        }
+        
+        double operations = static_cast<double>(batches) * batchSize;
+        
+        printf("TLSF   | alloc %.1f ns | free %.1f ns | failed %u | heap %.1f%% used\n", allocTime.count() / operations, freeTime.count() / operations, failures, 100.0 * (1.0 - static_cast<double>(allocator.getFreeSize()) / allocator.getSize()));
+        
+        // The same churn through malloc for scale, alignment ignored
+        std::vector<void*> pointers(liveAllocations);
+        
+        for (uint32_t i = 0; i < liveAllocations; i++)
+            pointers[i] = malloc(makeRequest(i).size);
+        
+        allocTime = freeTime = Nanoseconds(0.0);
+        
+        for (uint32_t batch = 0; batch < batches; batch++)
+        {
+            const Request* batchRequests = &requests[batch * batchSize];
+            
+            Clock::time_point start = Clock::now();
+            
+            for (uint32_t i = 0; i < batchSize; i++)
+            {
+                free(pointers[batchRequests[i].slot]);
+                pointers[batchRequests[i].slot] = nullptr;
+            }
+            
+            Clock::time_point middle = Clock::now();
+            
+            for (uint32_t i = 0; i < batchSize; i++)
+                if (pointers[batchRequests[i].slot] == nullptr)
+                    pointers[batchRequests[i].slot] = malloc(batchRequests[i].size);
+            
+            freeTime += middle - start;
+            allocTime += Clock::now() - middle;
+        }
+        
+        for (void* pointer : pointers)
+            free(pointer);
+        
+        printf("malloc | alloc %.1f ns | free %.1f ns\n", allocTime.count() / operations, freeTime.count() / operations);
+    }
+    
+    
+    void createComputeQueue()
+    {
+        QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+        
+        asyncCompute.create(device, queueFamilyIndices.computeFamily.value(), computeQueue, MAX_FRAMES_IN_FLIGHT);
+        
+        if (settings.benchmarkAsyncCompute)
+            createOverlapWorkload();
+    }
+    
+    void createOverlapWorkload()
+    {
+        VkDescriptorSetLayoutBinding resultsBinding {};
+        resultsBinding.binding = 0;
+        resultsBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        resultsBinding.descriptorCount = 1;
+        resultsBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        
+        VkDescriptorSetLayoutCreateInfo layoutInfo {};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &resultsBinding;
+        
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &overlapSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout!");
+        
+        VkDescriptorPoolSize poolSize {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1};
+        
+        VkDescriptorPoolCreateInfo poolInfo {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &overlapDescriptorPool) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor pool!");
+        
+        VkDescriptorSetAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = overlapDescriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &overlapSetLayout;
+        
+        if (vkAllocateDescriptorSets(device, &allocInfo, &overlapDescriptorSet) != VK_SUCCESS)
+            throw std::runtime_error("Failed to allocate descriptor set!");
+        
+        // Every compute slot writes its own range, so dispatches in flight together never touch the same memory
+        VkDeviceSize slotSize = static_cast<VkDeviceSize>(OVERLAP_GROUPS) * OVERLAP_GROUP_SIZE * sizeof(float);
+        overlapResults = bufferManager.createDeviceBuffer(slotSize * MAX_FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        
+        VkDescriptorBufferInfo bufferInfo {};
+        bufferInfo.buffer = overlapResults.buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+        
+        VkWriteDescriptorSet descriptorWrite {};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = overlapDescriptorSet;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo = &bufferInfo;
+        
+        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+        
+        overlapPipeline = ComputePipelineBuilder()
+            .setShader(shaderLibrary.load("Shaders/overlap.spv"))
+            .addDescriptorSetLayout(overlapSetLayout)
+            .setPushConstantSize(sizeof(OverlapParameters))
+            .setPipelineCache(pipelineCache.getHandle())
+            .build(device);
+    }
+    
+    VkSemaphore dispatchOverlapWorkload(uint32_t slot, bool signal)
+    {
+        VkCommandBuffer commandBuffer = asyncCompute.begin(slot);
+        
+        OverlapParameters parameters {OVERLAP_ITERATIONS, slot * OVERLAP_GROUPS * OVERLAP_GROUP_SIZE};
+        recordDispatch(commandBuffer, overlapPipeline, {overlapDescriptorSet}, &parameters, OVERLAP_GROUPS);
+        
+        return asyncCompute.submit(slot, VK_NULL_HANDLE, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, signal);
+    }
+    
+    // Waits on a semaphore nothing else is going to wait on, so its slot may signal it again
+    void consumeSemaphore(VkSemaphore semaphore)
+    {
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        
+        VkSubmitInfo submitInfo {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &semaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            throw std::runtime_error("Failed to submit semaphore wait!");
+    }
+    
+    void runAsyncComputeBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        printf("Async compute benchmark, %u frames per phase, compute on %s\n", settings.benchmarkFrames, computeQueue != graphicsQueue ? "its own queue" : "the graphics queue");
+        
+        auto runPhase = [&](bool graphics, bool compute)
+        {
+            vkDeviceWaitIdle(device);
+            
+            VkSemaphore lastComputeSignal = VK_NULL_HANDLE;
+            Clock::time_point start = Clock::now();
+            
+            for (uint32_t i = 0; i < settings.benchmarkFrames && !windowShouldClose(); i++)
+            {
+                pollEvents();
+                
+                if (graphics)
+                {
+                    // Graphics reads what compute produced a frame earlier, which is what lets the two run side by side
+                    if (computeSemaphore == VK_NULL_HANDLE)
+                        computeSemaphore = lastComputeSignal;
+                    
+                    lastComputeSignal = VK_NULL_HANDLE;
+                    drawFrame();
+                }
+                
+                // A frame that bailed out early still holds the last semaphore, so compute waits a frame rather than signal it twice
+                if (compute && computeSemaphore == VK_NULL_HANDLE)
+                    lastComputeSignal = dispatchOverlapWorkload(i % framesInFlight, graphics);
+            }
+            
+            for (VkSemaphore semaphore : {lastComputeSignal, computeSemaphore})
+                if (semaphore != VK_NULL_HANDLE)
+                    consumeSemaphore(semaphore);
+            
+            computeSemaphore = VK_NULL_HANDLE;
+            
+            vkDeviceWaitIdle(device);
+            
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / std::max(settings.benchmarkFrames, 1u);
+        };
+        
+        double graphicsTime = runPhase(true, false);
+        double computeTime = runPhase(false, true);
+        double combinedTime = runPhase(true, true);
+        
+        double overlap = std::clamp((graphicsTime + computeTime - combinedTime) / std::min(graphicsTime, computeTime), 0.0, 1.0);
+        
+        printf("Graphics only: %.3f ms/frame\n", graphicsTime);
+        printf("Compute only: %.3f ms/frame\n", computeTime);
+        printf("Graphics + compute: %.3f ms/frame | overlap %.0f%%\n", combinedTime, overlap * 100.0);
+    }
+    
+    void runPipelineCompilationBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const VkColorComponentFlags rgba = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        const VkColorComponentFlags rgb = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT;
+        
+        // Every combination is a distinct pipeline, so nothing is shared between them but the shaders
+        std::vector<GraphicsPipelineDescription> variants;
+        
+        for (VkPrimitiveTopology topology : {VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP, VK_PRIMITIVE_TOPOLOGY_LINE_LIST})
+            for (VkCullModeFlags cullMode : {VK_CULL_MODE_NONE, VK_CULL_MODE_BACK_BIT})
+                for (VkFrontFace frontFace : {VK_FRONT_FACE_CLOCKWISE, VK_FRONT_FACE_COUNTER_CLOCKWISE})
+                    for (bool blendEnable : {false, true})
+                        for (VkColorComponentFlags writeMask : {rgba, rgb})
+                        {
+                            GraphicsPipelineDescription description = describeGraphicsPipeline();
+                            description.topology = topology;
+                            description.cullMode = cullMode;
+                            description.frontFace = frontFace;
+                            description.blendEnable = blendEnable;
+                            description.colorWriteMask = writeMask;
+                            
+                            variants.push_back(description);
+                        }
+        
+        uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        
+        printf("Pipeline compilation benchmark, %zu variants, empty pipeline cache per round\n", variants.size());
+        
+        double serialTime = 0.0;
+        
+        for (uint32_t threads = 1; threads <= maxThreads; threads = (threads * 2 > maxThreads && threads != maxThreads) ? maxThreads : threads * 2)
+        {
+            ThreadPool threadPool(threads);
+            
+            // A fresh cache per round, otherwise every round after the first only measures cache hits
+            VkPipelineCacheCreateInfo cacheInfo {};
+            cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            
+            VkPipelineCache cache;
+            
+            if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create pipeline cache!");
+            
+            PipelineCompiler compiler;
+            compiler.create(device, cache, &threadPool);
+            
+            Clock::time_point start = Clock::now();
+            
+            std::vector<std::future<VkPipeline>> futures = compiler.compile(variants);
+            std::vector<VkPipeline> pipelines;
+            
+            for (auto &future : futures)
+                pipelines.push_back(future.get());
+            
+            double compileTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            
+            for (auto pipeline : pipelines)
+                vkDestroyPipeline(device, pipeline, nullptr);
+            
+            vkDestroyPipelineCache(device, cache, nullptr);
+            
+            if (threads == 1)
+                serialTime = compileTime;
+            
+            printf("Threads: %u | %.2f ms | speedup %.2fx\n", threads, compileTime, serialTime / compileTime);
+        }
+        
+        // Materials usually differ in textures and constants only, so most of them ask for a pipeline that already exists
+        std::vector<GraphicsPipelineDescription> materials;
+        
+        for (uint32_t i = 0; i < MATERIALS_PER_PIPELINE; i++)
+            materials.insert(materials.end(), variants.begin(), variants.end());
+        
+        auto runMaterials = [&](bool useRegistry)
+        {
+            VkPipelineCacheCreateInfo cacheInfo {};
+            cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            
+            VkPipelineCache cache;
+            
+            if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &cache) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create pipeline cache!");
+            
+            PipelineCompiler compiler;
+            compiler.create(device, cache, &recordingThreads);
+            
+            PipelineRegistry registry;
+            registry.create(device, &compiler);
+            
+            Clock::time_point start = Clock::now();
+            std::vector<VkPipeline> pipelines;
+            
+            if (useRegistry)
+            {
+                std::vector<std::shared_future<VkPipeline>> futures;
+                
+                for (const auto &material : materials)
+                    futures.push_back(registry.getPipeline(material));
+                
+                for (auto &future : futures)
+                    future.get();
+            }
+            else
+            {
+                for (auto &future : compiler.compile(materials))
+                    pipelines.push_back(future.get());
+            }
+            
+            double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            uint32_t compiled = useRegistry ? registry.getStats().pipelinesCompiled : static_cast<uint32_t>(pipelines.size());
+            
+            for (auto pipeline : pipelines)
+                vkDestroyPipeline(device, pipeline, nullptr);
+            
+            registry.destroy();
+            vkDestroyPipelineCache(device, cache, nullptr);
+            
+            printf("%s: %zu requests | %u pipelines built | %.2f ms\n", useRegistry ? "Registry" : "No registry", materials.size(), compiled, time);
+        };
+        
+        runMaterials(false);
+        runMaterials(true);
+    }
+    
+    void runBindlessBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const uint32_t warmupFrames = 30;
+        
+        VkPhysicalDeviceFeatures features;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+        
+        if (!features.shaderStorageBufferArrayDynamicIndexing)
+            throw std::runtime_error("Bindless benchmark needs shaderStorageBufferArrayDynamicIndexing!");
+        
+        uint32_t bufferCount = std::min(BINDLESS_BENCHMARK_BUFFERS, bindlessTable.getCapacity(BindlessResourceType::StorageBuffer));
+        
+        printf("Bindless benchmark, %u draws over %u storage buffers, %u frames per path, %s table\n", settings.drawCount, bufferCount, settings.benchmarkFrames, bindlessTable.isBindless() ? "descriptor indexing" : "fallback");
+        
+        // Small offsets so every triangle stays on screen
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> offset(-0.4f, 0.4f);
+        
+        for (uint32_t i = 0; i < bufferCount; i++)
+        {
+            float drawData[4] = {offset(random), offset(random), 0.0f, 0.0f};
+            
+            DeviceBuffer buffer = bufferManager.createDeviceBuffer(sizeof(drawData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+            bufferManager.upload(buffer, 0, drawData, sizeof(drawData));
+            
+            drawDataBuffers.push_back(buffer);
+            drawDataHandles.push_back(bindlessTable.addStorageBuffer(buffer.buffer, 0, buffer.size));
+        }
+        
+        bufferManager.flush();
+        bufferManager.waitIdle();
+        
+        bindlessTable.setDefaultStorageBuffer(drawDataBuffers[0].buffer, drawDataBuffers[0].size);
+        
+        VkDescriptorSetLayoutBinding drawDataBinding {};
+        drawDataBinding.binding = 0;
+        drawDataBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        drawDataBinding.descriptorCount = 1;
+        drawDataBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        
+        VkDescriptorSetLayoutCreateInfo layoutInfo {};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 1;
+        layoutInfo.pBindings = &drawDataBinding;
+        
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &classicSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout!");
+        
+        PipelineLayoutDescription bindlessLayout;
+        bindlessLayout.setLayouts = {bindlessTable.getSetLayout()};
+        bindlessLayout.pushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t)}};
+        
+        PipelineLayoutDescription classicLayout;
+        classicLayout.setLayouts = {classicSetLayout};
+        
+        // One shader for both table modes, the array is sized by a specialization constant
+        GraphicsPipelineDescription bindlessDescription = describeGraphicsPipeline();
+        bindlessDescription.vertexShader = shaderLibrary.load("Shaders/bindless.spv");
+        bindlessDescription.specializationConstants = {bindlessTable.getCapacity(BindlessResourceType::StorageBuffer)};
+        bindlessDescription.layout = pipelineRegistry.getPipelineLayout(bindlessLayout);
+        
+        GraphicsPipelineDescription classicDescription = describeGraphicsPipeline();
+        classicDescription.vertexShader = shaderLibrary.load("Shaders/classic.spv");
+        classicDescription.layout = pipelineRegistry.getPipelineLayout(classicLayout);
+        
+        std::shared_future<VkPipeline> bindlessPipeline = pipelineRegistry.getPipeline(bindlessDescription);
+        std::shared_future<VkPipeline> classicPipeline = pipelineRegistry.getPipeline(classicDescription);
+        
+        auto runPath = [&](DrawPath path, const GraphicsPipelineDescription &description, VkPipeline pipeline)
+        {
+            vkDeviceWaitIdle(device);
+            
+            drawPath = path;
+            drawPathPipeline = pipeline;
+            drawPathLayout = description.layout;
+            
+            for (uint32_t i = 0; i < warmupFrames && !windowShouldClose(); i++)
+            {
+                pollEvents();
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            profiler.reset();
+            descriptorAllocator.resetStats();
+            
+            Clock::time_point start = Clock::now();
+            uint32_t frames = 0;
+            
+            for (; frames < settings.benchmarkFrames && !windowShouldClose(); frames++)
+            {
+                pollEvents();
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            double drawsPerSecond = seconds > 0.0 ? static_cast<double>(settings.drawCount) * frames / seconds : 0.0;
+            double recordTime = profiler.getScopeStats("record", ProfileTimeline::Cpu).average;
+            
+            printf("%s: %.2f M draws/s | record %.3f ms per frame\n", path == DrawPath::Bindless ? "Bindless" : "Classic", drawsPerSecond / 1000000.0, recordTime);
+            
+            DescriptorAllocatorStats allocatorStats = descriptorAllocator.getStats();
+            
+            if (allocatorStats.setsAllocated > 0)
+                printf("    %llu sets allocated | %u pools created | up to %u pools per frame\n", static_cast<unsigned long long>(allocatorStats.setsAllocated), allocatorStats.poolsCreated, allocatorStats.peakFramePools);
+            
+            return drawsPerSecond;
+        };
+        
+        double classicRate = runPath(DrawPath::Classic, classicDescription, classicPipeline.get());
+        double bindlessRate = runPath(DrawPath::Bindless, bindlessDescription, bindlessPipeline.get());
+        
+        printf("Bindless speedup %.2fx\n", classicRate > 0.0 ? bindlessRate / classicRate : 0.0);
+        
+        drawPath = DrawPath::Default;
+        
+        for (size_t i = 0; i < drawDataBuffers.size(); i++)
+        {
+            bindlessTable.remove(BindlessResourceType::StorageBuffer, drawDataHandles[i]);
+            bufferManager.destroyBuffer(drawDataBuffers[i]);
+        }
+        
+        drawDataBuffers.clear();
+        drawDataHandles.clear();
+    }
+    
+    void runCullingBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const uint32_t warmupFrames = 30;
+        
+        // Only the sphere matters for culling, the triangle of every object is scaled to fill it
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> position(-CULLING_FIELD_SCREENS, CULLING_FIELD_SCREENS);
+        
+        cullObjects.resize(settings.drawCount);
+        sceneObjects.clear();
+        sceneObjects.reserve(settings.drawCount);
+        
+        for (uint32_t i = 0; i < settings.drawCount; i++)
+        {
+            cullObjects[i] = {{position(random), position(random), 0.0f}, CULLING_OBJECT_RADIUS, static_cast<uint32_t>(triangleIndices.size()), 0, 0, i % MATERIAL_COUNT};
+            sceneObjects.add(cullObjects[i].center, cullObjects[i].radius);
+        }
+        
+        gpuCuller.create(device, &bufferManager, indirectDraws, shaderLibrary.load("Shaders/cull.spv"), pipelineCache.getHandle(), MAX_FRAMES_IN_FLIGHT, cullObjects);
+        
+        const char* indirectMode = gpuCuller.isCompacting() ? "draw count from the GPU" : (indirectDraws.multiDrawIndirect ? "multi draw indirect" : "one indirect draw per object");
+        printf("Culling benchmark, %u objects, %u frames per path, %s, %s CPU kernel\n", settings.drawCount, settings.benchmarkFrames, indirectMode, getCullingKernelName(cullingKernel));
+        
+        PipelineLayoutDescription culledLayout;
+        culledLayout.setLayouts = {gpuCuller.getObjectSetLayout()};
+        culledLayout.pushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(cullingViewProjection)}};
+        
+        // Both paths draw with the same pipeline, only where the draws come from differs
+        GraphicsPipelineDescription description = describeGraphicsPipeline();
+        description.vertexShader = shaderLibrary.load("Shaders/culled.spv");
+        description.layout = pipelineRegistry.getPipelineLayout(culledLayout);
+        
+        VkPipeline pipeline = pipelineRegistry.getPipeline(description).get();
+        
+        auto runPath = [&](DrawPath path)
+        {
+            vkDeviceWaitIdle(device);
+            
+            drawPath = path;
+            drawPathPipeline = pipeline;
+            drawPathLayout = description.layout;
+            
+            uint32_t frames = 0;
+            
+            for (uint32_t i = 0; i < warmupFrames && !windowShouldClose(); i++)
+            {
+                pollEvents();
+                setCullingCamera(frames++);
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            profiler.reset();
+            
+            Clock::time_point start = Clock::now();
+            uint32_t measuredFrames = 0;
+            
+            for (; measuredFrames < settings.benchmarkFrames && !windowShouldClose(); measuredFrames++)
+            {
+                pollEvents();
+                setCullingCamera(frames++);
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            
+            double frameTime = measuredFrames > 0 ? std::chrono::duration<double, std::milli>(Clock::now() - start).count() / measuredFrames : 0.0;
+            double recordTime = profiler.getScopeStats("record", ProfileTimeline::Cpu).average;
+            double gpuTime = profiler.getScopeStats("frame", ProfileTimeline::Gpu).average;
+            
+            printf("%s: %.3f ms per frame | record %.3f ms | GPU %.3f ms", path == DrawPath::GpuCulled ? "GPU culled, indirect" : "CPU culled, direct", frameTime, recordTime, gpuTime);
+            
+            if (path == DrawPath::GpuCulled)
+                printf(" | cull pass %.3f ms", profiler.getScopeStats("cull", ProfileTimeline::Gpu).average);
+            else
+                printf(" | cull %.3f ms", profiler.getScopeStats("cull", ProfileTimeline::Cpu).average);
+            
+            printf("\n");
+            
+            return frameTime;
+        };
+        
+        setCullingCamera(0);
+        cullSpheresParallel(recordingThreads, cullingKernel, cullingFrustum, sceneObjects, visibleObjects);
+        
+        printf("About %zu objects visible per frame\n", visibleObjects.size());
+        
+        double cpuCulledTime = runPath(DrawPath::CpuCulled);
+        double gpuCulledTime = runPath(DrawPath::GpuCulled);
+        
+        printf("GPU culling speedup %.2fx\n", gpuCulledTime > 0.0 ? cpuCulledTime / gpuCulledTime : 0.0);
+        
+        drawPath = DrawPath::Default;
+    }
+    
+    void runInstancingBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const uint32_t warmupFrames = 10;
+        
+        uint32_t maxInstances = *std::max_element(std::begin(INSTANCING_BENCHMARK_COUNTS), std::end(INSTANCING_BENCHMARK_COUNTS));
+        instanceBatcher.create(device, &memoryAllocator, MAX_FRAMES_IN_FLIGHT, sizeof(InstanceData), maxInstances);
+        
+        printf("Instancing benchmark, %zu meshes, %u materials, %u frames per run\n", meshRanges.size(), MATERIAL_COUNT, settings.benchmarkFrames);
+        
+        PipelineLayoutDescription layoutDescription;
+        layoutDescription.pushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants)}};
+        
+        // Both paths use this pipeline, they only differ in how many instances each draw covers
+        GraphicsPipelineDescription description = describeGraphicsPipeline();
+        description.vertexShader = shaderLibrary.load("Shaders/instanced.spv");
+        description.vertexBindings.push_back(InstanceData::getBindingDescription());
+        description.vertexAttributes.push_back(InstanceData::getAttributeDescription());
+        description.layout = pipelineRegistry.getPipelineLayout(layoutDescription);
+        
+        drawPathPipeline = pipelineRegistry.getPipeline(description).get();
+        drawPathLayout = description.layout;
+        
+        for (uint32_t instances : INSTANCING_BENCHMARK_COUNTS)
+        {
+            sceneInstances = instances;
+            
+            for (DrawPath path : {DrawPath::Unbatched, DrawPath::Instanced})
+            {
+                vkDeviceWaitIdle(device);
+                drawPath = path;
+                
+                for (uint32_t i = 0; i < warmupFrames && !windowShouldClose(); i++)
+                {
+                    pollEvents();
+                    drawFrame();
+                }
+                
+                vkDeviceWaitIdle(device);
+                profiler.reset();
+                
+                Clock::time_point start = Clock::now();
+                uint32_t frames = 0;
+                
+                for (; frames < settings.benchmarkFrames && !windowShouldClose(); frames++)
+                {
+                    pollEvents();
+                    drawFrame();
+                }
+                
+                vkDeviceWaitIdle(device);
+                
+                double frameTime = frames > 0 ? std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames : 0.0;
+                double recordTime = profiler.getScopeStats("record", ProfileTimeline::Cpu).average;
+                double gpuTime = profiler.getScopeStats("frame", ProfileTimeline::Gpu).average;
+                
+                size_t drawCalls = path == DrawPath::Instanced ? instanceBatcher.getBatches().size() : instanceBatcher.getInstanceCount();
+                
+                printf("%u instances, %s: %zu draw calls | %.3f ms per frame | record %.3f ms | GPU %.3f ms\n", instances, path == DrawPath::Instanced ? "instanced" : "unbatched", drawCalls, frameTime, recordTime, gpuTime);
+            }
+        }
+        
+        drawPath = DrawPath::Default;
+    }
+    
+    void runDepthBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const uint32_t warmupFrames = 10;
+        
+        // The same quads every run, only their order and the depth setup change
+        std::mt19937 random(11);
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 1.0f);
+        std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+        
+        std::vector<LayerConstants> layers(DEPTH_BENCHMARK_LAYERS);
+        
+        for (auto &layer : layers)
+            layer = {{position(random), position(random)}, scale(random), depth(random)};
+        
+        VkPhysicalDeviceFeatures features;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+        
+        // The main pass is recorded into secondaries, which can only be counted when they inherit the query
+        if (features.pipelineStatisticsQuery && features.inheritedQueries)
+        {
+            VkQueryPoolCreateInfo queryPoolInfo {};
+            queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            queryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT;
+            queryPoolInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+            
+            if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &statisticsQueryPool) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create pipeline statistics query pool!");
+        }
+        
+        printf("Depth benchmark, %u layers at %ux%u, %u shading iterations, %s depth, %u frames per run\n", DEPTH_BENCHMARK_LAYERS, swapChainExtent.width, swapChainExtent.height, DEPTH_BENCHMARK_SHADE_ITERATIONS, depthFormat == VK_FORMAT_D32_SFLOAT || depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT ? "32-bit" : (depthFormat == VK_FORMAT_D16_UNORM ? "16-bit" : "24-bit"), settings.benchmarkFrames);
+        
+        PipelineLayoutDescription layoutDescription;
+        layoutDescription.pushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(LayerConstants)}};
+        
+        GraphicsPipelineDescription description = describeGraphicsPipeline();
+        description.vertexShader = shaderLibrary.load("Shaders/layered.spv");
+        description.fragmentShader = shaderLibrary.load("Shaders/shaded.spv");
+        description.specializationConstants = {DEPTH_BENCHMARK_SHADE_ITERATIONS};
+        description.layout = pipelineRegistry.getPipelineLayout(layoutDescription);
+        
+        drawPathLayout = description.layout;
+        
+        enum class LayerOrder
+        {
+            BackToFront,
+            Unsorted,
+            FrontToBack
+        };
+        
+        struct DepthRun
+        {
+            const char* name;
+            bool depthTest;
+            bool prepass;
+            LayerOrder order;
+        };
+        
+        // Without a depth test the layers have to be drawn back to front to look right, which is the worst case for it
+        const DepthRun runs[] = {
+            {"No depth test, back to front", false, false, LayerOrder::BackToFront},
+            {"Depth test, unsorted", true, false, LayerOrder::Unsorted},
+            {"Depth test, front to back", true, false, LayerOrder::FrontToBack},
+            {"Depth pre-pass, unsorted", true, true, LayerOrder::Unsorted}
+        };
+        
+        double gpuTimes[std::size(runs)] {};
+        double pixels = static_cast<double>(swapChainExtent.width) * swapChainExtent.height;
+        
+        drawPath = DrawPath::Layered;
+        
+        for (size_t i = 0; i < std::size(runs); i++)
+        {
+            const DepthRun &run = runs[i];
+            
+            vkDeviceWaitIdle(device);
+            
+            sceneLayers = layers;
+            
+            if (run.order != LayerOrder::Unsorted)
+            {
+                bool frontToBack = run.order == LayerOrder::FrontToBack;
+                
+                std::sort(sceneLayers.begin(), sceneLayers.end(), [frontToBack](const LayerConstants &a, const LayerConstants &b)
+                {
+                    return frontToBack ? a.depth < b.depth : a.depth > b.depth;
+                });
+            }
+            
+            GraphicsPipelineDescription runDescription = description;
+            runDescription.depthTestEnable = run.depthTest;
+            runDescription.depthWriteEnable = run.depthTest && !run.prepass;
+            runDescription.depthCompareOp = run.prepass ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS;
+            
+            drawPathPipeline = pipelineRegistry.getPipeline(runDescription).get();
+            layerPrepassPipeline = run.prepass ? pipelineRegistry.getPipeline(getDepthPrepassDescription(description)).get() : VK_NULL_HANDLE;
+            
+            for (uint32_t frame = 0; frame < warmupFrames && !windowShouldClose(); frame++)
+            {
+                pollEvents();
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            profiler.reset();
+            
+            Clock::time_point start = Clock::now();
+            uint32_t frames = 0;
+            
+            for (; frames < settings.benchmarkFrames && !windowShouldClose(); frames++)
+            {
+                pollEvents();
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            
+            double frameTime = frames > 0 ? std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames : 0.0;
+            gpuTimes[i] = profiler.getScopeStats("main pass", ProfileTimeline::Gpu).average;
+            
+            printf("%s: %.3f ms per frame | main pass GPU %.3f ms", run.name, frameTime, gpuTimes[i]);
+            
+            // Every slot ran the same scene, so any of them holds a full frame's count
+            uint64_t invocations = 0;
+            
+            if (statisticsQueryPool != VK_NULL_HANDLE && vkGetQueryPoolResults(device, statisticsQueryPool, 0, 1, sizeof(invocations), &invocations, sizeof(invocations), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+                printf(" | %.2f fragments shaded per pixel", invocations / pixels);
+            
+            printf("\n");
+        }
+        
+        printf("Against no depth test: unsorted %.2fx | front to back %.2fx | pre-pass %.2fx\n", gpuTimes[1] > 0.0 ? gpuTimes[0] / gpuTimes[1] : 0.0, gpuTimes[2] > 0.0 ? gpuTimes[0] / gpuTimes[2] : 0.0, gpuTimes[3] > 0.0 ? gpuTimes[0] / gpuTimes[3] : 0.0);
+        
+        drawPath = DrawPath::Default;
+        layerPrepassPipeline = VK_NULL_HANDLE;
+        sceneLayers.clear();
+        
+        if (statisticsQueryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(device, statisticsQueryPool, nullptr);
+            statisticsQueryPool = VK_NULL_HANDLE;
+        }
+    }
+    
+    // Both runs draw the same layers through the G-buffer subpass, once with depth and albedo written out to memory at the
+    // end of the pass and once with them discarded. The difference is what the intermediates cost in bandwidth
+    void runTransientAttachmentBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        const uint32_t warmupFrames = 10;
+        
+        std::mt19937 random(13);
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> scale(0.5f, 1.0f);
+        std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+        
+        sceneLayers.resize(TRANSIENT_BENCHMARK_LAYERS);
+        
+        for (auto &layer : sceneLayers)
+            layer = {{position(random), position(random)}, scale(random), depth(random)};
+        
+        PipelineLayoutDescription layoutDescription;
+        layoutDescription.pushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(LayerConstants)}};
+        
+        GraphicsPipelineDescription description = describeGraphicsPipeline();
+        description.vertexShader = shaderLibrary.load("Shaders/layered.spv");
+        description.fragmentShader = shaderLibrary.load("Shaders/shaded.spv");
+        description.specializationConstants = {0};
+        description.depthCompareOp = VK_COMPARE_OP_LESS;
+        description.layout = pipelineRegistry.getPipelineLayout(layoutDescription);
+        
+        drawPath = DrawPath::Layered;
+        drawPathLayout = description.layout;
+        drawPathPipeline = pipelineRegistry.getPipeline(description).get();
+        
+        printf("Transient attachment benchmark, %u layers at %ux%u through a G-buffer subpass, %u frames per run\n", TRANSIENT_BENCHMARK_LAYERS, swapChainExtent.width, swapChainExtent.height, settings.benchmarkFrames);
+        
+        double gpuTimes[2] {};
+        
+        for (uint32_t run = 0; run < 2; run++)
+        {
+            setStoreIntermediates(run == 0);
+            
+            for (uint32_t frame = 0; frame < warmupFrames && !windowShouldClose(); frame++)
+            {
+                pollEvents();
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            profiler.reset();
+            
+            Clock::time_point start = Clock::now();
+            uint32_t frames = 0;
+            
+            for (; frames < settings.benchmarkFrames && !windowShouldClose(); frames++)
+            {
+                pollEvents();
+                drawFrame();
+            }
+            
+            vkDeviceWaitIdle(device);
+            
+            double frameTime = frames > 0 ? std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames : 0.0;
+            gpuTimes[run] = profiler.getScopeStats("main pass", ProfileTimeline::Gpu).average;
+            
+            double intermediateMegabytes = (depthImage.allocation.size + albedoImage.allocation.size) / (1024.0 * 1024.0);
+            
+            printf("%s: %.3f ms per frame | main pass GPU %.3f ms | %.2f MB of intermediates %s per frame", storeIntermediates ? "Stored" : "Transient", frameTime, gpuTimes[run], intermediateMegabytes, storeIntermediates ? "written" : "discarded");
+            
+            // Lazily allocated memory only grows by what the tiles spilled, ideally nothing
+            if (depthImage.lazilyAllocated && albedoImage.lazilyAllocated)
+            {
+                VkDeviceSize depthCommitted = 0;
+                VkDeviceSize albedoCommitted = 0;
+                
+                vkGetDeviceMemoryCommitment(device, depthImage.allocation.memory, &depthCommitted);
+                vkGetDeviceMemoryCommitment(device, albedoImage.allocation.memory, &albedoCommitted);
+                
+                printf(" | lazily allocated, %.2f MB committed", (depthCommitted + albedoCommitted) / (1024.0 * 1024.0));
+            }
+            else if (!storeIntermediates)
+                printf(" | no lazily allocated memory");
+            
+            printf("\n");
+        }
+        
+        printf("Transient against stored: %.2fx main pass GPU time\n", gpuTimes[0] > 0.0 ? gpuTimes[1] / gpuTimes[0] : 0.0);
+        
+        setStoreIntermediates(false);
+        
+        drawPath = DrawPath::Default;
+        sceneLayers.clear();
+    }
+    
+    // A deferred frame with shadows, bloom and a debug overlay nothing reads, never executed. Times building and
+    // compiling it, then prints its schedule along with how much memory aliasing saved
+    void runRenderGraphBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        
+        VkExtent2D extent = swapChainExtent;
+        VkExtent2D halfExtent = {std::max(1u, extent.width / 2), std::max(1u, extent.height / 2)};
+        
+        // D16 is the one depth format every device can also sample
+        const VkFormat depthSampleFormat = VK_FORMAT_D16_UNORM;
+        const VkFormat hdrFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+        
+        RenderGraph graph;
+        graph.create(device, &memoryAllocator);
+        
+        auto build = [&]()
+        {
+            graph.reset();
+            
+            uint32_t shadow = graph.createImage("shadow map", depthSampleFormat, {2048, 2048});
+            uint32_t albedo = graph.createImage("albedo", VK_FORMAT_R8G8B8A8_UNORM, extent);
+            uint32_t normal = graph.createImage("normal", hdrFormat, extent);
+            uint32_t depth = graph.createImage("depth", depthSampleFormat, extent);
+            uint32_t hdr = graph.createImage("hdr", hdrFormat, extent);
+            uint32_t bloomHalf = graph.createImage("bloom half", hdrFormat, halfExtent);
+            uint32_t bloom = graph.createImage("bloom", hdrFormat, extent);
+            uint32_t debug = graph.createImage("debug", VK_FORMAT_R8G8B8A8_UNORM, extent);
+            
+            uint32_t output = graph.importImage("output", swapChainImageFormat, {});
+            graph.setOutput(output, ResourceUse::TransferSource);
+            
+            uint32_t shadowPass = graph.addPass("shadow", PassType::Graphics, nullptr);
+            graph.write(shadowPass, shadow, ResourceUse::DepthAttachment);
+            
+            uint32_t gbufferPass = graph.addPass("gbuffer", PassType::Graphics, nullptr);
+            graph.write(gbufferPass, albedo, ResourceUse::ColorAttachment);
+            graph.write(gbufferPass, normal, ResourceUse::ColorAttachment);
+            graph.write(gbufferPass, depth, ResourceUse::DepthAttachment);
+            
+            uint32_t lightingPass = graph.addPass("lighting", PassType::Compute, nullptr);
+            graph.read(lightingPass, albedo, ResourceUse::SampledRead);
+            graph.read(lightingPass, normal, ResourceUse::SampledRead);
+            graph.read(lightingPass, depth, ResourceUse::SampledRead);
+            graph.read(lightingPass, shadow, ResourceUse::SampledRead);
+            graph.write(lightingPass, hdr, ResourceUse::StorageWrite);
+            
+            uint32_t downsamplePass = graph.addPass("bloom downsample", PassType::Compute, nullptr);
+            graph.read(downsamplePass, hdr, ResourceUse::SampledRead);
+            graph.write(downsamplePass, bloomHalf, ResourceUse::StorageWrite);
+            
+            uint32_t upsamplePass = graph.addPass("bloom upsample", PassType::Compute, nullptr);
+            graph.read(upsamplePass, bloomHalf, ResourceUse::SampledRead);
+            graph.write(upsamplePass, bloom, ResourceUse::StorageWrite);
+            
+            uint32_t debugPass = graph.addPass("debug overlay", PassType::Graphics, nullptr);
+            graph.read(debugPass, depth, ResourceUse::SampledRead);
+            graph.write(debugPass, debug, ResourceUse::ColorAttachment);
+            
+            uint32_t tonemapPass = graph.addPass("tonemap", PassType::Graphics, nullptr);
+            graph.read(tonemapPass, hdr, ResourceUse::SampledRead);
+            graph.read(tonemapPass, bloom, ResourceUse::SampledRead);
+            graph.write(tonemapPass, output, ResourceUse::ColorAttachment);
+            
+            graph.compile();
+        };
+        
+        Clock::time_point start = Clock::now();
+        
+        for (uint32_t i = 0; i < RENDER_GRAPH_BENCHMARK_BUILDS; i++)
+            build();
+        
+        double buildTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / RENDER_GRAPH_BENCHMARK_BUILDS;
+        const RenderGraphStats &stats = graph.getStats();
+        
+        printf("Render graph benchmark at %ux%u, %u builds\n", extent.width, extent.height, RENDER_GRAPH_BENCHMARK_BUILDS);
+        printf("%s", graph.dump().c_str());
+        printf("Build and compile: %.3f ms | aliasing saves %.2f MB of %.2f MB\n", buildTime, (stats.transientBytes - stats.aliasedBytes) / (1024.0 * 1024.0), stats.transientBytes / (1024.0 * 1024.0));
+        
+        graph.destroy();
+    }
+    
+    // Only the ops and memory of the intermediates change and the render pass stays compatible, so pipelines are kept
+    void setStoreIntermediates(bool store)
+    {
+        vkDeviceWaitIdle(device);
+        
+        storeIntermediates = store;
+        
+        for (auto framebuffer : swapChainFrameBuffers)
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        
+        destroyAttachmentImage(device, &memoryAllocator, depthImage);
+        destroyAttachmentImage(device, &memoryAllocator, albedoImage);
+        
+        createRenderPass();
+        createAttachmentImages();
+        createFrameBuffers();
+    }
+    
+    // A grid that fills the screen, swaying a little every frame so the whole instance buffer really is rewritten
+    void writeSceneInstances()
+    {
+        instanceBatcher.beginFrame(static_cast<uint32_t>(currentFrame));
+        
+        uint32_t columns = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(sceneInstances)))));
+        float spacing = 2.0f / columns;
+        float time = submittedFrames * 0.05f;
+        
+        for (uint32_t i = 0; i < sceneInstances; i++)
+        {
+            uint32_t column = i % columns;
+            uint32_t row = i / columns;
+            
+            InstanceData instance;
+            instance.offset[0] = -1.0f + spacing * (column + 0.5f + 0.25f * std::sin(time + row));
+            instance.offset[1] = -1.0f + spacing * (row + 0.5f);
+            instance.scale = 0.8f * spacing;
+            
+            // Rows alternate meshes and every 16 columns switch material, so the pairs arrive interleaved
+            instanceBatcher.add(row % meshRanges.size(), (column / 16) % MATERIAL_COUNT, &instance);
+        }
+        
+        instanceBatcher.build();
+    }
+    
+    // Orthographic camera one screen across, circling the middle of the culling field
+    void setCullingCamera(uint32_t frame)
+    {
+        float angle = frame * 0.01f;
+        float x = 0.5f * CULLING_FIELD_SCREENS * std::cos(angle);
+        float y = 0.5f * CULLING_FIELD_SCREENS * std::sin(angle);
+        
+        // Column major, depth maps -1..1 to Vulkan's 0..1
+        float matrix[16] = {
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 0.5f, 0.0f,
+            -x, -y, 0.5f, 1.0f
+        };
+        
+        memcpy(cullingViewProjection, matrix, sizeof(matrix));
+        cullingFrustum = extractFrustum(cullingViewProjection);
+    }
+    
+    void runShaderLoadingBenchmark()
+    {
+        using Clock = std::chrono::steady_clock;
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "VulkanProjectShaders";
+        std::filesystem::create_directories(directory);
+        
+        MappedFile source("Shaders/vert.spv");
+        validateSpirv(source.data(), source.size(), "Shaders/vert.spv");
+        
+        // Tools are free to put anything in the generator word of the header, so patching it gives distinct but valid blobs
+        std::vector<std::string> paths;
+        
+        for (uint32_t i = 0; i < SHADER_BENCHMARK_COUNT; i++)
+        {
+            std::vector<char> blob(source.data(), source.data() + source.size());
+            uint32_t generator = i % (SHADER_BENCHMARK_COUNT / 2);
+            memcpy(blob.data() + 2 * sizeof(uint32_t), &generator, sizeof(generator));
+            
+            paths.push_back((directory / ("shader" + std::to_string(i) + ".spv")).string());
+            std::ofstream(paths.back(), std::ios::binary).write(blob.data(), blob.size());
+        }
+        
+        printf("Shader loading benchmark, %u files with %u distinct blobs\n", SHADER_BENCHMARK_COUNT, SHADER_BENCHMARK_COUNT / 2);
+        
+        // What every pipeline used to do: read the whole file into a vector and build a module from it
+        Clock::time_point start = Clock::now();
+        std::vector<VkShaderModule> modules;
+        
+        for (const auto &path : paths)
+        {
+            std::ifstream file(path, std::ios::ate | std::ios::binary);
+            std::vector<char> code(static_cast<size_t>(file.tellg()));
+            
+            file.seekg(0);
+            file.read(code.data(), code.size());
+            
+            VkShaderModuleCreateInfo createInfo {};
+            createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            createInfo.codeSize = code.size();
+            createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+            
+            modules.emplace_back();
+            
+            if (vkCreateShaderModule(device, &createInfo, nullptr, &modules.back()) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create shader module!");
+        }
+        
+        double readTime = Milliseconds(Clock::now() - start).count();
+        
+        for (auto module : modules)
+            vkDestroyShaderModule(device, module, nullptr);
+        
+        ShaderLibrary library;
+        library.create(device);
+        
+        start = Clock::now();
+        
+        for (const auto &path : paths)
+            library.load(path);
+        
+        double libraryTime = Milliseconds(Clock::now() - start).count();
+        const ShaderLibraryStats &stats = library.getStats();
+        
+        printf("ifstream + vector: %.3f ms | %u modules\n", readTime, SHADER_BENCHMARK_COUNT);
+        printf("mmap + dedup: %.3f ms | %u modules, %u cached loads, %llu bytes mapped\n", libraryTime, stats.modulesCreated, stats.cachedLoads, static_cast<unsigned long long>(stats.bytesMapped));
+        
+        library.destroy();
+        
+        std::filesystem::remove_all(directory);
+    }
+    
+    void createCommandRecorder()
+    {
+        QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+        
+        commandRecorder.create(device, queueFamilyIndices.graphicsFamily.value(), framesInFlight, &recordingThreads);
+    }
+        
+    VkCommandBuffer recordCommandBuffer(uint32_t imageIndex)
+    {
+        VkCommandBuffer commandBuffer = commandRecorder.beginFrame(static_cast<uint32_t>(currentFrame));
+        frameUniforms.beginFrame(static_cast<uint32_t>(currentFrame));
+        
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = nullptr;
+        
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+            throw std::runtime_error("Failed to being recording command buffers!");
+        
+        profiler.beginCommands(commandBuffer, static_cast<uint32_t>(currentFrame));
+        profiler.beginScope(commandBuffer, "frame");
+        
+        if (frameGraphDirty || frameGraphCulling != (drawPath == DrawPath::GpuCulled))
+            buildFrameGraph();
+        
+        // The graph stays compiled, only the images and buffers of this frame change
+        recordingImage = imageIndex;
+        frameGraph.setImage(frameGraphSwapchain, swapChainImages[imageIndex]);
+        frameGraph.setImage(frameGraphDepth, depthImage.image);
+        
+        if (settings.gbufferPass)
+            frameGraph.setImage(frameGraphAlbedo, albedoImage.image);
+        
+        if (frameGraphCulling)
+        {
+            frameGraph.setBuffer(frameGraphCommands, gpuCuller.getCommandBuffer(static_cast<uint32_t>(currentFrame)).buffer);
+            
+            if (gpuCuller.isCompacting())
+                frameGraph.setBuffer(frameGraphCounts, gpuCuller.getCountBuffer(static_cast<uint32_t>(currentFrame)).buffer);
+        }
+        
+        frameGraph.execute(commandBuffer);
+        
+        profiler.endScope(commandBuffer);
+        
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to read command buffer!");
+        
+        return commandBuffer;
+    }
+    
+    // The passes of a frame: culling when the path culls on the GPU, then the main pass. The graph places every barrier
+    // between them and moves the swapchain image in and out of the main pass. Rebuilt when the set of passes changes
+    void buildFrameGraph()
+    {
+        frameGraph.reset();
+        
+        frameGraphCulling = drawPath == DrawPath::GpuCulled;
+        
+        // Acquire is waited on at COLOR_ATTACHMENT_OUTPUT, the transition out of UNDEFINED chains onto that wait
+        frameGraphSwapchain = frameGraph.importImage("swapchain", swapChainImageFormat, {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED});
+        frameGraph.setOutput(frameGraphSwapchain, settings.headless ? ResourceUse::TransferSource : ResourceUse::Present);
+        
+        // Shared by every frame in flight, so each frame waits for the last one's writes. Neither keeps its contents
+        frameGraphDepth = frameGraph.importImage("depth", depthFormat, {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED});
+        
+        if (settings.gbufferPass)
+            frameGraphAlbedo = frameGraph.importImage("albedo", swapChainImageFormat, {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED});
+        
+        // Compute can not run inside a render pass, so the draws of this frame are culled up front. The slot's fence has
+        // been waited on, so nothing from earlier frames still uses its buffers
+        if (frameGraphCulling)
+        {
+            frameGraphCommands = frameGraph.importBuffer("cull commands", {});
+            
+            if (gpuCuller.isCompacting())
+            {
+                frameGraphCounts = frameGraph.importBuffer("cull count", {});
+                
+                uint32_t clear = frameGraph.addPass("clear count", PassType::Transfer, [this](VkCommandBuffer commandBuffer)
+                {
+                    gpuCuller.recordClear(commandBuffer, static_cast<uint32_t>(currentFrame));
+                });
+                
+                frameGraph.write(clear, frameGraphCounts, ResourceUse::TransferDestination);
+            }
+            
+            uint32_t cull = frameGraph.addPass("cull", PassType::Compute, [this](VkCommandBuffer commandBuffer)
+            {
+                profiler.beginScope(commandBuffer, "cull");
+                gpuCuller.recordCull(commandBuffer, static_cast<uint32_t>(currentFrame), cullingFrustum);
+                profiler.endScope(commandBuffer);
+            });
+            
+            frameGraph.write(cull, frameGraphCommands, ResourceUse::StorageWrite);
+            
+            if (gpuCuller.isCompacting())
+                frameGraph.write(cull, frameGraphCounts, ResourceUse::StorageWrite);
+        }
+        
+        uint32_t mainPass = frameGraph.addPass("main pass", PassType::Graphics, [this](VkCommandBuffer commandBuffer)
         {
-            glfwPollEvents();
-            drawFrame();
+            recordMainPass(commandBuffer);
+        });
+        
+        // In the order of the subpasses of createRenderPass()
+        frameGraph.write(mainPass, frameGraphDepth, ResourceUse::DepthAttachment);
+        
+        if (settings.gbufferPass)
+        {
+            frameGraph.write(mainPass, frameGraphAlbedo, ResourceUse::ColorAttachment);
+            frameGraph.read(mainPass, frameGraphAlbedo, ResourceUse::InputAttachment);
         }
         
-        vkDeviceWaitIdle(device);
+        frameGraph.write(mainPass, frameGraphSwapchain, ResourceUse::ColorAttachment);
+        
+        if (frameGraphCulling)
+        {
+            frameGraph.read(mainPass, frameGraphCommands, ResourceUse::IndirectRead);
+            
+            if (gpuCuller.isCompacting())
+                frameGraph.read(mainPass, frameGraphCounts, ResourceUse::IndirectRead);
+        }
+        
+        frameGraph.compile();
+        frameGraphDirty = false;
+        
+        if (settings.dumpRenderGraph)
+            printf("%s", frameGraph.dump().c_str());
     }
     
-    void drawFrame()
+    void recordMainPass(VkCommandBuffer commandBuffer)
     {
-        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
-        
-        uint32_t imageIndex = 0;
-        vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphore[currentFrame], VK_NULL_HANDLE, &imageIndex);
-        
-        if (imagesInFlight[imageIndex] != VK_NULL_HANDLE)
-            vkWaitForFences(device, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        VkRenderPassBeginInfo renderPassInfo {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = swapChainFrameBuffers[recordingImage];
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = swapChainExtent;
+        
+        // Attachment order of createRenderPass(), depth clears to the far plane. Values past the last attachment are ignored
+        std::array<VkClearValue, 3> clearValues {};
+        clearValues[SWAPCHAIN_ATTACHMENT].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        clearValues[DEPTH_ATTACHMENT].depthStencil = {1.0f, 0};
+        clearValues[ALBEDO_ATTACHMENT].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+        renderPassInfo.pClearValues = clearValues.data();
+        
+        if (statisticsQueryPool != VK_NULL_HANDLE)
+        {
+            vkCmdResetQueryPool(commandBuffer, statisticsQueryPool, static_cast<uint32_t>(currentFrame), 1);
+            vkCmdBeginQuery(commandBuffer, statisticsQueryPool, static_cast<uint32_t>(currentFrame), 0);
+        }
         
-        imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+        profiler.beginScope(commandBuffer, "main pass");
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
         
-        VkSubmitInfo submitInfo {};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        VkCommandBufferInheritanceInfo inheritanceInfo {};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = swapChainFrameBuffers[recordingImage];
         
-        VkSemaphore waitSemaphores[] = {imageAvailableSemaphore[currentFrame]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+        // Secondaries executed while a statistics query is active have to declare what it counts
+        if (statisticsQueryPool != VK_NULL_HANDLE)
+            inheritanceInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
         
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffers[imageIndex];
+        // Indirect draws are a handful of commands however many objects there are, one secondary buffer records them all
+        uint32_t recordedDraws = drawPath == DrawPath::GpuCulled ? 1 : settings.drawCount;
         
-        VkSemaphore signalSemaphores[] = {renderFinishedSemaphore[currentFrame]};
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
+        // Culled on the recording threads before they record, so they only ever see visible objects
+        if (drawPath == DrawPath::CpuCulled)
+        {
+            auto cullStart = std::chrono::steady_clock::now();
+            cullSpheresParallel(recordingThreads, cullingKernel, cullingFrustum, sceneObjects, visibleObjects);
+            
+            profiler.addCpuSample("cull", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count());
+            recordedDraws = static_cast<uint32_t>(visibleObjects.size());
+        }
         
-         vkResetFences(device, 1, &inFlightFences[currentFrame]);
-        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
-            throw std::runtime_error("Failed to submit draw command buffer!");
+        if (drawPath == DrawPath::Unbatched || drawPath == DrawPath::Instanced)
+        {
+            writeSceneInstances();
+            recordedDraws = drawPath == DrawPath::Instanced ? static_cast<uint32_t>(instanceBatcher.getBatches().size()) : instanceBatcher.getInstanceCount();
+        }
         
-        VkPresentInfoKHR presentInfo {};
-        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        // Secondaries run in order, so the pre-pass half of the list finishes the depth buffer before any layer is shaded
+        if (drawPath == DrawPath::Layered)
+            recordedDraws = static_cast<uint32_t>(sceneLayers.size()) * (layerPrepassPipeline != VK_NULL_HANDLE ? 2 : 1);
         
-        presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = signalSemaphores;
+        const auto &secondaryBuffers = commandRecorder.recordSecondaries(inheritanceInfo, recordedDraws, [this](VkCommandBuffer secondaryBuffer, uint32_t worker, uint32_t firstDraw, uint32_t drawCount)
+        {
+            recordDraws(secondaryBuffer, worker, firstDraw, drawCount);
+        });
         
-        VkSwapchainKHR swapChains[] = {swapChain};
-        presentInfo.swapchainCount = 1;
-        presentInfo.pSwapchains = swapChains;
-        presentInfo.pImageIndices = &imageIndex;
+        vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaryBuffers.size()), secondaryBuffers.data());
         
-        vkQueuePresentKHR(graphicsQueue, &presentInfo);
+        if (settings.gbufferPass)
+            recordComposite(commandBuffer);
         
-        vkQueueWaitIdle(graphicsQueue);
+        vkCmdEndRenderPass(commandBuffer);
+        profiler.endScope(commandBuffer);
         
-        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        if (statisticsQueryPool != VK_NULL_HANDLE)
+            vkCmdEndQuery(commandBuffer, statisticsQueryPool, static_cast<uint32_t>(currentFrame));
     }
     
-    void createSyncObjects()
+    // A fullscreen triangle in the primary buffer, after the scene subpass has filled albedo
+    void recordComposite(VkCommandBuffer commandBuffer)
     {
-        imageAvailableSemaphore.resize(MAX_FRAMES_IN_FLIGHT);
-        renderFinishedSemaphore.resize(MAX_FRAMES_IN_FLIGHT);
-        inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-        imagesInFlight.resize(swapChainImages.size(), VK_NULL_HANDLE);
+        vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
         
-        VkSemaphoreCreateInfo semaphoreInfo {};
-        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        // The secondaries are done by now, so worker 0's pools are free to use here
+        VkDescriptorSet descriptorSet = descriptorAllocator.allocate(compositeSetLayout);
+        VkDescriptorImageInfo imageInfo {VK_NULL_HANDLE, albedoImage.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
         
-        VkFenceCreateInfo fenceInfo {};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        VkWriteDescriptorSet descriptorWrite {};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = descriptorSet;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageInfo;
         
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-            if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphore[i]) || vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphore[i]) != VK_SUCCESS || vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]))
-                throw std::runtime_error("Failed to create semaphores!");
+        vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+        
+        VkViewport viewport {0.0f, 0.0f, (float) swapChainExtent.width, (float) swapChainExtent.height, 0.0f, 1.0f};
+        VkRect2D scissor {{0, 0}, swapChainExtent};
+        
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, compositePipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, compositeLayout, 0, 1, &descriptorSet, 0, nullptr);
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
     }
     
-    void createCommandBuffers()
+    // Runs on the recording threads, so apart from its worker's descriptor pools it may only read state that stays fixed while a frame is recorded
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t worker, uint32_t firstDraw, uint32_t drawCount)
     {
-        commandBuffers.resize(swapChainFrameBuffers.size());
+        // Secondary buffers inherit nothing but the render pass, so each one binds its own state
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPath == DrawPath::Default ? graphicsPipeline : drawPathPipeline);
+        
+        // Viewport and scissor are dynamic so the pipeline survives a resize
+        VkViewport viewport {0.0f, 0.0f, (float) swapChainExtent.width, (float) swapChainExtent.height, 0.0f, 1.0f};
+        VkRect2D scissor {{0, 0}, swapChainExtent};
+        
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.buffer, &offset);
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT16);
+        
+        if (drawPath == DrawPath::Default)
+        {
+            // One reservation per range, after that every draw writes its transform and binds the same set at a new offset
+            uint32_t firstElement = frameUniforms.allocate(drawCount);
+            VkDescriptorSet descriptorSet = frameUniforms.getDescriptorSet();
+            
+            for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++)
+            {
+                uint32_t element = firstElement + (draw - firstDraw);
+                writeObjectTransform(draw, frameUniforms.getElement<ObjectUniforms>(element)->transform);
+                
+                uint32_t dynamicOffset = frameUniforms.getDynamicOffset(element);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 1, &dynamicOffset);
+                
+                DrawConstants constants {draw % MATERIAL_COUNT};
+                vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+                
+                vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(triangleIndices.size()), 1, 0, 0, draw);
+            }
+            
+            return;
+        }
+        
+        if (drawPath == DrawPath::Bindless)
+        {
+            VkDescriptorSet descriptorSet = bindlessTable.getDescriptorSet(static_cast<uint32_t>(currentFrame));
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPathLayout, 0, 1, &descriptorSet, 0, nullptr);
+            
+            for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++)
+            {
+                uint32_t handle = drawDataHandles[draw % drawDataHandles.size()];
+                
+                vkCmdPushConstants(commandBuffer, drawPathLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(handle), &handle);
+                vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(triangleIndices.size()), 1, 0, 0, draw);
+            }
+            
+            return;
+        }
         
-        VkCommandBufferAllocateInfo allocInfo {};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.commandPool = commandPool;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandBufferCount = (uint32_t) commandBuffers.size();
+        if (drawPath == DrawPath::Unbatched || drawPath == DrawPath::Instanced)
+        {
+            VkDeviceSize instanceOffset = instanceBatcher.getSlotOffset();
+            VkBuffer instanceBuffer = instanceBatcher.getBuffer();
+            vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer, &instanceOffset);
+            
+            const std::vector<InstanceBatch> &batches = instanceBatcher.getBatches();
+            
+            if (drawPath == DrawPath::Instanced)
+            {
+                for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++)
+                {
+                    const InstanceBatch &batch = batches[draw];
+                    const MeshRange &mesh = meshRanges[batch.mesh];
+                    
+                    DrawConstants constants {batch.material};
+                    vkCmdPushConstants(commandBuffer, drawPathLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+                    
+                    vkCmdDrawIndexed(commandBuffer, mesh.indexCount, batch.instanceCount, mesh.firstIndex, mesh.vertexOffset, batch.firstInstance);
+                }
+                
+                return;
+            }
+            
+            // Here the draw range counts instances, so a worker only touches the batches its range overlaps
+            for (const auto &batch : batches)
+            {
+                const MeshRange &mesh = meshRanges[batch.mesh];
+                
+                uint32_t first = std::max(batch.firstInstance, firstDraw);
+                uint32_t last = std::min(batch.firstInstance + batch.instanceCount, firstDraw + drawCount);
+                
+                if (first >= last)
+                    continue;
+                
+                DrawConstants constants {batch.material};
+                vkCmdPushConstants(commandBuffer, drawPathLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+                
+                for (uint32_t instance = first; instance < last; instance++)
+                    vkCmdDrawIndexed(commandBuffer, mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffset, instance);
+            }
+            
+            return;
+        }
         
-        if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS)
-            throw std::runtime_error("Failed to create command buffers!");
+        if (drawPath == DrawPath::Layered)
+        {
+            uint32_t layerCount = static_cast<uint32_t>(sceneLayers.size());
+            VkPipeline boundPipeline = drawPathPipeline;
+            
+            for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++)
+            {
+                VkPipeline pipeline = layerPrepassPipeline != VK_NULL_HANDLE && draw < layerCount ? layerPrepassPipeline : drawPathPipeline;
+                
+                if (pipeline != boundPipeline)
+                {
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+                    boundPipeline = pipeline;
+                }
+                
+                const LayerConstants &layer = sceneLayers[draw % layerCount];
+                const MeshRange &quad = meshRanges[1];
+                
+                vkCmdPushConstants(commandBuffer, drawPathLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(layer), &layer);
+                vkCmdDrawIndexed(commandBuffer, quad.indexCount, 1, quad.firstIndex, quad.vertexOffset, 0);
+            }
+            
+            return;
+        }
         
-        for (size_t i = 0; i < commandBuffers.size(); i++)
+        if (drawPath == DrawPath::CpuCulled || drawPath == DrawPath::GpuCulled)
         {
-            VkCommandBufferBeginInfo beginInfo {};
-            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            beginInfo.flags = 0;
-            beginInfo.pInheritanceInfo = nullptr;
+            VkDescriptorSet descriptorSet = gpuCuller.getObjectSet();
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPathLayout, 0, 1, &descriptorSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, drawPathLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(cullingViewProjection), cullingViewProjection);
             
-            if (vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS)
-                throw std::runtime_error("Failed to being recording command buffers!");
+            if (drawPath == DrawPath::GpuCulled)
+            {
+                gpuCuller.recordDraws(commandBuffer, static_cast<uint32_t>(currentFrame));
+                return;
+            }
             
-            VkRenderPassBeginInfo renderPassInfo {};
-            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderPassInfo.renderPass = renderPass;
-            renderPassInfo.framebuffer = swapChainFrameBuffers[i];
-            renderPassInfo.renderArea.offset = {0, 0};
-            renderPassInfo.renderArea.extent = swapChainExtent;
+            // The draw range indexes the visible list culled before recording started
+            for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++)
+            {
+                uint32_t objectIndex = visibleObjects[draw];
+                const CullObject &object = cullObjects[objectIndex];
+                
+                vkCmdDrawIndexed(commandBuffer, object.indexCount, 1, object.firstIndex, object.vertexOffset, objectIndex);
+            }
             
-            VkClearValue clearColor {0.0f, 0.0f, 0.0f, 1.0f};
-            renderPassInfo.clearValueCount = 1;
-            renderPassInfo.pClearValues = &clearColor;
+            return;
+        }
+        
+        // Each worker allocates from pools of its own, so the threads never contend for one
+        for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; draw++)
+        {
+            VkDescriptorSet descriptorSet = descriptorAllocator.allocate(classicSetLayout, worker);
             
-            vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            const DeviceBuffer &drawData = drawDataBuffers[draw % drawDataBuffers.size()];
+            VkDescriptorBufferInfo bufferInfo {drawData.buffer, 0, drawData.size};
             
-            vkCmdBindPipeline(commandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+            VkWriteDescriptorSet descriptorWrite {};
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = descriptorSet;
+            descriptorWrite.dstBinding = 0;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.pBufferInfo = &bufferInfo;
             
-            vkCmdDraw(commandBuffers[i], 3, 1, 0, 0);
+            vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
             
-            vkCmdEndRenderPass(commandBuffers[i]);
-            if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS)
-                throw std::runtime_error("Failed to read command buffer!");
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPathLayout, 0, 1, &descriptorSet, 0, nullptr);
+            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(triangleIndices.size()), 1, 0, 0, draw);
         }
     }
     
-    void createCommanPool()
+    
+    // Spreads the draws over the screen on a sunflower spiral, draw 0 of a single draw keeps the original triangle
+    void writeObjectTransform(uint32_t draw, float* transform) const
     {
-        QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
-        
-        VkCommandPoolCreateInfo poolInfo {};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-        poolInfo.flags = 0;
+        const float goldenAngle = 2.39996323f;
+        
+        float scale = 1.0f / std::sqrt(static_cast<float>(std::max(settings.drawCount, 1u)));
+        float radius = 0.8f * std::sqrt(static_cast<float>(draw) / std::max(settings.drawCount, 1u));
+        float angle = goldenAngle * draw;
+        
+        // Column major, like GLSL
+        float matrix[16] = {
+            scale, 0.0f, 0.0f, 0.0f,
+            0.0f, scale, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            radius * std::cos(angle), radius * std::sin(angle), 0.0f, 1.0f
+        };
         
-        if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
-            throw std::runtime_error("Failed to create command pool!");
+        memcpy(transform, matrix, sizeof(matrix));
     }
     
     void createFrameBuffers()
@@ -304,15 +3365,19 @@ private:
         
         for (size_t i = 0; i < swapChainImageViews.size(); i++)
         {
-            VkImageView attachments[] = {
-                swapChainImageViews[i]
+            std::vector<VkImageView> attachments = {
+                swapChainImageViews[i],
+                depthImage.view
             };
             
+            if (settings.gbufferPass)
+                attachments.push_back(albedoImage.view);
+            
             VkFramebufferCreateInfo framebufferInfo {};
             framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
             framebufferInfo.renderPass = renderPass;
-            framebufferInfo.attachmentCount = 1;
-            framebufferInfo.pAttachments = attachments;
+            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            framebufferInfo.pAttachments = attachments.data();
             framebufferInfo.width = swapChainExtent.width;
             framebufferInfo.height = swapChainExtent.height;
             framebufferInfo.layers = 1;
@@ -324,203 +3389,166 @@ private:
     
     void createRenderPass()
     {
-        VkAttachmentDescription colorAttachment {};
-        colorAttachment.format = swapChainImageFormat;
-        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        renderPassBuilder = RenderPassBuilder();
+        
+        // The frame graph transitions the swapchain image for presenting and orders each frame after the last one
+        renderPassBuilder.setExternalSynchronization(true);
+        
+        AttachmentInfo colorInfo;
+        colorInfo.format = swapChainImageFormat;
+        colorInfo.storeContents = true;
+        
+        // The composite covers every pixel, so there is nothing to clear
+        colorInfo.clear = !settings.gbufferPass;
         
-        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        // Cleared at the start and thrown away at the end, nothing reads depth after the pass
+        AttachmentInfo depthInfo;
+        depthInfo.format = depthFormat;
+        depthInfo.storeContents = storeIntermediates;
         
-        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        renderPassBuilder.addAttachment(colorInfo);
+        renderPassBuilder.addAttachment(depthInfo);
         
-        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        uint32_t scene = renderPassBuilder.addSubpass();
+        renderPassBuilder.setDepthAttachment(scene, DEPTH_ATTACHMENT);
         
-        VkAttachmentReference colorAttachmentRef {};
-        colorAttachmentRef.attachment = 0;
-        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        if (!settings.gbufferPass)
+        {
+            renderPassBuilder.addColorOutput(scene, SWAPCHAIN_ATTACHMENT);
+            renderPass = pipelineRegistry.getRenderPass(renderPassBuilder.build());
         
-        VkSubpassDescription subpass {};
-        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpass.colorAttachmentCount = 1;
-        subpass.pColorAttachments = &colorAttachmentRef;
+            return;
+        }
         
-        VkRenderPassCreateInfo renderPassInfo {};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = 1;
-        renderPassInfo.pAttachments = &colorAttachment;
-        renderPassInfo.subpassCount = 1;
-        renderPassInfo.pSubpasses = &subpass;
+        // In the swapchain format so the composite is a straight copy. Only read at the pixel being shaded, which lets a
+        // tiler merge both subpasses and keep albedo on chip
+        AttachmentInfo albedoInfo;
+        albedoInfo.format = swapChainImageFormat;
+        albedoInfo.storeContents = storeIntermediates;
         
-        VkSubpassDependency dependency {};
-        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        renderPassBuilder.addAttachment(albedoInfo);
+        renderPassBuilder.addColorOutput(scene, ALBEDO_ATTACHMENT);
         
-        renderPassInfo.dependencyCount = 1;
-        renderPassInfo.pDependencies = &dependency;
+        uint32_t composite = renderPassBuilder.addSubpass();
+        renderPassBuilder.addInputAttachment(composite, ALBEDO_ATTACHMENT);
+        renderPassBuilder.addColorOutput(composite, SWAPCHAIN_ATTACHMENT);
         
-        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
-            throw std::runtime_error("Failed to create render pass!");
+        renderPass = pipelineRegistry.getRenderPass(renderPassBuilder.build());
     }
     
     void createGraphicsPipeline()
     {
-        auto vertShaderCode = readFile("Shaders/vert.spv");
-        auto fragShaderCode = readFile("Shaders/frag.spv");
-        
-        VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-        VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-        
-        VkPipelineShaderStageCreateInfo vertShaderStageInfo {};
-        vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vertShaderStageInfo.module = vertShaderModule;
-        vertShaderStageInfo.pName = "main";
-        
-        VkPipelineShaderStageCreateInfo fragShaderStageInfo {};
-        fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fragShaderStageInfo.module = fragShaderModule;
-        fragShaderStageInfo.pName = "main";
-        
-        VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-        
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo {};
-        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 0;
-        vertexInputInfo.pVertexBindingDescriptions = nullptr;
-        vertexInputInfo.vertexAttributeDescriptionCount = 0;
-        vertexInputInfo.pVertexAttributeDescriptions = nullptr;
-        
-        VkPipelineInputAssemblyStateCreateInfo inputAssembly {};
-        inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        inputAssembly.primitiveRestartEnable = VK_FALSE;
-        
-        VkViewport viewport {};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = WINDOW_WIDTH;
-        viewport.height = WINDOW_HEIGHT;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-        
-        VkRect2D scissor {};
-        scissor.offset = {0, 0};
-        scissor.extent = swapChainExtent;
-        
-        VkPipelineViewportStateCreateInfo viewportState {};
-        viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-        viewportState.viewportCount = 1;
-        viewportState.pViewports = &viewport;
-        viewportState.scissorCount = 1;
-        viewportState.pScissors = &scissor;
-        
-        VkPipelineRasterizationStateCreateInfo rasterizer {};
-        rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        rasterizer.depthClampEnable = VK_FALSE;
-        rasterizer.rasterizerDiscardEnable = VK_FALSE;
-        rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-        rasterizer.lineWidth = 1.0f;
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-        rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-        rasterizer.depthBiasEnable = VK_FALSE;
-        rasterizer.depthBiasConstantFactor = 0.0f;
-        rasterizer.depthBiasClamp = 0.0f;
-        rasterizer.depthBiasSlopeFactor = 0.0f;
-        
-        VkPipelineMultisampleStateCreateInfo multisampling {};
-        multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-        multisampling.sampleShadingEnable = VK_FALSE;
-        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-        multisampling.minSampleShading = 1.0f;
-        multisampling.pSampleMask = nullptr;
-        multisampling.alphaToCoverageEnable = VK_FALSE;
-        multisampling.alphaToOneEnable = VK_FALSE;
-        
-        VkPipelineColorBlendAttachmentState colorBlendAttachment {};
-        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-        colorBlendAttachment.blendEnable = VK_FALSE;
-        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-        
-        VkPipelineColorBlendStateCreateInfo colorBlending {};
-        colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-        colorBlending.logicOpEnable = VK_FALSE;
-        colorBlending.logicOp = VK_LOGIC_OP_COPY;
-        colorBlending.attachmentCount = 1;
-        colorBlending.pAttachments = &colorBlendAttachment;
-        
-        VkDynamicState dynamicStates[] = {
-            VK_DYNAMIC_STATE_VIEWPORT,
-            VK_DYNAMIC_STATE_LINE_WIDTH
-        };
+        // Transforms come from the frame uniform buffer at a dynamic offset, the material index is pushed per draw
+        PipelineLayoutDescription layoutDescription;
+        layoutDescription.setLayouts = {frameUniforms.getSetLayout()};
+        layoutDescription.pushConstantRanges = {{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants)}};
+        
+        pipelineLayout = pipelineRegistry.getPipelineLayout(layoutDescription);
         
-        VkPipelineDynamicStateCreateInfo dynamicState {};
-        dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-        dynamicState.dynamicStateCount = 2;
-        dynamicState.pDynamicStates = dynamicStates;
+        // Built on the worker threads while the rest of startup carries on, see waitForGraphicsPipeline()
+        pendingGraphicsPipeline = pipelineRegistry.getPipeline(describeGraphicsPipeline());
         
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 0;
-        pipelineLayoutInfo.pSetLayouts = nullptr;
-        pipelineLayoutInfo.pushConstantRangeCount = 0;
-        pipelineLayoutInfo.pPushConstantRanges = nullptr;
+        if (settings.gbufferPass)
+            createCompositePipeline();
+    }
+    
+    void createCompositePipeline()
+    {
+        if (compositeSetLayout == VK_NULL_HANDLE)
+        {
+            VkDescriptorSetLayoutBinding albedoBinding {};
+            albedoBinding.binding = 0;
+            albedoBinding.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            albedoBinding.descriptorCount = 1;
+            albedoBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+            
+            VkDescriptorSetLayoutCreateInfo layoutInfo {};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layoutInfo.bindingCount = 1;
+            layoutInfo.pBindings = &albedoBinding;
+            
+            if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &compositeSetLayout) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create descriptor set layout!");
+        }
+        
+        PipelineLayoutDescription layoutDescription;
+        layoutDescription.setLayouts = {compositeSetLayout};
         
-        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
-            throw std::runtime_error("Failed to create a pipeline layout!");
+        compositeLayout = pipelineRegistry.getPipelineLayout(layoutDescription);
         
-        VkGraphicsPipelineCreateInfo pipelineInfo {};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = 2;
-        pipelineInfo.pStages = shaderStages;
+        GraphicsPipelineDescription description;
+        description.vertexShader = shaderLibrary.load("Shaders/fullscreen.spv");
+        description.fragmentShader = shaderLibrary.load("Shaders/composite.spv");
+        description.cullMode = VK_CULL_MODE_NONE;
+        description.layout = compositeLayout;
+        description.renderPass = renderPass;
+        description.subpass = 1;
         
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssembly;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizer;
-        pipelineInfo.pMultisampleState = &multisampling;
-        pipelineInfo.pDepthStencilState = nullptr;
-        pipelineInfo.pColorBlendState = &colorBlending;
-        pipelineInfo.pDynamicState = nullptr;
+        compositePipeline = pipelineRegistry.getPipeline(description).get();
+    }
+        
+    GraphicsPipelineDescription describeGraphicsPipeline()
+    {
+        GraphicsPipelineDescription description;
+        
+        // Owned by the library, so recreating the pipeline after a format change reuses them
+        description.vertexShader = shaderLibrary.load("Shaders/vert.spv");
+        description.fragmentShader = shaderLibrary.load("Shaders/frag.spv");
         
-        pipelineInfo.layout = pipelineLayout;
+        description.vertexBindings = {Vertex::getBindingDescription()};
         
-        pipelineInfo.renderPass = renderPass;
-        pipelineInfo.subpass = 0;
+        auto attributeDescriptions = Vertex::getAttributeDescriptions();
+        description.vertexAttributes.assign(attributeDescriptions.begin(), attributeDescriptions.end());
         
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-        pipelineInfo.basePipelineIndex = -1;
+        // Everything is drawn at the same depth, LESS_OR_EQUAL keeps the later draw on top as without a depth test
+        description.depthTestEnable = true;
+        description.depthWriteEnable = true;
+        description.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
         
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
-            throw std::runtime_error("Failed to create graphics pipeline!");
+        description.layout = pipelineLayout;
+        description.renderPass = renderPass;
+        
+        return description;
+    }
+    
+    void waitForGraphicsPipeline()
+    {
+        if (!pendingGraphicsPipeline.valid())
+            return;
         
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
+        graphicsPipeline = pendingGraphicsPipeline.get();
+        pendingGraphicsPipeline = std::shared_future<VkPipeline>();
     }
     
-    VkShaderModule createShaderModule(const std::vector<char> &code)
+    void createOffscreenImages()
     {
-        VkShaderModuleCreateInfo createInfo {};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+        swapChainImageFormat = chooseOffscreenFormat(physicalDevice);
+        swapChainExtent = {WINDOW_WIDTH, WINDOW_HEIGHT};
         
-        VkShaderModule shaderModule;
-        if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
-            throw std::runtime_error("Failed to create shader module!");
+        // One target per possible frame in flight so frames never wait on each other's image
+        swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+        offscreenImageMemory.resize(MAX_FRAMES_IN_FLIGHT);
         
-        return shaderModule;
+        for (size_t i = 0; i < swapChainImages.size(); i++)
+        {
+            VkImageCreateInfo imageInfo {};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = swapChainImageFormat;
+            imageInfo.extent = {swapChainExtent.width, swapChainExtent.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            
+            if (vkCreateImage(device, &imageInfo, nullptr, &swapChainImages[i]) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create offscreen image!");
+            
+            offscreenImageMemory[i] = memoryAllocator.allocateForImage(swapChainImages[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
     }
     
     void createImageViews()
@@ -551,7 +3579,31 @@ private:
         }
     }
     
-    void createSwapChain()
+    // The most precise format the device can use as a depth attachment, stencil only comes along where it is packed in
+    VkFormat findDepthFormat() const
+    {
+        for (VkFormat format : {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM})
+        {
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+            
+            if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+                return format;
+        }
+        
+        throw std::runtime_error("Failed to find a supported depth format!");
+    }
+    
+    // Usage comes from the render pass, so intermediates that never leave it get transient, lazily allocated images
+    void createAttachmentImages()
+    {
+        depthImage = createAttachmentImage(device, &memoryAllocator, depthFormat, swapChainExtent, renderPassBuilder.getImageUsage(DEPTH_ATTACHMENT));
+        
+        if (settings.gbufferPass)
+            albedoImage = createAttachmentImage(device, &memoryAllocator, swapChainImageFormat, swapChainExtent, renderPassBuilder.getImageUsage(ALBEDO_ATTACHMENT));
+    }
+    
+    void createSwapChain(VkSwapchainKHR oldSwapChain = VK_NULL_HANDLE)
     {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
         
@@ -594,7 +3646,7 @@ private:
         createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
         createInfo.presentMode = presentMode;
         createInfo.clipped = VK_TRUE;
-        createInfo.oldSwapchain = VK_NULL_HANDLE;
+        createInfo.oldSwapchain = oldSwapChain;
         
         if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS)
             throw std::runtime_error("Failed to create swapchain!");
@@ -613,7 +3665,10 @@ private:
             return capabilities.currentExtent;
         else
         {
-            VkExtent2D actualExtent {WINDOW_WIDTH, WINDOW_HEIGHT};
+            int width = 0, height = 0;
+            glfwGetFramebufferSize(window, &width, &height);
+            
+            VkExtent2D actualExtent {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
             
             actualExtent.width = std::max(capabilities.minImageExtent.width, std::min(capabilities.maxImageExtent.width, actualExtent.width));
             actualExtent.height = std::max(capabilities.minImageExtent.height, std::min(capabilities.maxImageExtent.height, actualExtent.height));
@@ -690,17 +3745,42 @@ private:
                 indices.graphicsFamily = i;
             
             VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+            
+            if (surface != VK_NULL_HANDLE)
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
             
             if (presentSupport)
                 indices.presentFamily = i;
             
-            if (indices.isComplete())
+            if (indices.isComplete() || (surface == VK_NULL_HANDLE && indices.graphicsFamily.has_value()))
                 break;
             
             i++;
         }
         
+        // A transfer-only family is usually a dedicated DMA engine, a compute family without graphics is the next best thing
+        for (uint32_t j = 0; j < queueFamilies.size(); j++)
+        {
+            VkQueueFlags flags = queueFamilies[j].queueFlags;
+            
+            if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+                continue;
+            
+            if (!indices.transferFamily.has_value() || !(flags & VK_QUEUE_COMPUTE_BIT))
+                indices.transferFamily = j;
+        }
+        
+        if (!indices.transferFamily.has_value())
+            indices.transferFamily = indices.graphicsFamily;
+        
+        // Async compute needs a family without graphics, otherwise compute goes through the graphics family
+        for (uint32_t j = 0; j < queueFamilies.size() && !indices.computeFamily.has_value(); j++)
+            if ((queueFamilies[j].queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamilies[j].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                indices.computeFamily = j;
+        
+        if (!indices.computeFamily.has_value())
+            indices.computeFamily = indices.graphicsFamily;
+        
         return indices;
     }
     
@@ -708,25 +3788,92 @@ private:
     {
         QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
         
-        VkDeviceQueueCreateInfo queueCreateInfo {};
-        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queueCreateInfo.queueFamilyIndex = indices.graphicsFamily.value();
-        queueCreateInfo.queueCount = 1;
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+        
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+        
+        // Each role takes its own queue while its family has one to spare, after that it shares the last one
+        std::map<uint32_t, uint32_t> queueCounts;
+        
+        auto assignQueue = [&](uint32_t queueFamily)
+        {
+            uint32_t queueIndex = std::min(queueCounts[queueFamily], queueFamilies[queueFamily].queueCount - 1);
+            queueCounts[queueFamily] = queueIndex + 1;
+            
+            return queueIndex;
+        };
+        
+        uint32_t graphicsQueueIndex = assignQueue(indices.graphicsFamily.value());
+        uint32_t computeQueueIndex = assignQueue(indices.computeFamily.value());
+        uint32_t transferQueueIndex = assignQueue(indices.transferFamily.value());
+        
+        std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+        std::vector<float> queuePriorities(3, 1.0f);
+        
+        for (const auto &[queueFamily, queueCount] : queueCounts)
+        {
+            VkDeviceQueueCreateInfo queueCreateInfo {};
+            queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueCreateInfo.queueFamilyIndex = queueFamily;
+            queueCreateInfo.queueCount = queueCount;
+            queueCreateInfo.pQueuePriorities = queuePriorities.data();
+            
+            queueCreateInfos.push_back(queueCreateInfo);
+        }
         
-        float queuePriority = 1.0f;
-        queueCreateInfo.pQueuePriorities = &queuePriority;
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
         
+        // Lets shaders index the bindless arrays with a handle from push constants
         VkPhysicalDeviceFeatures deviceFeatures {};
+        deviceFeatures.shaderStorageBufferArrayDynamicIndexing = supportedFeatures.shaderStorageBufferArrayDynamicIndexing;
+        deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
+        
+        // GPU culling writes many draws into one indirect buffer and passes the object index as firstInstance
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+        
+        // Streamed textures stay block compressed on the GPU when the device can sample them that way
+        deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+        deviceFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+        
+        // Lets the depth benchmark count shaded fragments, the query stays active across the secondary command buffers
+        deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+        deviceFeatures.inheritedQueries = supportedFeatures.inheritedQueries;
         
         VkDeviceCreateInfo createInfo {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        createInfo.pQueueCreateInfos = &queueCreateInfo;
-        createInfo.queueCreateInfoCount = 1;
+        createInfo.pQueueCreateInfos = queueCreateInfos.data();
+        createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         
         createInfo.pEnabledFeatures = &deviceFeatures;
         
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        std::vector<const char*> extensions = getRequiredDeviceExtensions();
+        
+        if (settings.descriptorIndexing)
+            descriptorIndexing = queryDescriptorIndexingSupport(instance, physicalDevice);
+        
+        // Without it the bindless table falls back to a plain descriptor set per frame slot
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = getBindlessIndexingFeatures();
+        
+        if (descriptorIndexing.supported)
+        {
+            extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+            extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+            
+            createInfo.pNext = &indexingFeatures;
+        }
+        
+        // Lets the culling pass hand the number of visible draws to the GPU instead of zeroing the culled ones
+        bool drawIndirectCount = checkDeviceExtensionAvailable(physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        
+        if (drawIndirectCount)
+            extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
         
         if (enableValidationLayers)
         {
@@ -737,7 +3884,19 @@ private:
         if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS)
             throw std::runtime_error("Failed to create logical device!");
         
-        vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
+        vkGetDeviceQueue(device, indices.graphicsFamily.value(), graphicsQueueIndex, &graphicsQueue);
+        vkGetDeviceQueue(device, indices.computeFamily.value(), computeQueueIndex, &computeQueue);
+        vkGetDeviceQueue(device, indices.transferFamily.value(), transferQueueIndex, &transferQueue);
+        
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        
+        indirectDraws.multiDrawIndirect = deviceFeatures.multiDrawIndirect;
+        indirectDraws.drawIndirectFirstInstance = deviceFeatures.drawIndirectFirstInstance;
+        indirectDraws.maxDrawIndirectCount = properties.limits.maxDrawIndirectCount;
+        
+        if (drawIndirectCount)
+            indirectDraws.drawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR) vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
     }
     
     bool isDeviceSuitable(VkPhysicalDevice device)
@@ -746,6 +3905,10 @@ private:
         
         bool extensionsSupported = checkDeviceExtensionSupport(device);
         
+        // Without a surface there is nothing to present to, any graphics queue will do
+        if (settings.headless)
+            return indices.graphicsFamily.has_value() && extensionsSupported;
+        
         bool swapChainAdequate = false;
         if (extensionsSupported)
         {
@@ -756,6 +3919,14 @@ private:
         return indices.isComplete() && extensionsSupported && swapChainAdequate;
     }
     
+    std::vector<const char*> getRequiredDeviceExtensions() const
+    {
+        if (settings.headless)
+            return {};
+        
+        return deviceExtensions;
+    }
+    
     bool checkDeviceExtensionSupport(VkPhysicalDevice device)
     {
         uint32_t extensionCount = 0;
@@ -764,7 +3935,8 @@ private:
         std::vector<VkExtensionProperties> availableExtensions(extensionCount);
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
         
-        std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+        std::vector<const char*> extensions = getRequiredDeviceExtensions();
+        std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
         
         for (const auto &extension : availableExtensions)
             requiredExtensions.erase(extension.extensionName);
@@ -783,17 +3955,13 @@ private:
         std::vector<VkPhysicalDevice> devices(deviceCount);
         vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
             
+        // The first suitable device is often the integrated GPU on machines that have two
+        std::vector<PhysicalDeviceDescription> descriptions;
+        
         for (const auto &device : devices)
-        {
-            if (isDeviceSuitable(device))
-            {
-                physicalDevice = device;
-                break;
-            }
-        }
+            descriptions.push_back(describePhysicalDevice(instance, device, isDeviceSuitable(device), deviceUUIDQueryEnabled));
         
-        if (physicalDevice == VK_NULL_HANDLE)
-            throw std::runtime_error("Failed to find a suitable GPU!");
+        physicalDevice = devices[selectPhysicalDevice(descriptions, getDeviceOverride(settings.deviceOverride))];
     }
     
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo)
@@ -855,37 +4023,92 @@ private:
             throw std::runtime_error("Failed to create instance!");
     }
     
-    void cleanup() const
+    void cleanup()
     {
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        destroyRetiredSwapChains(true);
+        
+        destroySyncObjects();
+        
+        commandRecorder.destroy();
+        
+        asyncCompute.destroy();
+        
+        if (overlapPipeline.pipeline != VK_NULL_HANDLE)
         {
-            vkDestroySemaphore(device, imageAvailableSemaphore[i], nullptr);
-            vkDestroySemaphore(device, renderFinishedSemaphore[i], nullptr);
-            vkDestroyFence(device, inFlightFences[i], nullptr);
+            overlapPipeline.destroy(device);
+            
+            vkDestroyDescriptorPool(device, overlapDescriptorPool, nullptr);
+            vkDestroyDescriptorSetLayout(device, overlapSetLayout, nullptr);
+            
+            bufferManager.destroyBuffer(overlapResults);
         }
         
-        vkDestroyCommandPool(device, commandPool, nullptr);
+        gpuCuller.destroy();
+        meshStreamer.destroy();
+        textureStreamer.destroy();
+        
+        bufferManager.destroyBuffer(indexBuffer);
+        bufferManager.destroyBuffer(vertexBuffer);
+        bufferManager.destroy();
+        
+        bindlessTable.destroy();
+        descriptorAllocator.destroy();
+        frameGraph.destroy();
+        frameUniforms.destroy();
+        instanceBatcher.destroy();
+        
+        // Kept until shutdown as pipeline layouts in the registry were built from it
+        if (classicSetLayout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(device, classicSetLayout, nullptr);
+        
+        if (compositeSetLayout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(device, compositeSetLayout, nullptr);
+        
+        profiler.destroy();
         
         for (auto framebuffer : swapChainFrameBuffers)
             vkDestroyFramebuffer(device, framebuffer, nullptr);
         
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-        vkDestroyRenderPass(device, renderPass, nullptr);
+        pipelineRegistry.destroy();
+        
+        pipelineCache.save(device);
+        pipelineCache.destroy(device);
+        
+        shaderLibrary.destroy();
+        assetArchive.close();
         
         for (auto imageView : swapChainImageViews)
             vkDestroyImageView(device, imageView, nullptr);
         
-        vkDestroySwapchainKHR(device, swapChain, nullptr);
+        destroyAttachmentImage(device, &memoryAllocator, depthImage);
+        destroyAttachmentImage(device, &memoryAllocator, albedoImage);
+        
+        if (settings.headless)
+        {
+            for (size_t i = 0; i < swapChainImages.size(); i++)
+            {
+                vkDestroyImage(device, swapChainImages[i], nullptr);
+                memoryAllocator.free(offscreenImageMemory[i]);
+            }
+        }
+        else
+            vkDestroySwapchainKHR(device, swapChain, nullptr);
+        
+        memoryAllocator.destroy();
         
         vkDestroyDevice(device, nullptr);
         
         if (enableValidationLayers)
             DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
         
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+        if (surface != VK_NULL_HANDLE)
+            vkDestroySurfaceKHR(instance, surface, nullptr);
+        
         vkDestroyInstance(instance, nullptr);
         
+        if (window == nullptr)
+            return;
+        
         glfwDestroyWindow(window);
         
         glfwTerminate();
@@ -921,53 +4144,82 @@ private:
     
     std::vector<const char*> getRequiredExtensions()
     {
-        uint32_t glfwExtensionsCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionsCount);
+        std::vector<const char*> extensions;
         
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionsCount);
+        // Surface extensions are only needed when there is a window to present to
+        if (!settings.headless)
+        {
+            uint32_t glfwExtensionsCount = 0;
+            const char** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionsCount);
+            
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionsCount);
+        }
         
         if (enableValidationLayers)
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
         
+        // Optional, needed to query descriptor indexing support on a 1.0 instance
+        if (checkInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        
+        // Optional, the device UUID a GPU override can match is one of its properties
+        deviceUUIDQueryEnabled = isDeviceUUIDQuerySupported();
+        
+        if (deviceUUIDQueryEnabled)
+            extensions.push_back(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
+        
         return extensions;
     }
     
-    static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallBack(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-                                                        VkDebugUtilsMessageTypeFlagsEXT messageType,
-                                                        const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-                                                        void* pUserData)
+    bool checkDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName)
     {
-        if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
-            std::cerr << "Validation layer: " << pCallbackData->pMessage << std::endl;
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
         
-        return VK_FALSE;
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+        
+        for (const auto &extension : availableExtensions)
+            if (strcmp(extension.extensionName, extensionName) == 0)
+                return true;
+        
+        return false;
     }
     
-    static std::vector<char> readFile(const std::string &fileName)
+    bool checkInstanceExtensionSupport(const char* extensionName)
     {
-        std::ifstream file(fileName, std::ios::ate | std::ios::binary);
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
         
-        if (!file.is_open())
-            throw std::runtime_error("Failed to open file!");
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
         
-        size_t fileSize = (size_t) file.tellg();
-        std::vector<char> buffer(fileSize);
+        for (const auto &extension : availableExtensions)
+            if (strcmp(extension.extensionName, extensionName) == 0)
+                return true;
         
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        file.close();
+        return false;
+    }
+    
+    static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallBack(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+                                                        VkDebugUtilsMessageTypeFlagsEXT messageType,
+                                                        const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+                                                        void* pUserData)
+    {
+        if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+            std::cerr << "Validation layer: " << pCallbackData->pMessage << std::endl;
         
-        return buffer;
+        return VK_FALSE;
     }
 };
 
-int main()
+int main(int argc, const char* argv[])
 {
-    HelloTriangleApplication application;
-    
     try
     {
+        HelloTriangleApplication application(parseApplicationSettings(argc, argv));
+        
         application.run();
     }
     catch (const std::exception &e)
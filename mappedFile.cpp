@@ -0,0 +1,86 @@
+//
+//  mappedFile.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "mappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &path)
+{
+    int descriptor = open(path.c_str(), O_RDONLY);
+    
+    if (descriptor < 0)
+        throw std::runtime_error("Failed to open file " + path + "!");
+    
+    struct stat status;
+    
+    if (fstat(descriptor, &status) != 0)
+    {
+        close(descriptor);
+        throw std::runtime_error("Failed to stat file " + path + "!");
+    }
+    
+    mappedSize = static_cast<size_t>(status.st_size);
+    opened = true;
+    
+    if (mappedSize > 0)
+    {
+        void* address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        
+        if (address == MAP_FAILED)
+        {
+            close(descriptor);
+            throw std::runtime_error("Failed to map file " + path + "!");
+        }
+        
+        mapping = static_cast<const uint8_t*>(address);
+    }
+    
+    // The mapping keeps its own reference to the file
+    close(descriptor);
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        
+        mapping = std::exchange(other.mapping, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+        opened = std::exchange(other.opened, false);
+    }
+    
+    return *this;
+}
+
+void MappedFile::unmap()
+{
+    if (mapping != nullptr)
+        munmap(const_cast<uint8_t*>(mapping), mappedSize);
+    
+    mapping = nullptr;
+    mappedSize = 0;
+    opened = false;
+}
@@ -0,0 +1,48 @@
+//
+//  mappedFile.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef mappedFile_hpp
+#define mappedFile_hpp
+
+#include <stdio.h>
+#include <cstdint>
+#include <string>
+
+// Read-only view of a whole file through mmap. The mapping is page aligned, so any
+// offset that is a multiple of 4 is aligned well enough for SPIR-V words
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    
+    const uint8_t* data() const { return mapping; }
+    size_t size() const { return mappedSize; }
+    
+    bool isOpen() const { return opened; }
+
+private:
+    const uint8_t* mapping = nullptr;
+    size_t mappedSize = 0;
+    
+    // An empty file is open but has nothing mapped
+    bool opened = false;
+    
+    void unmap();
+};
+
+#endif /* mappedFile_hpp */
@@ -0,0 +1,338 @@
+//
+//  memoryAllocator.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "memoryAllocator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+struct MemoryBlock
+{
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    
+    uint32_t memoryType;
+    ResourceTiling tiling;
+    
+    // Holds one resource too large to share a block, or backs a linear pool
+    bool dedicated;
+    bool linear;
+    
+    char* mapped;
+    
+    TlsfAllocator allocator;
+};
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Defined here, where MemoryBlock is complete
+DeviceMemoryAllocator::DeviceMemoryAllocator() = default;
+DeviceMemoryAllocator::~DeviceMemoryAllocator() = default;
+
+void DeviceMemoryAllocator::create(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+{
+    this->physicalDevice = physicalDevice;
+    this->device = device;
+    this->blockSize = blockSize;
+    
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    
+    bufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+    maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+}
+
+void DeviceMemoryAllocator::destroy()
+{
+    for (const auto &block : blocks)
+    {
+        if (block->mapped != nullptr)
+            vkUnmapMemory(device, block->memory);
+        
+        vkFreeMemory(device, block->memory, nullptr);
+    }
+    
+    blocks.clear();
+    linearPools.clear();
+    
+    bytesUsed = 0;
+    bytesWasted = 0;
+    allocationCount = 0;
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, ResourceTiling tiling)
+{
+    uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+    
+    // With a granularity of 1 the two kinds of resource can sit side by side, otherwise they get separate blocks
+    bool separateTiling = bufferImageGranularity > 1;
+    
+    MemoryBlock* block = nullptr;
+    uint32_t handle = TlsfAllocator::INVALID_HANDLE;
+    uint64_t offset = 0;
+    
+    // Lazily allocated memory is committed per image as the tiles spill into it, a shared block would defeat that
+    if (requirements.size > blockSize / 2 || (properties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+        block = createBlock(memoryType, requirements.size, tiling, true);
+    else
+    {
+        for (const auto &candidate : blocks)
+        {
+            if (candidate->dedicated || candidate->linear || candidate->memoryType != memoryType || (separateTiling && candidate->tiling != tiling))
+                continue;
+            
+            if (candidate->allocator.getFreeSize() < requirements.size)
+                continue;
+            
+            handle = candidate->allocator.allocate(requirements.size, requirements.alignment, offset);
+            
+            if (handle != TlsfAllocator::INVALID_HANDLE)
+            {
+                block = candidate.get();
+                break;
+            }
+        }
+        
+        if (block == nullptr)
+        {
+            block = createBlock(memoryType, blockSize, tiling, false);
+            handle = block->allocator.allocate(requirements.size, requirements.alignment, offset);
+        }
+    }
+    
+    MemoryAllocation allocation;
+    allocation.memory = block->memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mapped = block->mapped != nullptr ? block->mapped + offset : nullptr;
+    allocation.block = block;
+    allocation.handle = handle;
+    
+    VkDeviceSize reserved = block->dedicated ? block->size : block->allocator.getReservedSize(handle);
+    
+    bytesUsed += allocation.size;
+    bytesWasted += reserved - allocation.size;
+    allocationCount++;
+    
+    return allocation;
+}
+
+void DeviceMemoryAllocator::free(MemoryAllocation &allocation)
+{
+    MemoryBlock* block = allocation.block;
+    
+    // Null handles and linear pool allocations have nothing to give back
+    if (block == nullptr)
+    {
+        allocation = MemoryAllocation();
+        return;
+    }
+    
+    VkDeviceSize reserved = block->dedicated ? block->size : block->allocator.getReservedSize(allocation.handle);
+    
+    bytesUsed -= allocation.size;
+    bytesWasted -= reserved - allocation.size;
+    allocationCount--;
+    
+    if (block->dedicated)
+        destroyBlock(block);
+    else
+    {
+        block->allocator.free(allocation.handle);
+        
+        // One empty block per memory type is kept around so churn at a block boundary does not thrash vkAllocateMemory
+        if (block->allocator.isEmpty())
+        {
+            for (const auto &other : blocks)
+            {
+                if (other.get() != block && !other->dedicated && !other->linear && other->memoryType == block->memoryType && other->tiling == block->tiling && other->allocator.isEmpty())
+                {
+                    destroyBlock(block);
+                    break;
+                }
+            }
+        }
+    }
+    
+    allocation = MemoryAllocation();
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+    
+    MemoryAllocation allocation = allocate(memoryRequirements, properties, ResourceTiling::Linear);
+    
+    if (vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS)
+        throw std::runtime_error("Failed to bind buffer memory!");
+    
+    return allocation;
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocateForImage(VkImage image, VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device, image, &memoryRequirements);
+    
+    // Assumes VK_IMAGE_TILING_OPTIMAL, linearly tiled images should go through allocate with ResourceTiling::Linear
+    MemoryAllocation allocation = allocate(memoryRequirements, properties, ResourceTiling::Optimal);
+    
+    if (vkBindImageMemory(device, image, allocation.memory, allocation.offset) != VK_SUCCESS)
+        throw std::runtime_error("Failed to bind image memory!");
+    
+    return allocation;
+}
+
+uint32_t DeviceMemoryAllocator::createLinearPool(VkDeviceSize size, uint32_t memoryTypeBits, VkMemoryPropertyFlags properties)
+{
+    MemoryBlock* block = createBlock(findMemoryType(memoryTypeBits, properties), size, ResourceTiling::Linear, false);
+    block->linear = true;
+    
+    linearPools.push_back({block, 0, ResourceTiling::Linear, 0, 0, 0});
+    
+    return static_cast<uint32_t>(linearPools.size() - 1);
+}
+
+MemoryAllocation DeviceMemoryAllocator::allocateLinear(uint32_t pool, const VkMemoryRequirements &requirements, ResourceTiling tiling)
+{
+    LinearPool &linearPool = linearPools[pool];
+    
+    if (!(requirements.memoryTypeBits & (1u << linearPool.block->memoryType)))
+        throw std::runtime_error("Resource cannot live in the memory type of this linear pool!");
+    
+    VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+    
+    // Moving between buffers and optimal images has to start a fresh granularity page
+    if (linearPool.allocationCount > 0 && tiling != linearPool.lastTiling)
+        alignment = std::max(alignment, bufferImageGranularity);
+    
+    VkDeviceSize offset = alignUp(linearPool.head, alignment);
+    
+    if (offset + requirements.size > linearPool.block->size)
+        throw std::runtime_error("Linear pool is out of memory!");
+    
+    linearPool.bytesWasted += offset - linearPool.head;
+    linearPool.bytesUsed += requirements.size;
+    linearPool.allocationCount++;
+    
+    linearPool.head = offset + requirements.size;
+    linearPool.lastTiling = tiling;
+    
+    MemoryAllocation allocation;
+    allocation.memory = linearPool.block->memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mapped = linearPool.block->mapped != nullptr ? linearPool.block->mapped + offset : nullptr;
+    
+    return allocation;
+}
+
+void DeviceMemoryAllocator::resetLinearPool(uint32_t pool)
+{
+    LinearPool &linearPool = linearPools[pool];
+    
+    linearPool.head = 0;
+    linearPool.bytesUsed = 0;
+    linearPool.bytesWasted = 0;
+    linearPool.allocationCount = 0;
+}
+
+AllocatorStats DeviceMemoryAllocator::getStats() const
+{
+    AllocatorStats stats;
+    stats.bytesUsed = bytesUsed;
+    stats.bytesWasted = bytesWasted;
+    stats.allocationCount = allocationCount;
+    stats.blockCount = static_cast<uint32_t>(blocks.size());
+    
+    for (const auto &block : blocks)
+        stats.bytesReserved += block->size;
+    
+    for (const auto &linearPool : linearPools)
+    {
+        stats.bytesUsed += linearPool.bytesUsed;
+        stats.bytesWasted += linearPool.bytesWasted;
+        stats.allocationCount += linearPool.allocationCount;
+    }
+    
+    return stats;
+}
+
+MemoryBlock* DeviceMemoryAllocator::createBlock(uint32_t memoryType, VkDeviceSize size, ResourceTiling tiling, bool dedicated)
+{
+    if (blocks.size() >= maxAllocationCount)
+        throw std::runtime_error("Reached maxMemoryAllocationCount!");
+    
+    VkMemoryAllocateInfo allocInfo {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+    
+    auto block = std::make_unique<MemoryBlock>();
+    block->size = size;
+    block->memoryType = memoryType;
+    block->tiling = tiling;
+    block->dedicated = dedicated;
+    block->linear = false;
+    block->mapped = nullptr;
+    
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &block->memory) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate device memory block!");
+    
+    // Host visible blocks are mapped once up front, mapping per allocation is slow and cannot overlap within one block
+    if (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        void* mapped = nullptr;
+        
+        if (vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+            throw std::runtime_error("Failed to map device memory block!");
+        
+        block->mapped = static_cast<char*>(mapped);
+    }
+    
+    if (!dedicated)
+        block->allocator.reset(size);
+    
+    blocks.push_back(std::move(block));
+    
+    return blocks.back().get();
+}
+
+void DeviceMemoryAllocator::destroyBlock(MemoryBlock* block)
+{
+    if (block->mapped != nullptr)
+        vkUnmapMemory(device, block->memory);
+    
+    vkFreeMemory(device, block->memory, nullptr);
+    
+    blocks.erase(std::find_if(blocks.begin(), blocks.end(), [block](const std::unique_ptr<MemoryBlock> &candidate) { return candidate.get() == block; }));
+}
+
+uint32_t DeviceMemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    
+    throw std::runtime_error("Failed to find a suitable memory type!");
+}
+
+bool DeviceMemoryAllocator::hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return true;
+    
+    return false;
+}
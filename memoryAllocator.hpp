@@ -0,0 +1,128 @@
+//
+//  memoryAllocator.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef memoryAllocator_hpp
+#define memoryAllocator_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <memory>
+#include <stdio.h>
+#include <vector>
+
+#include "tlsfAllocator.hpp"
+
+const VkDeviceSize DEFAULT_MEMORY_BLOCK_SIZE = 64 * 1024 * 1024;
+
+// Buffers and linear images against optimally tiled images, the two must not share a bufferImageGranularity page
+enum class ResourceTiling
+{
+    Linear,
+    Optimal
+};
+
+struct MemoryBlock;
+
+struct MemoryAllocation
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    
+    // Points at offset for host visible memory, which stays mapped for as long as its block lives
+    void* mapped = nullptr;
+    
+    MemoryBlock* block = nullptr;
+    uint32_t handle = TlsfAllocator::INVALID_HANDLE;
+};
+
+struct AllocatorStats
+{
+    // Device memory held by blocks, i.e. what vkAllocateMemory has handed out
+    VkDeviceSize bytesReserved = 0;
+    
+    // Requested by live allocations
+    VkDeviceSize bytesUsed = 0;
+    
+    // Alignment and granularity padding plus unsplit remainders held by live allocations
+    VkDeviceSize bytesWasted = 0;
+    
+    uint32_t blockCount = 0;
+    uint32_t allocationCount = 0;
+};
+
+// Grabs large VkDeviceMemory blocks per memory type and sub-allocates resources out of them, so the number
+// of vkAllocateMemory calls stays far below maxMemoryAllocationCount
+class DeviceMemoryAllocator
+{
+public:
+    DeviceMemoryAllocator();
+    ~DeviceMemoryAllocator();
+    
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = DEFAULT_MEMORY_BLOCK_SIZE);
+    void destroy();
+    
+    MemoryAllocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, ResourceTiling tiling);
+    void free(MemoryAllocation &allocation);
+    
+    // Allocate and bind in one go
+    MemoryAllocation allocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties);
+    MemoryAllocation allocateForImage(VkImage image, VkMemoryPropertyFlags properties);
+    
+    // Linear mode: a single block handed out front to back and released all at once with resetLinearPool,
+    // meant for per-frame transient data. Allocations from it are never freed individually
+    uint32_t createLinearPool(VkDeviceSize size, uint32_t memoryTypeBits, VkMemoryPropertyFlags properties);
+    MemoryAllocation allocateLinear(uint32_t pool, const VkMemoryRequirements &requirements, ResourceTiling tiling);
+    void resetLinearPool(uint32_t pool);
+    
+    AllocatorStats getStats() const;
+    
+    VkDeviceSize getBufferImageGranularity() const { return bufferImageGranularity; }
+
+    // Whether allocate() can satisfy the properties for a resource with these memory type bits
+    bool hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+private:
+    struct LinearPool
+    {
+        MemoryBlock* block;
+        
+        VkDeviceSize head;
+        ResourceTiling lastTiling;
+        
+        VkDeviceSize bytesUsed;
+        VkDeviceSize bytesWasted;
+        uint32_t allocationCount;
+    };
+    
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    VkDeviceSize bufferImageGranularity = 1;
+    uint32_t maxAllocationCount = 0;
+    
+    VkDeviceSize blockSize = DEFAULT_MEMORY_BLOCK_SIZE;
+    
+    std::vector<std::unique_ptr<MemoryBlock>> blocks;
+    std::vector<LinearPool> linearPools;
+    
+    VkDeviceSize bytesUsed = 0;
+    VkDeviceSize bytesWasted = 0;
+    uint32_t allocationCount = 0;
+    
+    MemoryBlock* createBlock(uint32_t memoryType, VkDeviceSize size, ResourceTiling tiling, bool dedicated);
+    void destroyBlock(MemoryBlock* block);
+    
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+};
+
+#endif /* memoryAllocator_hpp */
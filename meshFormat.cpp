@@ -0,0 +1,436 @@
+//
+//  meshFormat.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "meshFormat.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+static size_t alignSection(size_t size)
+{
+    return (size + 3) & ~static_cast<size_t>(3);
+}
+
+static size_t getPositionSectionSize(uint32_t vertexCount)
+{
+    return alignSection(static_cast<size_t>(vertexCount) * 3 * sizeof(uint16_t));
+}
+
+static size_t getNormalSectionSize(uint32_t vertexCount)
+{
+    return static_cast<size_t>(vertexCount) * 2 * sizeof(int16_t);
+}
+
+static void normalize(float* vector)
+{
+    float length = std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+    
+    if (length > 0.0f)
+    {
+        vector[0] /= length;
+        vector[1] /= length;
+        vector[2] /= length;
+    }
+    else
+    {
+        vector[0] = 0.0f;
+        vector[1] = 0.0f;
+        vector[2] = 1.0f;
+    }
+}
+
+static float signNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+static int16_t quantizeSnorm(float value)
+{
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+// Projects the unit normal onto an octahedron and unfolds the lower half over the corners of the upper one
+static void encodeOctahedral(const float* normal, int16_t* encoded)
+{
+    float sum = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    float x = sum > 0.0f ? normal[0] / sum : 0.0f;
+    float y = sum > 0.0f ? normal[1] / sum : 0.0f;
+    
+    if (normal[2] < 0.0f)
+    {
+        float foldedX = (1.0f - std::fabs(y)) * signNotZero(x);
+        float foldedY = (1.0f - std::fabs(x)) * signNotZero(y);
+        
+        x = foldedX;
+        y = foldedY;
+    }
+    
+    encoded[0] = quantizeSnorm(x);
+    encoded[1] = quantizeSnorm(y);
+}
+
+static void decodeOctahedral(const int16_t* encoded, float* normal)
+{
+    float x = std::max(encoded[0] / 32767.0f, -1.0f);
+    float y = std::max(encoded[1] / 32767.0f, -1.0f);
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+    
+    if (z < 0.0f)
+    {
+        float unfoldedX = (1.0f - std::fabs(y)) * signNotZero(x);
+        float unfoldedY = (1.0f - std::fabs(x)) * signNotZero(y);
+        
+        x = unfoldedX;
+        y = unfoldedY;
+    }
+    
+    normal[0] = x;
+    normal[1] = y;
+    normal[2] = z;
+    
+    normalize(normal);
+}
+
+std::vector<uint8_t> encodeMesh(const SourceMesh &mesh)
+{
+    if (mesh.vertices.empty() || mesh.indices.empty() || mesh.indices.size() % 3 != 0)
+        throw std::runtime_error("Failed to encode mesh, it has no triangles!");
+    
+    MeshFileHeader header {};
+    header.magic = MESH_MAGIC;
+    header.version = MESH_VERSION;
+    header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+    header.indexSize = header.vertexCount <= MAX_SHORT_INDEX_VERTICES ? 2 : 4;
+    
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        header.boundsMin[axis] = mesh.vertices[0].position[axis];
+        header.boundsMax[axis] = mesh.vertices[0].position[axis];
+    }
+    
+    for (const auto &vertex : mesh.vertices)
+    {
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], vertex.position[axis]);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], vertex.position[axis]);
+        }
+    }
+    
+    size_t positionOffset = sizeof(MeshFileHeader);
+    size_t normalOffset = positionOffset + getPositionSectionSize(header.vertexCount);
+    size_t indexOffset = normalOffset + getNormalSectionSize(header.vertexCount);
+    
+    std::vector<uint8_t> data(indexOffset + static_cast<size_t>(header.indexCount) * header.indexSize, 0);
+    memcpy(data.data(), &header, sizeof(header));
+    
+    // Each axis spans 0..65535 across the bounds, a flat axis stores zeros
+    float scale[3];
+    
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        float extent = header.boundsMax[axis] - header.boundsMin[axis];
+        scale[axis] = extent > 0.0f ? 65535.0f / extent : 0.0f;
+    }
+    
+    for (uint32_t i = 0; i < header.vertexCount; i++)
+    {
+        const MeshVertex &vertex = mesh.vertices[i];
+        uint16_t position[3];
+        int16_t normal[2];
+        
+        for (uint32_t axis = 0; axis < 3; axis++)
+            position[axis] = static_cast<uint16_t>(std::lround(std::clamp((vertex.position[axis] - header.boundsMin[axis]) * scale[axis], 0.0f, 65535.0f)));
+        
+        encodeOctahedral(vertex.normal, normal);
+        
+        memcpy(data.data() + positionOffset + i * sizeof(position), position, sizeof(position));
+        memcpy(data.data() + normalOffset + i * sizeof(normal), normal, sizeof(normal));
+    }
+    
+    for (uint32_t i = 0; i < header.indexCount; i++)
+    {
+        if (mesh.indices[i] >= header.vertexCount)
+            throw std::runtime_error("Failed to encode mesh, an index is out of range!");
+        
+        if (header.indexSize == 2)
+        {
+            uint16_t index = static_cast<uint16_t>(mesh.indices[i]);
+            memcpy(data.data() + indexOffset + i * sizeof(index), &index, sizeof(index));
+        }
+        else
+            memcpy(data.data() + indexOffset + i * sizeof(uint32_t), &mesh.indices[i], sizeof(uint32_t));
+    }
+    
+    return data;
+}
+
+MeshData decodeMesh(const uint8_t* data, size_t size)
+{
+    MeshFileHeader header;
+    
+    if (size < sizeof(header))
+        throw std::runtime_error("Mesh data is truncated!");
+    
+    memcpy(&header, data, sizeof(header));
+    
+    if (header.magic != MESH_MAGIC || header.version != MESH_VERSION)
+        throw std::runtime_error("Mesh data has an unknown format!");
+    
+    if (header.indexSize != 2 && header.indexSize != 4)
+        throw std::runtime_error("Mesh data has an invalid index size!");
+    
+    // Same rule as encodeMesh, the streamer cannot create empty buffers
+    if (header.vertexCount == 0 || header.indexCount == 0 || header.indexCount % 3 != 0)
+        throw std::runtime_error("Mesh data has no triangles!");
+    
+    size_t positionOffset = sizeof(MeshFileHeader);
+    size_t normalOffset = positionOffset + getPositionSectionSize(header.vertexCount);
+    size_t indexOffset = normalOffset + getNormalSectionSize(header.vertexCount);
+    size_t indexSize = static_cast<size_t>(header.indexCount) * header.indexSize;
+    
+    if (size < indexOffset + indexSize)
+        throw std::runtime_error("Mesh data is truncated!");
+    
+    MeshData mesh;
+    mesh.vertices.resize(header.vertexCount);
+    mesh.indexCount = header.indexCount;
+    mesh.indexSize = header.indexSize;
+    
+    memcpy(mesh.boundsMin, header.boundsMin, sizeof(mesh.boundsMin));
+    memcpy(mesh.boundsMax, header.boundsMax, sizeof(mesh.boundsMax));
+    
+    float scale[3];
+    
+    for (uint32_t axis = 0; axis < 3; axis++)
+        scale[axis] = (header.boundsMax[axis] - header.boundsMin[axis]) / 65535.0f;
+    
+    for (uint32_t i = 0; i < header.vertexCount; i++)
+    {
+        uint16_t position[3];
+        int16_t normal[2];
+        
+        memcpy(position, data + positionOffset + i * sizeof(position), sizeof(position));
+        memcpy(normal, data + normalOffset + i * sizeof(normal), sizeof(normal));
+        
+        MeshVertex &vertex = mesh.vertices[i];
+        
+        for (uint32_t axis = 0; axis < 3; axis++)
+            vertex.position[axis] = header.boundsMin[axis] + position[axis] * scale[axis];
+        
+        decodeOctahedral(normal, vertex.normal);
+    }
+    
+    // Indices keep their width, so they are copied as they are and only scanned for the largest one
+    mesh.indices.assign(data + indexOffset, data + indexOffset + indexSize);
+    
+    uint32_t maxIndex = 0;
+    
+    if (header.indexSize == 2)
+    {
+        for (uint32_t i = 0; i < header.indexCount; i++)
+        {
+            uint16_t index;
+            memcpy(&index, mesh.indices.data() + i * sizeof(index), sizeof(index));
+            
+            maxIndex = std::max<uint32_t>(maxIndex, index);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < header.indexCount; i++)
+        {
+            uint32_t index;
+            memcpy(&index, mesh.indices.data() + i * sizeof(index), sizeof(index));
+            
+            maxIndex = std::max(maxIndex, index);
+        }
+    }
+    
+    if (maxIndex >= header.vertexCount)
+        throw std::runtime_error("Mesh data has an index out of range!");
+    
+    return mesh;
+}
+
+// OBJ indices count from 1, negative ones count back from the end of what has been read so far
+static bool resolveObjIndex(long index, size_t count, uint32_t &resolved)
+{
+    long position = index < 0 ? static_cast<long>(count) + index : index - 1;
+    
+    if (index == 0 || position < 0 || position >= static_cast<long>(count))
+        return false;
+    
+    resolved = static_cast<uint32_t>(position);
+    return true;
+}
+
+SourceMesh loadObjMesh(const std::string &path)
+{
+    std::ifstream file(path);
+    
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open " + path + "!");
+    
+    std::vector<std::array<float, 3>> positions;
+    std::vector<std::array<float, 3>> normals;
+    
+    SourceMesh mesh;
+    std::vector<bool> hasNormal;
+    
+    // Position index in the high half, normal index or UINT32_MAX in the low one
+    std::unordered_map<uint64_t, uint32_t> vertexLookup;
+    std::vector<uint32_t> polygon;
+    
+    std::string line;
+    uint32_t lineNumber = 0;
+    
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        
+        const char* cursor = line.c_str();
+        
+        while (*cursor == ' ' || *cursor == '\t')
+            cursor++;
+        
+        bool isPosition = cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t');
+        bool isNormal = cursor[0] == 'v' && cursor[1] == 'n' && (cursor[2] == ' ' || cursor[2] == '\t');
+        
+        if (isPosition || isNormal)
+        {
+            std::array<float, 3> value {};
+            char* end = nullptr;
+            
+            cursor += isPosition ? 1 : 2;
+            
+            for (auto &component : value)
+            {
+                component = std::strtof(cursor, &end);
+                
+                if (end == cursor)
+                    throw std::runtime_error("Failed to parse " + path + " at line " + std::to_string(lineNumber) + "!");
+                
+                cursor = end;
+            }
+            
+            (isPosition ? positions : normals).push_back(value);
+        }
+        else if (cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+        {
+            polygon.clear();
+            cursor++;
+            
+            // Corners are v, v/vt, v//vn or v/vt/vn, texture coordinates are skipped
+            while (true)
+            {
+                char* end = nullptr;
+                long positionIndex = std::strtol(cursor, &end, 10);
+                
+                if (end == cursor)
+                    break;
+                
+                cursor = end;
+                
+                uint32_t position = 0, normal = UINT32_MAX;
+                bool valid = resolveObjIndex(positionIndex, positions.size(), position);
+                
+                if (*cursor == '/')
+                {
+                    std::strtol(++cursor, &end, 10);
+                    cursor = end;
+                    
+                    if (*cursor == '/')
+                    {
+                        long normalIndex = std::strtol(++cursor, &end, 10);
+                        
+                        valid = valid && end != cursor && resolveObjIndex(normalIndex, normals.size(), normal);
+                        cursor = end;
+                    }
+                }
+                
+                if (!valid)
+                    throw std::runtime_error("Failed to parse " + path + " at line " + std::to_string(lineNumber) + ", index out of range!");
+                
+                auto [entry, inserted] = vertexLookup.try_emplace(static_cast<uint64_t>(position) << 32 | normal, static_cast<uint32_t>(mesh.vertices.size()));
+                
+                if (inserted)
+                {
+                    MeshVertex vertex {};
+                    memcpy(vertex.position, positions[position].data(), sizeof(vertex.position));
+                    
+                    if (normal != UINT32_MAX)
+                    {
+                        memcpy(vertex.normal, normals[normal].data(), sizeof(vertex.normal));
+                        normalize(vertex.normal);
+                    }
+                    
+                    mesh.vertices.push_back(vertex);
+                    hasNormal.push_back(normal != UINT32_MAX);
+                }
+                
+                polygon.push_back(entry->second);
+            }
+            
+            if (polygon.size() < 3)
+                throw std::runtime_error("Failed to parse " + path + " at line " + std::to_string(lineNumber) + ", face has fewer than 3 corners!");
+            
+            // Fans are fine for the convex polygons exporters write
+            for (size_t i = 1; i + 1 < polygon.size(); i++)
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i], polygon[i + 1]});
+        }
+    }
+    
+    if (mesh.indices.empty())
+        throw std::runtime_error(path + " has no faces!");
+    
+    // Corners without a normal get the area weighted sum of the faces around them
+    if (std::find(hasNormal.begin(), hasNormal.end(), false) != hasNormal.end())
+    {
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+        {
+            const float* a = mesh.vertices[mesh.indices[i]].position;
+            const float* b = mesh.vertices[mesh.indices[i + 1]].position;
+            const float* c = mesh.vertices[mesh.indices[i + 2]].position;
+            
+            float edge0[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            float edge1[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            
+            float faceNormal[3] = {
+                edge0[1] * edge1[2] - edge0[2] * edge1[1],
+                edge0[2] * edge1[0] - edge0[0] * edge1[2],
+                edge0[0] * edge1[1] - edge0[1] * edge1[0]
+            };
+            
+            for (size_t corner = i; corner < i + 3; corner++)
+            {
+                if (hasNormal[mesh.indices[corner]])
+                    continue;
+                
+                float* normal = mesh.vertices[mesh.indices[corner]].normal;
+                
+                normal[0] += faceNormal[0];
+                normal[1] += faceNormal[1];
+                normal[2] += faceNormal[2];
+            }
+        }
+        
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+            if (!hasNormal[i])
+                normalize(mesh.vertices[i].normal);
+    }
+    
+    return mesh;
+}
@@ -0,0 +1,79 @@
+//
+//  meshFormat.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef meshFormat_hpp
+#define meshFormat_hpp
+
+#include <stdio.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint32_t MESH_MAGIC = 0x48534D56; // "VMSH"
+const uint32_t MESH_VERSION = 1;
+
+// Meshes with at most this many vertices are stored and drawn with 16-bit indices
+const uint32_t MAX_SHORT_INDEX_VERTICES = 65536;
+
+// Layout on disk: header, positions as 3 x uint16 per vertex quantized to the bounds, normals as 2 x snorm16
+// octahedral coordinates, then the indices. Every section starts on a 4 byte boundary, everything is little endian
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    
+    // 2 or 4
+    uint32_t indexSize;
+    uint32_t reserved;
+    
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshVertex
+{
+    float position[3];
+    float normal[3];
+};
+
+// What the converter produces, indices are always 32-bit here and narrowed by encodeMesh
+struct SourceMesh
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// A decoded mesh, ready to be copied into vertex and index buffers as it is
+struct MeshData
+{
+    std::vector<MeshVertex> vertices;
+    
+    // indexCount indices of indexSize bytes each
+    std::vector<uint8_t> indices;
+    uint32_t indexCount = 0;
+    uint32_t indexSize = 4;
+    
+    float boundsMin[3] {};
+    float boundsMax[3] {};
+    
+    size_t getByteSize() const { return vertices.size() * sizeof(MeshVertex) + indices.size(); }
+};
+
+// Triangulates polygons and merges corners that share a position and normal. Faces without normals get smooth ones
+SourceMesh loadObjMesh(const std::string &path);
+
+std::vector<uint8_t> encodeMesh(const SourceMesh &mesh);
+
+// Checks the header, the sizes and every index, so a damaged file throws instead of reaching the GPU
+MeshData decodeMesh(const uint8_t* data, size_t size);
+
+#endif /* meshFormat_hpp */
@@ -0,0 +1,276 @@
+//
+//  meshStreamer.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "meshStreamer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "mappedFile.hpp"
+
+// MESH DECODER FUNCTIONS START
+
+void MeshDecoder::create(const AssetArchive* archive, uint32_t threadCount, uint64_t maxPendingBytes)
+{
+    this->archive = archive;
+    this->maxPendingBytes = maxPendingBytes;
+    
+    threadPool = std::make_unique<ThreadPool>(threadCount);
+    maxDecodes = threadPool->getThreadCount();
+}
+
+void MeshDecoder::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.clear();
+    }
+    
+    // Drains the decodes that are running, nothing new gets started with the queue empty
+    threadPool.reset();
+    
+    finished.clear();
+    pendingBytes = 0;
+    decoding = 0;
+}
+
+uint32_t MeshDecoder::request(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    uint32_t mesh = nextMesh++;
+    queued.push_back({mesh, path});
+    
+    startDecodes();
+    
+    return mesh;
+}
+
+bool MeshDecoder::takeFinished(DecodedMesh &mesh)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    if (finished.empty())
+        return false;
+    
+    mesh = std::move(finished.front());
+    finished.pop_front();
+    
+    pendingBytes -= mesh.data.getByteSize();
+    
+    // Taking a mesh may have brought the waiting bytes back under the limit
+    startDecodes();
+    
+    return true;
+}
+
+bool MeshDecoder::waitFinished(DecodedMesh &mesh)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    finishedCondition.wait(lock, [this]() { return !finished.empty() || (queued.empty() && decoding == 0); });
+    
+    if (finished.empty())
+        return false;
+    
+    mesh = std::move(finished.front());
+    finished.pop_front();
+    
+    pendingBytes -= mesh.data.getByteSize();
+    startDecodes();
+    
+    return true;
+}
+
+bool MeshDecoder::isIdle() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    return queued.empty() && finished.empty() && decoding == 0;
+}
+
+MeshDecodeStats MeshDecoder::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    return stats;
+}
+
+void MeshDecoder::startDecodes()
+{
+    while (!queued.empty() && decoding < maxDecodes && pendingBytes < maxPendingBytes)
+    {
+        Request request = std::move(queued.front());
+        queued.pop_front();
+        
+        decoding++;
+        
+        threadPool->submit([this, request]()
+        {
+            decode(request);
+        });
+    }
+}
+
+void MeshDecoder::decode(const Request &request)
+{
+    DecodedMesh mesh;
+    mesh.mesh = request.mesh;
+    
+    size_t sourceSize = 0;
+    
+    try
+    {
+        const ArchiveEntry* entry = archive != nullptr && archive->isOpen() ? archive->find(request.path) : nullptr;
+        
+        if (entry != nullptr)
+        {
+            sourceSize = entry->size;
+            
+            // Uncompressed entries are decoded straight from the mapping
+            if (const uint8_t* data = archive->getData(*entry))
+                mesh.data = decodeMesh(data, entry->size);
+            else
+            {
+                std::vector<uint8_t> bytes = archive->read(*entry);
+                mesh.data = decodeMesh(bytes.data(), bytes.size());
+            }
+        }
+        else
+        {
+            MappedFile file(request.path);
+            
+            sourceSize = file.size();
+            mesh.data = decodeMesh(file.data(), file.size());
+        }
+    }
+    catch (const std::exception &e)
+    {
+        mesh.data = MeshData();
+        mesh.error = request.path + ": " + e.what();
+    }
+    
+    finish(std::move(mesh), sourceSize);
+}
+
+void MeshDecoder::finish(DecodedMesh &&mesh, size_t sourceSize)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        size_t decodedSize = mesh.data.getByteSize();
+        
+        stats.bytesRead += sourceSize;
+        
+        if (mesh.error.empty())
+        {
+            stats.bytesDecoded += decodedSize;
+            stats.meshesDecoded++;
+        }
+        else
+            stats.failures++;
+        
+        pendingBytes += decodedSize;
+        stats.peakPendingBytes = std::max(stats.peakPendingBytes, pendingBytes);
+        
+        finished.push_back(std::move(mesh));
+        decoding--;
+        
+        startDecodes();
+    }
+    
+    finishedCondition.notify_all();
+}
+
+// MESH DECODER FUNCTIONS END
+
+// MESH STREAMER FUNCTIONS START
+
+void MeshStreamer::create(BufferManager* bufferManager, const AssetArchive* archive, uint32_t threadCount, uint64_t maxPendingBytes)
+{
+    this->bufferManager = bufferManager;
+    
+    decoder.create(archive, threadCount, maxPendingBytes);
+}
+
+void MeshStreamer::destroy()
+{
+    if (bufferManager == nullptr)
+        return;
+    
+    decoder.destroy();
+    
+    for (auto &mesh : meshes)
+    {
+        if (mesh.state != MeshState::Resident)
+            continue;
+        
+        bufferManager->destroyBuffer(mesh.vertexBuffer);
+        bufferManager->destroyBuffer(mesh.indexBuffer);
+    }
+    
+    meshes.clear();
+    bufferManager = nullptr;
+}
+
+uint32_t MeshStreamer::request(const std::string &path)
+{
+    uint32_t mesh = decoder.request(path);
+    
+    // The decoder hands out ids in request order, so they index meshes directly
+    meshes.resize(std::max<size_t>(meshes.size(), mesh + 1));
+    meshes[mesh].path = path;
+    
+    return mesh;
+}
+
+uint32_t MeshStreamer::update(VkDeviceSize uploadBudget)
+{
+    VkDeviceSize uploaded = 0;
+    uint32_t completed = 0;
+    DecodedMesh decoded;
+    
+    while (uploaded < uploadBudget && decoder.takeFinished(decoded))
+    {
+        StreamedMesh &mesh = meshes[decoded.mesh];
+        completed++;
+        
+        if (!decoded.error.empty())
+        {
+            mesh.state = MeshState::Failed;
+            mesh.error = decoded.error;
+            
+            continue;
+        }
+        
+        const MeshData &data = decoded.data;
+        
+        VkDeviceSize vertexSize = sizeof(MeshVertex) * data.vertices.size();
+        VkDeviceSize indexSize = data.indices.size();
+        
+        mesh.vertexBuffer = bufferManager->createDeviceBuffer(vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        mesh.indexBuffer = bufferManager->createDeviceBuffer(indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        
+        bufferManager->upload(mesh.vertexBuffer, 0, data.vertices.data(), vertexSize);
+        bufferManager->upload(mesh.indexBuffer, 0, data.indices.data(), indexSize);
+        
+        mesh.vertexCount = static_cast<uint32_t>(data.vertices.size());
+        mesh.indexCount = data.indexCount;
+        mesh.indexType = data.indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        
+        std::copy(data.boundsMin, data.boundsMin + 3, mesh.boundsMin);
+        std::copy(data.boundsMax, data.boundsMax + 3, mesh.boundsMax);
+        
+        mesh.state = MeshState::Resident;
+        uploaded += vertexSize + indexSize;
+    }
+    
+    return completed;
+}
+
+// MESH STREAMER FUNCTIONS END
@@ -0,0 +1,163 @@
+//
+//  meshStreamer.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef meshStreamer_hpp
+#define meshStreamer_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "assetArchive.hpp"
+#include "bufferManager.hpp"
+#include "meshFormat.hpp"
+#include "threadPool.hpp"
+
+// Decoded meshes allowed to wait for their upload before no more decodes are started
+const uint64_t DEFAULT_MAX_PENDING_MESH_BYTES = 128ull * 1024 * 1024;
+
+// Bytes of finished meshes moved into the staging ring per frame, a single larger mesh still goes through whole
+const VkDeviceSize DEFAULT_MESH_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+// A finished decode, error is set and data left empty when it failed
+struct DecodedMesh
+{
+    uint32_t mesh = 0;
+    MeshData data;
+    std::string error;
+};
+
+struct MeshDecodeStats
+{
+    uint64_t bytesRead = 0;
+    uint64_t bytesDecoded = 0;
+    uint32_t meshesDecoded = 0;
+    uint32_t failures = 0;
+    
+    // Most decoded bytes that were waiting to be taken at any one time
+    uint64_t peakPendingBytes = 0;
+};
+
+// Reads and decodes mesh files on worker threads of its own, so a long decode never sits in front of the recording
+// tasks. Finished meshes wait until the owner takes them, and once maxPendingBytes of them are waiting no further
+// decodes start. Decodes already running may overshoot the limit by one mesh each
+class MeshDecoder
+{
+public:
+    void create(const AssetArchive* archive, uint32_t threadCount, uint64_t maxPendingBytes = DEFAULT_MAX_PENDING_MESH_BYTES);
+    
+    // Waits for the decodes that already started, queued ones are dropped
+    void destroy();
+    
+    // Looked up in the archive first, then as a loose file. Ids count up from 0 in request order
+    uint32_t request(const std::string &path);
+    
+    // Never blocks, false when nothing has finished yet
+    bool takeFinished(DecodedMesh &mesh);
+    
+    // Blocks until a mesh has finished, false once nothing is queued, decoding or waiting
+    bool waitFinished(DecodedMesh &mesh);
+    
+    bool isIdle() const;
+    
+    MeshDecodeStats getStats() const;
+
+private:
+    struct Request
+    {
+        uint32_t mesh;
+        std::string path;
+    };
+    
+    std::unique_ptr<ThreadPool> threadPool;
+    const AssetArchive* archive = nullptr;
+    uint32_t maxDecodes = 0;
+    uint64_t maxPendingBytes = 0;
+    
+    mutable std::mutex mutex;
+    std::condition_variable finishedCondition;
+    
+    std::deque<Request> queued;
+    std::deque<DecodedMesh> finished;
+    uint32_t decoding = 0;
+    uint32_t nextMesh = 0;
+    
+    uint64_t pendingBytes = 0;
+    MeshDecodeStats stats;
+    
+    // Called with the mutex held
+    void startDecodes();
+    
+    void decode(const Request &request);
+    void finish(DecodedMesh &&mesh, size_t sourceSize);
+};
+
+enum class MeshState
+{
+    Loading,
+    Resident,
+    Failed
+};
+
+struct StreamedMesh
+{
+    std::string path;
+    MeshState state = MeshState::Loading;
+    std::string error;
+    
+    DeviceBuffer vertexBuffer;
+    DeviceBuffer indexBuffer;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    
+    float boundsMin[3] {};
+    float boundsMax[3] {};
+};
+
+// Streams meshes from disk into device buffers without stalling the frame: the decoder does the file reads and
+// decoding, the main thread only copies finished meshes into the staging ring within a per-frame budget
+class MeshStreamer
+{
+public:
+    void create(BufferManager* bufferManager, const AssetArchive* archive, uint32_t threadCount, uint64_t maxPendingBytes = DEFAULT_MAX_PENDING_MESH_BYTES);
+    
+    // The device must be idle
+    void destroy();
+    
+    uint32_t request(const std::string &path);
+    
+    // Main thread, once per frame. Queues the uploads of finished meshes until uploadBudget bytes have gone out, the
+    // caller flushes them with a semaphore the draws wait on. Returns how many meshes became resident or failed
+    uint32_t update(VkDeviceSize uploadBudget);
+    
+    const StreamedMesh &getMesh(uint32_t mesh) const { return meshes[mesh]; }
+    uint32_t getMeshCount() const { return static_cast<uint32_t>(meshes.size()); }
+    
+    bool isIdle() const { return decoder.isIdle(); }
+    
+    MeshDecodeStats getStats() const { return decoder.getStats(); }
+
+private:
+    BufferManager* bufferManager = nullptr;
+    MeshDecoder decoder;
+    
+    std::vector<StreamedMesh> meshes;
+};
+
+#endif /* meshStreamer_hpp */
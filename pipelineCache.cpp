@@ -0,0 +1,127 @@
+//
+//  pipelineCache.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "pipelineCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+void PersistentPipelineCache::create(VkPhysicalDevice const &physicalDevice, VkDevice const &device, const std::string &path)
+{
+    filePath = path;
+    warm = false;
+    loadedSize = 0;
+    
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    
+    std::vector<char> initialData = readCacheFile(filePath);
+    
+    // Feeding a cache from another device or driver version to the driver is undefined on some implementations
+    if (!initialData.empty() && !isCompatible(initialData, properties))
+    {
+        std::cout << "Discarding stale pipeline cache " << filePath << std::endl;
+        initialData.clear();
+    }
+    
+    VkPipelineCacheCreateInfo createInfo {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialData.size();
+    createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+    
+    if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create pipeline cache!");
+    
+    warm = !initialData.empty();
+    loadedSize = initialData.size();
+}
+
+void PersistentPipelineCache::save(VkDevice const &device) const
+{
+    if (cache == VK_NULL_HANDLE || filePath.empty())
+        return;
+    
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, cache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        return;
+    
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(device, cache, &dataSize, data.data()) != VK_SUCCESS)
+        return;
+    
+    // Write next to the real file and rename over it so a crash never leaves a truncated cache behind
+    std::string temporaryPath = filePath + ".tmp";
+    
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to write pipeline cache " << temporaryPath << std::endl;
+        return;
+    }
+    
+    file.write(data.data(), static_cast<std::streamsize>(dataSize));
+    file.close();
+    
+    if (!file || std::rename(temporaryPath.c_str(), filePath.c_str()) != 0)
+    {
+        std::cerr << "Failed to write pipeline cache " << filePath << std::endl;
+        std::remove(temporaryPath.c_str());
+    }
+}
+
+void PersistentPipelineCache::destroy(VkDevice const &device)
+{
+    if (cache != VK_NULL_HANDLE)
+        vkDestroyPipelineCache(device, cache, nullptr);
+    
+    cache = VK_NULL_HANDLE;
+}
+
+std::vector<char> PersistentPipelineCache::readCacheFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    
+    // A missing cache is the normal cold start, not an error
+    if (!file.is_open())
+        return {};
+    
+    size_t fileSize = (size_t) file.tellg();
+    std::vector<char> buffer(fileSize);
+    
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    
+    if (!file)
+        return {};
+    
+    return buffer;
+}
+
+bool PersistentPipelineCache::isCompatible(const std::vector<char> &data, const VkPhysicalDeviceProperties &properties)
+{
+    VkPipelineCacheHeaderVersionOne header;
+    
+    if (data.size() < sizeof(header))
+        return false;
+    
+    std::memcpy(&header, data.data(), sizeof(header));
+    
+    if (header.headerSize < sizeof(header) || header.headerSize > data.size())
+        return false;
+    
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+        return false;
+    
+    if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID)
+        return false;
+    
+    return std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,52 @@
+//
+//  pipelineCache.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef pipelineCache_hpp
+#define pipelineCache_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// VkPipelineCache that is seeded from a file at startup and written back at shutdown
+class PersistentPipelineCache
+{
+public:
+    // Loads the file at path if it was written by this exact device and driver, otherwise starts empty
+    void create(VkPhysicalDevice const &physicalDevice, VkDevice const &device, const std::string &path);
+    
+    // Writes the current cache contents to the path given to create()
+    void save(VkDevice const &device) const;
+    
+    void destroy(VkDevice const &device);
+    
+    VkPipelineCache getHandle() const { return cache; }
+    
+    // True when the cache was seeded from a valid file on disk
+    bool isWarm() const { return warm; }
+    
+    size_t getLoadedSize() const { return loadedSize; }
+
+private:
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    std::string filePath;
+    
+    bool warm = false;
+    size_t loadedSize = 0;
+    
+    static std::vector<char> readCacheFile(const std::string &path);
+    
+    static bool isCompatible(const std::vector<char> &data, const VkPhysicalDeviceProperties &properties);
+};
+
+#endif /* pipelineCache_hpp */
@@ -0,0 +1,194 @@
+//
+//  pipelineCompiler.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "pipelineCompiler.hpp"
+
+#include <stdexcept>
+
+VkPipeline createGraphicsPipeline(VkDevice device, VkPipelineCache cache, const GraphicsPipelineDescription &description)
+{
+    std::vector<VkSpecializationMapEntry> specializationEntries;
+    
+    for (uint32_t i = 0; i < description.specializationConstants.size(); i++)
+        specializationEntries.push_back({i, static_cast<uint32_t>(i * sizeof(uint32_t)), sizeof(uint32_t)});
+    
+    VkSpecializationInfo specializationInfo {};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+    specializationInfo.pMapEntries = specializationEntries.data();
+    specializationInfo.dataSize = description.specializationConstants.size() * sizeof(uint32_t);
+    specializationInfo.pData = description.specializationConstants.data();
+    
+    const VkSpecializationInfo* specialization = specializationEntries.empty() ? nullptr : &specializationInfo;
+    
+    VkPipelineShaderStageCreateInfo shaderStages[2] {};
+    
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = description.vertexShader;
+    shaderStages[0].pName = "main";
+    shaderStages[0].pSpecializationInfo = specialization;
+    
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = description.fragmentShader;
+    shaderStages[1].pName = "main";
+    shaderStages[1].pSpecializationInfo = specialization;
+    
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(description.vertexBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = description.vertexBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(description.vertexAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = description.vertexAttributes.data();
+    
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = description.topology;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+    
+    VkPipelineViewportStateCreateInfo viewportState {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr;
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr;
+    
+    VkPipelineRasterizationStateCreateInfo rasterizer {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = description.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = description.cullMode;
+    rasterizer.frontFace = description.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+    
+    VkPipelineMultisampleStateCreateInfo multisampling {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 1.0f;
+    
+    VkPipelineColorBlendAttachmentState colorBlendAttachment {};
+    colorBlendAttachment.colorWriteMask = description.colorWriteMask;
+    colorBlendAttachment.blendEnable = description.blendEnable ? VK_TRUE : VK_FALSE;
+    colorBlendAttachment.srcColorBlendFactor = description.blendEnable ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = description.blendEnable ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    
+    VkPipelineColorBlendStateCreateInfo colorBlending {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+    
+    VkPipelineDepthStencilStateCreateInfo depthStencil {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = description.depthTestEnable ? VK_TRUE : VK_FALSE;
+    depthStencil.depthWriteEnable = description.depthWriteEnable ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = description.depthCompareOp;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+    
+    VkPipelineDynamicStateCreateInfo dynamicState {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(description.dynamicStates.size());
+    dynamicState.pDynamicStates = description.dynamicStates.data();
+    
+    VkGraphicsPipelineCreateInfo pipelineInfo {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = description.fragmentShader != VK_NULL_HANDLE ? 2 : 1;
+    pipelineInfo.pStages = shaderStages;
+    
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    
+    pipelineInfo.layout = description.layout;
+    
+    pipelineInfo.renderPass = description.renderPass;
+    pipelineInfo.subpass = description.subpass;
+    
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+    
+    VkPipeline pipeline;
+    
+    if (vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    
+    return pipeline;
+}
+
+GraphicsPipelineDescription getDepthPrepassDescription(const GraphicsPipelineDescription &description)
+{
+    GraphicsPipelineDescription prepass = description;
+    prepass.fragmentShader = VK_NULL_HANDLE;
+    prepass.blendEnable = false;
+    prepass.colorWriteMask = 0;
+    
+    prepass.depthTestEnable = true;
+    prepass.depthWriteEnable = true;
+    prepass.depthCompareOp = VK_COMPARE_OP_LESS;
+    
+    return prepass;
+}
+
+void PipelineCompiler::create(VkDevice device, VkPipelineCache cache, ThreadPool* threadPool)
+{
+    this->device = device;
+    this->cache = cache;
+    this->threadPool = threadPool;
+}
+
+std::future<VkPipeline> PipelineCompiler::compile(const GraphicsPipelineDescription &description)
+{
+    if (threadPool != nullptr)
+    {
+        VkDevice device = this->device;
+        VkPipelineCache cache = this->cache;
+        
+        return threadPool->submit([device, cache, description]()
+        {
+            return createGraphicsPipeline(device, cache, description);
+        });
+    }
+    
+    std::promise<VkPipeline> promise;
+    
+    try
+    {
+        promise.set_value(createGraphicsPipeline(device, cache, description));
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+    
+    return promise.get_future();
+}
+
+std::vector<std::future<VkPipeline>> PipelineCompiler::compile(const std::vector<GraphicsPipelineDescription> &descriptions)
+{
+    std::vector<std::future<VkPipeline>> pipelines;
+    pipelines.reserve(descriptions.size());
+    
+    for (const auto &description : descriptions)
+        pipelines.push_back(compile(description));
+    
+    return pipelines;
+}
@@ -0,0 +1,85 @@
+//
+//  pipelineCompiler.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef pipelineCompiler_hpp
+#define pipelineCompiler_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <future>
+#include <vector>
+
+#include "threadPool.hpp"
+
+// Everything needed to build a graphics pipeline, held by value so it can be handed to another thread
+struct GraphicsPipelineDescription
+{
+    VkShaderModule vertexShader = VK_NULL_HANDLE;
+    
+    // Null for depth-only pipelines
+    VkShaderModule fragmentShader = VK_NULL_HANDLE;
+    
+    std::vector<VkVertexInputBindingDescription> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+    
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+    
+    // Standard alpha blending when enabled
+    bool blendEnable = false;
+    VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    
+    // Ignored in subpasses without a depth attachment, and with both off the depth buffer is left alone
+    bool depthTestEnable = false;
+    bool depthWriteEnable = false;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+    
+    // Element i is the value of constant_id i, given to both stages
+    std::vector<uint32_t> specializationConstants;
+    
+    // Viewport and scissor are set while recording so a resize does not need a new pipeline
+    std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+};
+
+// Safe to call from any thread, pipeline caches are internally synchronized
+VkPipeline createGraphicsPipeline(VkDevice device, VkPipelineCache cache, const GraphicsPipelineDescription &description);
+
+// Depth-only copy of an opaque pipeline for a pre-pass: no fragment shader or color writes, depth tested and written
+// with LESS. The shaded pass after it uses the same vertex stage with EQUAL and depth writes off, so every pixel is
+// shaded once. Pipelines that discard cannot be split like this
+GraphicsPipelineDescription getDepthPrepassDescription(const GraphicsPipelineDescription &description);
+
+// Builds pipelines on a thread pool, all of them sharing one pipeline cache
+class PipelineCompiler
+{
+public:
+    // Without a thread pool every pipeline is built on the calling thread and its future is ready on return
+    void create(VkDevice device, VkPipelineCache cache, ThreadPool* threadPool);
+    
+    // The future rethrows if the driver failed to build the pipeline
+    std::future<VkPipeline> compile(const GraphicsPipelineDescription &description);
+    
+    std::vector<std::future<VkPipeline>> compile(const std::vector<GraphicsPipelineDescription> &descriptions);
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    ThreadPool* threadPool = nullptr;
+};
+
+#endif /* pipelineCompiler_hpp */
@@ -0,0 +1,354 @@
+//
+//  pipelineRegistry.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "pipelineRegistry.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+// HASHING FUNCTIONS START
+// Every Vulkan struct hashed or compared here is made of 32-bit members only, so it has no padding
+// and its bytes are a faithful key
+static void hashCombine(uint64_t &hash, uint64_t value)
+{
+    hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+}
+
+template <typename Value>
+static void hashValue(uint64_t &hash, const Value &value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    uint64_t valueHash = 14695981039346656037ull;
+    
+    for (size_t i = 0; i < sizeof(Value); i++)
+    {
+        valueHash ^= bytes[i];
+        valueHash *= 1099511628211ull;
+    }
+    
+    hashCombine(hash, valueHash);
+}
+
+template <typename Value>
+static void hashVector(uint64_t &hash, const std::vector<Value> &values)
+{
+    hashCombine(hash, values.size());
+    
+    for (const auto &value : values)
+        hashValue(hash, value);
+}
+
+template <typename Value>
+static bool equalValue(const Value &a, const Value &b)
+{
+    return memcmp(&a, &b, sizeof(Value)) == 0;
+}
+
+template <typename Value>
+static bool equalVector(const std::vector<Value> &a, const std::vector<Value> &b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(Value)) == 0);
+}
+
+bool operator==(const SubpassReferences &a, const SubpassReferences &b)
+{
+    return equalVector(a.inputReferences, b.inputReferences) && equalVector(a.colorReferences, b.colorReferences) && a.hasDepthReference == b.hasDepthReference && (!a.hasDepthReference || equalValue(a.depthReference, b.depthReference)) && a.preserveAttachments == b.preserveAttachments;
+}
+
+bool operator==(const RenderPassDescription &a, const RenderPassDescription &b)
+{
+    return equalVector(a.attachments, b.attachments) && a.subpasses == b.subpasses && equalVector(a.dependencies, b.dependencies);
+}
+
+bool operator==(const PipelineLayoutDescription &a, const PipelineLayoutDescription &b)
+{
+    return a.setLayouts == b.setLayouts && equalVector(a.pushConstantRanges, b.pushConstantRanges);
+}
+
+// Everything but the render pass, which the registry replaces with its compatibility class
+static bool equalPipelineState(const GraphicsPipelineDescription &a, const GraphicsPipelineDescription &b)
+{
+    return a.vertexShader == b.vertexShader && a.fragmentShader == b.fragmentShader &&
+        equalVector(a.vertexBindings, b.vertexBindings) && equalVector(a.vertexAttributes, b.vertexAttributes) &&
+        a.topology == b.topology && a.polygonMode == b.polygonMode && a.cullMode == b.cullMode && a.frontFace == b.frontFace &&
+        a.blendEnable == b.blendEnable && a.colorWriteMask == b.colorWriteMask &&
+        a.depthTestEnable == b.depthTestEnable && a.depthWriteEnable == b.depthWriteEnable && a.depthCompareOp == b.depthCompareOp &&
+        a.specializationConstants == b.specializationConstants && a.dynamicStates == b.dynamicStates && a.layout == b.layout && a.subpass == b.subpass;
+}
+
+static uint64_t hashPipelineState(const GraphicsPipelineDescription &description)
+{
+    uint64_t hash = 0;
+    
+    hashValue(hash, description.vertexShader);
+    hashValue(hash, description.fragmentShader);
+    hashVector(hash, description.vertexBindings);
+    hashVector(hash, description.vertexAttributes);
+    
+    hashValue(hash, description.topology);
+    hashValue(hash, description.polygonMode);
+    hashValue(hash, description.cullMode);
+    hashValue(hash, description.frontFace);
+    
+    hashValue(hash, description.blendEnable);
+    hashValue(hash, description.colorWriteMask);
+    
+    hashValue(hash, description.depthTestEnable);
+    hashValue(hash, description.depthWriteEnable);
+    hashValue(hash, description.depthCompareOp);
+    
+    hashVector(hash, description.specializationConstants);
+    hashVector(hash, description.dynamicStates);
+    hashValue(hash, description.layout);
+    hashValue(hash, description.subpass);
+    
+    return hash;
+}
+
+bool operator==(const GraphicsPipelineDescription &a, const GraphicsPipelineDescription &b)
+{
+    return equalPipelineState(a, b) && a.renderPass == b.renderPass;
+}
+
+uint64_t hashRenderPassDescription(const RenderPassDescription &description)
+{
+    uint64_t hash = 0;
+    
+    hashVector(hash, description.attachments);
+    hashCombine(hash, description.subpasses.size());
+    
+    for (const auto &subpass : description.subpasses)
+    {
+        hashVector(hash, subpass.inputReferences);
+        hashVector(hash, subpass.colorReferences);
+        hashValue(hash, subpass.hasDepthReference);
+        
+        if (subpass.hasDepthReference)
+            hashValue(hash, subpass.depthReference);
+        
+        hashVector(hash, subpass.preserveAttachments);
+    }
+    
+    hashVector(hash, description.dependencies);
+    
+    return hash;
+}
+
+uint64_t hashPipelineLayoutDescription(const PipelineLayoutDescription &description)
+{
+    uint64_t hash = 0;
+    
+    hashVector(hash, description.setLayouts);
+    hashVector(hash, description.pushConstantRanges);
+    
+    return hash;
+}
+
+uint64_t hashGraphicsPipelineDescription(const GraphicsPipelineDescription &description)
+{
+    uint64_t hash = hashPipelineState(description);
+    hashValue(hash, description.renderPass);
+    
+    return hash;
+}
+
+RenderPassDescription getCompatibilityDescription(const RenderPassDescription &description)
+{
+    RenderPassDescription compatibility;
+    
+    // Load/store ops, layouts and dependencies do not affect compatibility
+    for (const auto &attachment : description.attachments)
+    {
+        VkAttachmentDescription compatibleAttachment {};
+        compatibleAttachment.format = attachment.format;
+        compatibleAttachment.samples = attachment.samples;
+        
+        compatibility.attachments.push_back(compatibleAttachment);
+    }
+    
+    for (const auto &subpass : description.subpasses)
+    {
+        SubpassReferences compatibleSubpass;
+    
+        for (const auto &reference : subpass.inputReferences)
+            compatibleSubpass.inputReferences.push_back({reference.attachment, VK_IMAGE_LAYOUT_UNDEFINED});
+    
+        for (const auto &reference : subpass.colorReferences)
+            compatibleSubpass.colorReferences.push_back({reference.attachment, VK_IMAGE_LAYOUT_UNDEFINED});
+        
+        compatibleSubpass.hasDepthReference = subpass.hasDepthReference;
+        
+        if (subpass.hasDepthReference)
+            compatibleSubpass.depthReference = {subpass.depthReference.attachment, VK_IMAGE_LAYOUT_UNDEFINED};
+        
+        compatibleSubpass.preserveAttachments = subpass.preserveAttachments;
+        compatibility.subpasses.push_back(compatibleSubpass);
+    }
+    
+    // A single subpass is exempt, beyond that render passes have to be identical apart from ops and layouts
+    if (description.subpasses.size() > 1)
+        compatibility.dependencies = description.dependencies;
+    
+    return compatibility;
+}
+// HASHING FUNCTIONS END
+
+bool PipelineRegistry::PipelineKey::operator==(const PipelineKey &other) const
+{
+    return renderPassClass == other.renderPassClass && equalPipelineState(description, other.description);
+}
+
+size_t PipelineRegistry::PipelineKeyHash::operator()(const PipelineKey &key) const
+{
+    uint64_t hash = hashPipelineState(key.description);
+    hashCombine(hash, key.renderPassClass);
+    
+    return static_cast<size_t>(hash);
+}
+
+void PipelineRegistry::create(VkDevice device, PipelineCompiler* compiler)
+{
+    this->device = device;
+    this->compiler = compiler;
+    
+    stats = PipelineRegistryStats();
+}
+
+void PipelineRegistry::destroy()
+{
+    for (auto &pipeline : pipelines)
+    {
+        // A pipeline that failed to build has nothing to destroy
+        try
+        {
+            vkDestroyPipeline(device, pipeline.second.get(), nullptr);
+        }
+        catch (const std::exception &)
+        {
+        }
+    }
+    
+    for (const auto &layout : layouts)
+        vkDestroyPipelineLayout(device, layout.second, nullptr);
+    
+    for (const auto &renderPass : renderPasses)
+        vkDestroyRenderPass(device, renderPass.second, nullptr);
+    
+    pipelines.clear();
+    layouts.clear();
+    renderPasses.clear();
+    compatibilityClasses.clear();
+    renderPassClasses.clear();
+}
+
+VkRenderPass PipelineRegistry::getRenderPass(const RenderPassDescription &description)
+{
+    auto found = renderPasses.find(description);
+    
+    if (found != renderPasses.end())
+    {
+        stats.cacheHits++;
+        return found->second;
+    }
+    
+    std::vector<VkSubpassDescription> subpasses;
+    
+    for (const auto &references : description.subpasses)
+    {
+        VkSubpassDescription subpass {};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.inputAttachmentCount = static_cast<uint32_t>(references.inputReferences.size());
+        subpass.pInputAttachments = references.inputReferences.data();
+        subpass.colorAttachmentCount = static_cast<uint32_t>(references.colorReferences.size());
+        subpass.pColorAttachments = references.colorReferences.data();
+        subpass.pDepthStencilAttachment = references.hasDepthReference ? &references.depthReference : nullptr;
+        subpass.preserveAttachmentCount = static_cast<uint32_t>(references.preserveAttachments.size());
+        subpass.pPreserveAttachments = references.preserveAttachments.data();
+        
+        subpasses.push_back(subpass);
+    }
+    
+    VkRenderPassCreateInfo renderPassInfo {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(description.attachments.size());
+    renderPassInfo.pAttachments = description.attachments.data();
+    renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+    renderPassInfo.pSubpasses = subpasses.data();
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(description.dependencies.size());
+    renderPassInfo.pDependencies = description.dependencies.data();
+    
+    VkRenderPass renderPass;
+    
+    if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create render pass!");
+    
+    renderPasses[description] = renderPass;
+    stats.renderPassesCreated++;
+    
+    auto compatibilityClass = compatibilityClasses.emplace(getCompatibilityDescription(description), nextRenderPassClass);
+    
+    if (compatibilityClass.second)
+        nextRenderPassClass++;
+    
+    renderPassClasses[renderPass] = compatibilityClass.first->second;
+    
+    return renderPass;
+}
+
+VkPipelineLayout PipelineRegistry::getPipelineLayout(const PipelineLayoutDescription &description)
+{
+    auto found = layouts.find(description);
+    
+    if (found != layouts.end())
+    {
+        stats.cacheHits++;
+        return found->second;
+    }
+    
+    VkPipelineLayoutCreateInfo layoutInfo {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<uint32_t>(description.setLayouts.size());
+    layoutInfo.pSetLayouts = description.setLayouts.data();
+    layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(description.pushConstantRanges.size());
+    layoutInfo.pPushConstantRanges = description.pushConstantRanges.data();
+    
+    VkPipelineLayout layout;
+    
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create a pipeline layout!");
+    
+    layouts[description] = layout;
+    stats.layoutsCreated++;
+    
+    return layout;
+}
+
+std::shared_future<VkPipeline> PipelineRegistry::getPipeline(const GraphicsPipelineDescription &description)
+{
+    // Render passes made elsewhere get a class of their own, so they only match themselves
+    auto renderPassClass = renderPassClasses.emplace(description.renderPass, nextRenderPassClass);
+    
+    if (renderPassClass.second)
+        nextRenderPassClass++;
+    
+    PipelineKey key {description, renderPassClass.first->second};
+    auto found = pipelines.find(key);
+    
+    if (found != pipelines.end())
+    {
+        stats.cacheHits++;
+        return found->second;
+    }
+    
+    std::shared_future<VkPipeline> pipeline = compiler->compile(description).share();
+    
+    pipelines.emplace(std::move(key), pipeline);
+    stats.pipelinesCompiled++;
+    
+    return pipeline;
+}
@@ -0,0 +1,137 @@
+//
+//  pipelineRegistry.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef pipelineRegistry_hpp
+#define pipelineRegistry_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+#include "pipelineCompiler.hpp"
+
+struct SubpassReferences
+{
+    std::vector<VkAttachmentReference> inputReferences;
+    std::vector<VkAttachmentReference> colorReferences;
+    
+    bool hasDepthReference = false;
+    VkAttachmentReference depthReference {};
+    
+    // Attachments this subpass does not touch whose contents a later subpass still needs
+    std::vector<uint32_t> preserveAttachments;
+};
+
+// The attachment, reference and dependency structs are used as is. RenderPassBuilder fills one in from how each
+// subpass uses its attachments
+struct RenderPassDescription
+{
+    std::vector<VkAttachmentDescription> attachments;
+    std::vector<SubpassReferences> subpasses;
+    std::vector<VkSubpassDependency> dependencies;
+};
+
+struct PipelineLayoutDescription
+{
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    std::vector<VkPushConstantRange> pushConstantRanges;
+};
+
+bool operator==(const SubpassReferences &a, const SubpassReferences &b);
+bool operator==(const RenderPassDescription &a, const RenderPassDescription &b);
+bool operator==(const PipelineLayoutDescription &a, const PipelineLayoutDescription &b);
+
+// Shader modules compare by handle, which is the same as comparing SPIR-V because the ShaderLibrary
+// hands out one module per distinct blob
+bool operator==(const GraphicsPipelineDescription &a, const GraphicsPipelineDescription &b);
+
+uint64_t hashRenderPassDescription(const RenderPassDescription &description);
+uint64_t hashPipelineLayoutDescription(const PipelineLayoutDescription &description);
+uint64_t hashGraphicsPipelineDescription(const GraphicsPipelineDescription &description);
+
+// Only what decides render pass compatibility: formats, sample counts and references, plus the dependencies when
+// there is more than one subpass
+RenderPassDescription getCompatibilityDescription(const RenderPassDescription &description);
+
+struct PipelineRegistryStats
+{
+    uint32_t renderPassesCreated = 0;
+    uint32_t layoutsCreated = 0;
+    uint32_t pipelinesCompiled = 0;
+    
+    // Requests answered with an object that already existed
+    uint32_t cacheHits = 0;
+};
+
+// Owns every render pass, pipeline layout and graphics pipeline, and hands out the existing object
+// whenever an identical one is asked for again. Only used from the main thread
+class PipelineRegistry
+{
+public:
+    // Misses are built through the compiler, so pipelines keep compiling in parallel
+    void create(VkDevice device, PipelineCompiler* compiler);
+    
+    // Waits for pipelines that are still compiling
+    void destroy();
+    
+    VkRenderPass getRenderPass(const RenderPassDescription &description);
+    VkPipelineLayout getPipelineLayout(const PipelineLayoutDescription &description);
+    
+    // Pipelines built against any compatible render pass are reused, since they can be used with all of them
+    std::shared_future<VkPipeline> getPipeline(const GraphicsPipelineDescription &description);
+    
+    const PipelineRegistryStats &getStats() const { return stats; }
+
+private:
+    struct RenderPassHash
+    {
+        size_t operator()(const RenderPassDescription &description) const { return static_cast<size_t>(hashRenderPassDescription(description)); }
+    };
+    
+    struct PipelineLayoutHash
+    {
+        size_t operator()(const PipelineLayoutDescription &description) const { return static_cast<size_t>(hashPipelineLayoutDescription(description)); }
+    };
+    
+    // The render pass handle of the description is ignored, its compatibility class is compared instead
+    struct PipelineKey
+    {
+        GraphicsPipelineDescription description;
+        uint64_t renderPassClass;
+        
+        bool operator==(const PipelineKey &other) const;
+    };
+    
+    struct PipelineKeyHash
+    {
+        size_t operator()(const PipelineKey &key) const;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    PipelineCompiler* compiler = nullptr;
+    
+    std::unordered_map<RenderPassDescription, VkRenderPass, RenderPassHash> renderPasses;
+    std::unordered_map<PipelineLayoutDescription, VkPipelineLayout, PipelineLayoutHash> layouts;
+    
+    // Compatible render passes share a class
+    std::unordered_map<RenderPassDescription, uint64_t, RenderPassHash> compatibilityClasses;
+    std::unordered_map<VkRenderPass, uint64_t> renderPassClasses;
+    uint64_t nextRenderPassClass = 0;
+    
+    std::unordered_map<PipelineKey, std::shared_future<VkPipeline>, PipelineKeyHash> pipelines;
+    
+    PipelineRegistryStats stats;
+};
+
+#endif /* pipelineRegistry_hpp */
@@ -0,0 +1,857 @@
+//
+//  renderGraph.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "renderGraph.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+#include "renderPassBuilder.hpp"
+
+// RENDER GRAPH HELPERS START
+struct UseInfo
+{
+    VkPipelineStageFlags stages;
+    VkAccessFlags access;
+    VkAccessFlags writeAccess;
+    VkImageLayout layout;
+    VkImageUsageFlags usage;
+};
+
+static UseInfo getUseInfo(ResourceUse use, PassType type, VkFormat format)
+{
+    VkPipelineStageFlags shaderStages = type == PassType::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    VkImageLayout readLayout = isDepthFormat(format) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    
+    switch (use)
+    {
+        case ResourceUse::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+        case ResourceUse::DepthAttachment:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+        case ResourceUse::DepthReadOnly:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, 0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+        case ResourceUse::InputAttachment:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT, 0, readLayout, VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT};
+        case ResourceUse::SampledRead:
+            return {shaderStages, VK_ACCESS_SHADER_READ_BIT, 0, readLayout, VK_IMAGE_USAGE_SAMPLED_BIT};
+        case ResourceUse::StorageRead:
+            return {shaderStages, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT};
+        case ResourceUse::StorageWrite:
+            return {shaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT};
+        case ResourceUse::IndirectRead:
+            return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED, 0};
+        case ResourceUse::TransferSource:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+        case ResourceUse::TransferDestination:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+        case ResourceUse::Present:
+            return {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 0};
+    }
+    
+    return {};
+}
+
+static bool isWrite(ResourceUse use)
+{
+    return use == ResourceUse::ColorAttachment || use == ResourceUse::DepthAttachment || use == ResourceUse::StorageWrite || use == ResourceUse::TransferDestination;
+}
+
+static bool isImageUse(ResourceUse use)
+{
+    return use != ResourceUse::IndirectRead;
+}
+
+static bool isBufferUse(ResourceUse use)
+{
+    return use == ResourceUse::StorageRead || use == ResourceUse::StorageWrite || use == ResourceUse::IndirectRead || use == ResourceUse::TransferSource || use == ResourceUse::TransferDestination;
+}
+
+static VkImageAspectFlags getAspects(VkFormat format)
+{
+    if (!isDepthFormat(format))
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    
+    return hasStencilComponent(format) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+}
+
+static const char* getUseName(ResourceUse use)
+{
+    switch (use)
+    {
+        case ResourceUse::ColorAttachment: return "color attachment";
+        case ResourceUse::DepthAttachment: return "depth attachment";
+        case ResourceUse::DepthReadOnly: return "read-only depth";
+        case ResourceUse::InputAttachment: return "input attachment";
+        case ResourceUse::SampledRead: return "sampled";
+        case ResourceUse::StorageRead: return "storage read";
+        case ResourceUse::StorageWrite: return "storage write";
+        case ResourceUse::IndirectRead: return "indirect read";
+        case ResourceUse::TransferSource: return "transfer source";
+        case ResourceUse::TransferDestination: return "transfer destination";
+        case ResourceUse::Present: return "present";
+    }
+    
+    return "unknown";
+}
+
+static const char* getLayoutName(VkImageLayout layout)
+{
+    switch (layout)
+    {
+        case VK_IMAGE_LAYOUT_UNDEFINED: return "UNDEFINED";
+        case VK_IMAGE_LAYOUT_GENERAL: return "GENERAL";
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL: return "COLOR_ATTACHMENT_OPTIMAL";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL: return "DEPTH_STENCIL_ATTACHMENT_OPTIMAL";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL: return "DEPTH_STENCIL_READ_ONLY_OPTIMAL";
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL: return "SHADER_READ_ONLY_OPTIMAL";
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL: return "TRANSFER_SRC_OPTIMAL";
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL: return "TRANSFER_DST_OPTIMAL";
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR: return "PRESENT_SRC_KHR";
+        default: return "OTHER";
+    }
+}
+
+static std::string getStageNames(VkPipelineStageFlags stages)
+{
+    const std::pair<VkPipelineStageFlagBits, const char*> names[] = {
+        {VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, "TOP_OF_PIPE"},
+        {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, "DRAW_INDIRECT"},
+        {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, "VERTEX_SHADER"},
+        {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, "FRAGMENT_SHADER"},
+        {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, "EARLY_FRAGMENT_TESTS"},
+        {VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, "LATE_FRAGMENT_TESTS"},
+        {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, "COLOR_ATTACHMENT_OUTPUT"},
+        {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, "COMPUTE_SHADER"},
+        {VK_PIPELINE_STAGE_TRANSFER_BIT, "TRANSFER"},
+        {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, "BOTTOM_OF_PIPE"}
+    };
+    
+    std::string result;
+    
+    for (const auto &name : names)
+    {
+        if (!(stages & name.first))
+            continue;
+        
+        if (!result.empty())
+            result += "|";
+        
+        result += name.second;
+    }
+    
+    return result;
+}
+
+static double toMegabytes(VkDeviceSize bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+// RENDER GRAPH HELPERS END
+
+void RenderGraph::create(VkDevice device, DeviceMemoryAllocator* allocator)
+{
+    this->device = device;
+    this->allocator = allocator;
+}
+
+void RenderGraph::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+    
+    reset();
+    
+    device = VK_NULL_HANDLE;
+}
+
+void RenderGraph::reset()
+{
+    destroyTransients();
+    
+    resources.clear();
+    passes.clear();
+    schedule.clear();
+    finalBarriers = BarrierBatch();
+    stats = RenderGraphStats();
+}
+
+uint32_t RenderGraph::importImage(const std::string &name, VkFormat format, const ResourceState &initialState)
+{
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.transient = false;
+    resource.format = format;
+    resource.extent = {0, 0};
+    resource.initialState = initialState;
+    
+    resources.push_back(resource);
+    
+    return static_cast<uint32_t>(resources.size() - 1);
+}
+
+uint32_t RenderGraph::importBuffer(const std::string &name, const ResourceState &initialState)
+{
+    Resource resource;
+    resource.name = name;
+    resource.isImage = false;
+    resource.transient = false;
+    resource.format = VK_FORMAT_UNDEFINED;
+    resource.extent = {0, 0};
+    resource.initialState = initialState;
+    
+    resources.push_back(resource);
+    
+    return static_cast<uint32_t>(resources.size() - 1);
+}
+
+void RenderGraph::setImage(uint32_t resource, VkImage image)
+{
+    resources[resource].image = image;
+}
+
+void RenderGraph::setBuffer(uint32_t resource, VkBuffer buffer)
+{
+    resources[resource].buffer = buffer;
+}
+
+uint32_t RenderGraph::createImage(const std::string &name, VkFormat format, VkExtent2D extent)
+{
+    Resource resource;
+    resource.name = name;
+    resource.isImage = true;
+    resource.transient = true;
+    resource.format = format;
+    resource.extent = extent;
+    
+    resources.push_back(resource);
+    
+    return static_cast<uint32_t>(resources.size() - 1);
+}
+
+void RenderGraph::setOutput(uint32_t resource, ResourceUse finalUse)
+{
+    resources[resource].output = true;
+    resources[resource].finalUse = finalUse;
+}
+
+uint32_t RenderGraph::addPass(const std::string &name, PassType type, RecordFunction record)
+{
+    Pass pass;
+    pass.name = name;
+    pass.type = type;
+    pass.record = std::move(record);
+    
+    passes.push_back(std::move(pass));
+    
+    return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void RenderGraph::read(uint32_t pass, uint32_t resource, ResourceUse use)
+{
+    if (isWrite(use) || use == ResourceUse::Present)
+        throw std::runtime_error("Failed to add " + resources[resource].name + " to " + passes[pass].name + ", " + getUseName(use) + " is not a read!");
+    
+    if (resources[resource].isImage ? !isImageUse(use) : !isBufferUse(use))
+        throw std::runtime_error("Failed to add " + resources[resource].name + " to " + passes[pass].name + ", it cannot be used as " + getUseName(use) + "!");
+    
+    passes[pass].uses.push_back({resource, use});
+}
+
+void RenderGraph::write(uint32_t pass, uint32_t resource, ResourceUse use)
+{
+    if (!isWrite(use))
+        throw std::runtime_error("Failed to add " + resources[resource].name + " to " + passes[pass].name + ", " + getUseName(use) + " is not a write!");
+    
+    if (resources[resource].isImage ? !isImageUse(use) : !isBufferUse(use))
+        throw std::runtime_error("Failed to add " + resources[resource].name + " to " + passes[pass].name + ", it cannot be used as " + getUseName(use) + "!");
+    
+    passes[pass].uses.push_back({resource, use});
+}
+
+void RenderGraph::setSideEffects(uint32_t pass)
+{
+    passes[pass].sideEffects = true;
+}
+
+void RenderGraph::compile()
+{
+    destroyTransients();
+    
+    schedule.clear();
+    finalBarriers = BarrierBatch();
+    stats = RenderGraphStats();
+    
+    cullPasses();
+    allocateTransients();
+    scheduleBarriers();
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer) const
+{
+    for (const Step &step : schedule)
+    {
+        recordBarriers(commandBuffer, step.barriers);
+        
+        if (passes[step.pass].record)
+            passes[step.pass].record(commandBuffer);
+    }
+    
+    recordBarriers(commandBuffer, finalBarriers);
+}
+
+void RenderGraph::cullPasses()
+{
+    // Walking backwards from the outputs, a resource is live once a pass that is kept reads it. It stays live up to
+    // its first writer, which keeps every pass that wrote part of it even when a later one rewrote all of it
+    std::vector<bool> live(resources.size());
+    
+    for (size_t i = 0; i < resources.size(); i++)
+        live[i] = resources[i].output;
+    
+    for (size_t i = passes.size(); i-- > 0;)
+    {
+        Pass &pass = passes[i];
+        bool needed = pass.sideEffects;
+        
+        for (const Use &use : pass.uses)
+            if (isWrite(use.use) && live[use.resource])
+                needed = true;
+        
+        pass.culled = !needed;
+        
+        if (pass.culled)
+        {
+            stats.culledPasses++;
+            continue;
+        }
+        
+        stats.passCount++;
+        
+        // Storage writes and attachments read what is already there as well
+        for (const Use &use : pass.uses)
+            live[use.resource] = true;
+    }
+}
+
+void RenderGraph::allocateTransients()
+{
+    std::vector<VkImageUsageFlags> usage(resources.size(), 0);
+    
+    // Stages from the last write on and the access of that write, what the next execute has to wait for
+    std::vector<VkPipelineStageFlags> finalStages(resources.size(), 0);
+    std::vector<VkAccessFlags> finalAccess(resources.size(), 0);
+    std::vector<int> lastWritePass(resources.size(), -1);
+    
+    for (auto &resource : resources)
+    {
+        resource.firstPass = -1;
+        resource.lastPass = -1;
+        resource.aliases.clear();
+    }
+    
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        if (passes[i].culled)
+            continue;
+        
+        for (const Use &use : passes[i].uses)
+        {
+            Resource &resource = resources[use.resource];
+            
+            if (!resource.transient)
+                continue;
+            
+            if (resource.firstPass < 0)
+                resource.firstPass = static_cast<int>(i);
+            
+            resource.lastPass = static_cast<int>(i);
+            
+            UseInfo info = getUseInfo(use.use, passes[i].type, resource.format);
+            usage[use.resource] |= info.usage;
+            
+            if (info.writeAccess != 0 && lastWritePass[use.resource] != static_cast<int>(i))
+            {
+                finalStages[use.resource] = 0;
+                finalAccess[use.resource] = 0;
+                lastWritePass[use.resource] = static_cast<int>(i);
+            }
+            
+            finalStages[use.resource] |= info.stages;
+            finalAccess[use.resource] |= info.writeAccess;
+        }
+    }
+    
+    std::vector<uint32_t> transients;
+    std::vector<VkMemoryRequirements> requirements(resources.size());
+    
+    for (uint32_t i = 0; i < resources.size(); i++)
+    {
+        Resource &resource = resources[i];
+        
+        // Only used by culled passes
+        if (!resource.transient || resource.firstPass < 0)
+            continue;
+        
+        VkImageCreateInfo imageInfo {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = resource.format;
+        imageInfo.extent = {resource.extent.width, resource.extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = usage[i];
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        
+        if (vkCreateImage(device, &imageInfo, nullptr, &resource.image) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create render graph image " + resource.name + "!");
+        
+        vkGetImageMemoryRequirements(device, resource.image, &requirements[i]);
+        transients.push_back(i);
+    }
+    
+    if (transients.empty())
+        return;
+    
+    // Largest first packs tighter, the small images fill the gaps the large ones leave
+    std::stable_sort(transients.begin(), transients.end(), [&requirements](uint32_t a, uint32_t b)
+    {
+        return requirements[a].size > requirements[b].size;
+    });
+    
+    auto overlapsInTime = [this](uint32_t a, uint32_t b)
+    {
+        return resources[a].firstPass <= resources[b].lastPass && resources[b].firstPass <= resources[a].lastPass;
+    };
+    
+    auto overlapsInMemory = [this](uint32_t a, uint32_t b)
+    {
+        return resources[a].offset < resources[b].offset + resources[b].size && resources[b].offset < resources[a].offset + resources[a].size;
+    };
+    
+    std::vector<uint32_t> placed;
+    uint32_t memoryTypeBits = ~0u;
+    VkDeviceSize alignment = 1;
+    VkDeviceSize heapSize = 0;
+    
+    for (uint32_t i : transients)
+    {
+        Resource &resource = resources[i];
+        resource.offset = 0;
+        resource.size = requirements[i].size;
+        
+        // Past every image alive at the same time that is in the way, until nothing is
+        bool moved = true;
+        
+        while (moved)
+        {
+            moved = false;
+            
+            for (uint32_t other : placed)
+            {
+                if (!overlapsInTime(i, other) || !overlapsInMemory(i, other))
+                    continue;
+                
+                VkDeviceSize end = resources[other].offset + resources[other].size;
+                resource.offset = (end + requirements[i].alignment - 1) / requirements[i].alignment * requirements[i].alignment;
+                moved = true;
+            }
+        }
+        
+        placed.push_back(i);
+        
+        memoryTypeBits &= requirements[i].memoryTypeBits;
+        alignment = std::max(alignment, requirements[i].alignment);
+        heapSize = std::max(heapSize, resource.offset + resource.size);
+        
+        stats.transientImages++;
+        stats.transientBytes += resource.size;
+    }
+    
+    // Whatever used the memory before an image has to be done with it before the image's first use
+    for (uint32_t i : transients)
+        for (uint32_t other : transients)
+            if (other != i && resources[other].lastPass < resources[i].firstPass && overlapsInMemory(i, other))
+                resources[i].aliases.push_back(other);
+    
+    // The heap is reused by every execute, so the previous one's last uses of the same memory, the image's own
+    // included, have to be done before the first use. Earlier aliases already waited for theirs
+    for (uint32_t i : transients)
+    {
+        Resource &resource = resources[i];
+        resource.initialState = ResourceState();
+        
+        for (uint32_t other : transients)
+        {
+            if (!overlapsInMemory(i, other) || std::find(resource.aliases.begin(), resource.aliases.end(), other) != resource.aliases.end())
+                continue;
+            
+            resource.initialState.stages |= finalStages[other];
+            resource.initialState.access |= finalAccess[other];
+        }
+    }
+    
+    if (memoryTypeBits == 0)
+        throw std::runtime_error("Failed to find a memory type every render graph image can share!");
+    
+    VkMemoryRequirements heapRequirements {};
+    heapRequirements.size = heapSize;
+    heapRequirements.alignment = alignment;
+    heapRequirements.memoryTypeBits = memoryTypeBits;
+    
+    transientMemory = allocator->allocate(heapRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, ResourceTiling::Optimal);
+    stats.aliasedBytes = heapSize;
+    
+    for (uint32_t i : transients)
+    {
+        Resource &resource = resources[i];
+        
+        if (vkBindImageMemory(device, resource.image, transientMemory.memory, transientMemory.offset + resource.offset) != VK_SUCCESS)
+            throw std::runtime_error("Failed to bind render graph image " + resource.name + "!");
+        
+        VkImageViewCreateInfo viewInfo {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = resource.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = resource.format;
+        viewInfo.subresourceRange.aspectMask = getAspects(resource.format);
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        
+        if (vkCreateImageView(device, &viewInfo, nullptr, &resource.view) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create render graph image view " + resource.name + "!");
+    }
+}
+
+void RenderGraph::scheduleBarriers()
+{
+    // Where each resource stands while walking the schedule. A write is visible to the stages a barrier since then
+    // waited for it in, any other stage that reads it needs a barrier of its own
+    struct TrackedState
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags writeStages;
+        VkAccessFlags writeAccess;
+        VkPipelineStageFlags readStages;
+        VkPipelineStageFlags visibleStages;
+    };
+    
+    std::vector<TrackedState> states(resources.size());
+    
+    for (size_t i = 0; i < resources.size(); i++)
+    {
+        const ResourceState &initial = resources[i].initialState;
+        states[i] = {initial.layout, initial.stages, initial.access, 0, 0};
+    }
+    
+    auto addBarrier = [](BarrierBatch &batch, uint32_t resource, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess, VkImageLayout oldLayout, VkImageLayout newLayout)
+    {
+        // Nothing to wait for, only the layout changes
+        if (srcStages != 0)
+            batch.srcStages |= srcStages;
+        else
+            batch.srcStages |= VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        batch.dstStages |= dstStages;
+        batch.barriers.push_back({resource, srcAccess, dstAccess, oldLayout, newLayout});
+    };
+    
+    for (uint32_t passIndex = 0; passIndex < passes.size(); passIndex++)
+    {
+        const Pass &pass = passes[passIndex];
+        
+        if (pass.culled)
+            continue;
+        
+        Step step;
+        step.pass = passIndex;
+        
+        std::vector<uint32_t> handled;
+        
+        for (const Use &first : pass.uses)
+        {
+            uint32_t index = first.resource;
+            
+            if (std::find(handled.begin(), handled.end(), index) != handled.end())
+                continue;
+            
+            handled.push_back(index);
+            
+            const Resource &resource = resources[index];
+            
+            // Every use of the resource in the pass at once, the pass only has to find it in the layout of the first
+            UseInfo combined {};
+            VkImageLayout entryLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkImageLayout exitLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            bool firstUse = true;
+            
+            for (const Use &use : pass.uses)
+            {
+                if (use.resource != index)
+                    continue;
+                
+                UseInfo info = getUseInfo(use.use, pass.type, resource.format);
+                
+                // Only subpasses can move an image to another layout in the middle of a pass
+                if (!firstUse && resource.isImage && info.layout != exitLayout && pass.type != PassType::Graphics)
+                    throw std::runtime_error("Failed to compile render graph, " + pass.name + " uses " + resource.name + " in two layouts!");
+                
+                if (firstUse)
+                    entryLayout = info.layout;
+                
+                exitLayout = info.layout;
+                firstUse = false;
+                
+                combined.stages |= info.stages;
+                combined.access |= info.access;
+                combined.writeAccess |= info.writeAccess;
+            }
+            
+            TrackedState &state = states[index];
+            bool transition = resource.isImage && state.layout != entryLayout;
+            
+            VkPipelineStageFlags srcStages = 0;
+            VkAccessFlags srcAccess = 0;
+            
+            // Rewriting or moving to another layout waits for every earlier access, a read only for the last write and
+            // only when no earlier barrier already made it visible to the stages reading
+            if (transition || combined.writeAccess != 0)
+            {
+                srcStages = state.writeStages | state.readStages;
+                srcAccess = state.writeAccess;
+            }
+            else if (combined.stages & ~state.visibleStages)
+            {
+                srcStages = state.writeStages;
+                srcAccess = state.writeAccess;
+            }
+            
+            if (resource.transient && resource.firstPass == static_cast<int>(passIndex))
+            {
+                for (uint32_t alias : resource.aliases)
+                {
+                    srcStages |= states[alias].writeStages | states[alias].readStages;
+                    srcAccess |= states[alias].writeAccess;
+                }
+            }
+            
+            if (transition || srcStages != 0)
+                addBarrier(step.barriers, index, srcStages, srcAccess, combined.stages, combined.access, state.layout, resource.isImage ? entryLayout : VK_IMAGE_LAYOUT_UNDEFINED);
+            
+            if (combined.writeAccess != 0)
+            {
+                state.writeStages = combined.stages;
+                state.writeAccess = combined.writeAccess;
+                state.readStages = 0;
+                state.visibleStages = 0;
+            }
+            else if (transition)
+            {
+                // The transition is a write of its own that only the stages of this pass have waited for
+                state.writeStages = combined.stages;
+                state.writeAccess = 0;
+                state.readStages = combined.stages;
+                state.visibleStages = combined.stages;
+            }
+            else
+            {
+                state.readStages |= combined.stages;
+                
+                if (srcStages != 0)
+                    state.visibleStages |= combined.stages;
+            }
+            
+            if (resource.isImage)
+                state.layout = exitLayout;
+        }
+        
+        schedule.push_back(std::move(step));
+    }
+    
+    // Outputs leave ready for whatever uses them next, the caller's semaphores and fences order that use
+    for (uint32_t index = 0; index < resources.size(); index++)
+    {
+        const Resource &resource = resources[index];
+        
+        if (!resource.output)
+            continue;
+        
+        UseInfo info = getUseInfo(resource.finalUse, PassType::Graphics, resource.format);
+        
+        const TrackedState &state = states[index];
+        bool transition = resource.isImage && state.layout != info.layout;
+        
+        if (transition)
+            addBarrier(finalBarriers, index, state.writeStages | state.readStages, state.writeAccess, info.stages, info.access, state.layout, info.layout);
+        else if (state.writeStages != 0 && (info.stages & ~state.visibleStages))
+            addBarrier(finalBarriers, index, state.writeStages, state.writeAccess, info.stages, info.access, state.layout, state.layout);
+    }
+    
+    auto countBatch = [this](const BarrierBatch &batch)
+    {
+        if (batch.barriers.empty())
+            return;
+        
+        stats.barrierBatches++;
+        
+        for (const Barrier &barrier : batch.barriers)
+        {
+            if (resources[barrier.resource].isImage)
+                stats.imageBarriers++;
+            else
+                stats.bufferBarriers++;
+            
+            if (barrier.oldLayout != barrier.newLayout)
+                stats.layoutTransitions++;
+        }
+    };
+    
+    for (const Step &step : schedule)
+        countBatch(step.barriers);
+    
+    countBatch(finalBarriers);
+}
+
+void RenderGraph::destroyTransients()
+{
+    for (auto &resource : resources)
+    {
+        if (!resource.transient || resource.image == VK_NULL_HANDLE)
+            continue;
+        
+        if (resource.view != VK_NULL_HANDLE)
+            vkDestroyImageView(device, resource.view, nullptr);
+        
+        vkDestroyImage(device, resource.image, nullptr);
+        
+        resource.image = VK_NULL_HANDLE;
+        resource.view = VK_NULL_HANDLE;
+    }
+    
+    if (transientMemory.memory != VK_NULL_HANDLE)
+        allocator->free(transientMemory);
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch &batch) const
+{
+    if (batch.barriers.empty())
+        return;
+    
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    
+    for (const Barrier &barrier : batch.barriers)
+    {
+        const Resource &resource = resources[barrier.resource];
+        
+        if (resource.isImage)
+        {
+            VkImageMemoryBarrier imageBarrier {};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageBarrier.srcAccessMask = barrier.srcAccess;
+            imageBarrier.dstAccessMask = barrier.dstAccess;
+            imageBarrier.oldLayout = barrier.oldLayout;
+            imageBarrier.newLayout = barrier.newLayout;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = resource.image;
+            imageBarrier.subresourceRange = {getAspects(resource.format), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+            
+            imageBarriers.push_back(imageBarrier);
+        }
+        else
+        {
+            VkBufferMemoryBarrier bufferBarrier {};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            bufferBarrier.srcAccessMask = barrier.srcAccess;
+            bufferBarrier.dstAccessMask = barrier.dstAccess;
+            bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.buffer = resource.buffer;
+            bufferBarrier.offset = 0;
+            bufferBarrier.size = VK_WHOLE_SIZE;
+            
+            bufferBarriers.push_back(bufferBarrier);
+        }
+    }
+    
+    vkCmdPipelineBarrier(commandBuffer, batch.srcStages, batch.dstStages, 0, 0, nullptr, static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(), static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
+
+std::string RenderGraph::dump() const
+{
+    std::ostringstream output;
+    output << std::fixed << std::setprecision(2);
+    
+    output << "Render graph: " << stats.passCount << " passes, " << stats.culledPasses << " culled, " << stats.barrierBatches << " barrier calls with ";
+    output << stats.imageBarriers << " image and " << stats.bufferBarriers << " buffer barriers, " << stats.layoutTransitions << " layout transitions\n";
+    
+    for (const Step &step : schedule)
+    {
+        const Pass &pass = passes[step.pass];
+        
+        dumpBatch(output, step.barriers);
+        
+        const char* type = pass.type == PassType::Graphics ? "graphics" : (pass.type == PassType::Compute ? "compute" : "transfer");
+        output << "  [" << step.pass << "] " << pass.name << " (" << type << ")\n";
+        
+        for (const Use &use : pass.uses)
+            output << "        " << (isWrite(use.use) ? "writes " : "reads ") << resources[use.resource].name << " as " << getUseName(use.use) << "\n";
+    }
+    
+    dumpBatch(output, finalBarriers);
+    
+    for (const Pass &pass : passes)
+        if (pass.culled)
+            output << "  culled: " << pass.name << "\n";
+    
+    if (stats.transientImages > 0)
+    {
+        output << "  " << stats.transientImages << " transient images, " << toMegabytes(stats.transientBytes) << " MB apart, " << toMegabytes(stats.aliasedBytes) << " MB aliased\n";
+        
+        for (const Resource &resource : resources)
+        {
+            if (!resource.transient || resource.firstPass < 0)
+                continue;
+            
+            output << "      " << resource.name << ": " << toMegabytes(resource.size) << " MB at " << toMegabytes(resource.offset) << " MB, passes " << resource.firstPass << "-" << resource.lastPass;
+            
+            for (uint32_t alias : resource.aliases)
+                output << (alias == resource.aliases.front() ? ", after " : " and ") << resources[alias].name;
+            
+            output << "\n";
+        }
+    }
+    
+    return output.str();
+}
+
+void RenderGraph::dumpBatch(std::ostringstream &output, const BarrierBatch &batch) const
+{
+    if (batch.barriers.empty())
+        return;
+    
+    output << "    barrier " << getStageNames(batch.srcStages) << " -> " << getStageNames(batch.dstStages) << "\n";
+    
+    for (const Barrier &barrier : batch.barriers)
+    {
+        const Resource &resource = resources[barrier.resource];
+        output << "        " << resource.name;
+        
+        if (resource.isImage && barrier.oldLayout != barrier.newLayout)
+            output << ": " << getLayoutName(barrier.oldLayout) << " -> " << getLayoutName(barrier.newLayout);
+        
+        output << "\n";
+    }
+}
@@ -0,0 +1,220 @@
+//
+//  renderGraph.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef renderGraph_hpp
+#define renderGraph_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "memoryAllocator.hpp"
+
+// How a pass touches a resource, each use stands for the stages, accesses and image layout the graph synchronizes
+enum class ResourceUse
+{
+    ColorAttachment,
+    DepthAttachment,
+    DepthReadOnly,
+    InputAttachment,
+    SampledRead,
+    StorageRead,
+    StorageWrite,
+    IndirectRead,
+    TransferSource,
+    TransferDestination,
+    
+    // Only as the final use of an output
+    Present
+};
+
+// Picks the shader stages of sampled and storage uses
+enum class PassType
+{
+    Graphics,
+    Compute,
+    Transfer
+};
+
+// What happened to an imported resource before the graph runs, as the stages and accesses to wait for and its layout
+struct ResourceState
+{
+    VkPipelineStageFlags stages = 0;
+    VkAccessFlags access = 0;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+// Fixed once the graph is compiled, every execute records the same barriers
+struct RenderGraphStats
+{
+    uint32_t passCount = 0;
+    uint32_t culledPasses = 0;
+    
+    // vkCmdPipelineBarrier calls, each one batching every barrier in front of a pass
+    uint32_t barrierBatches = 0;
+    uint32_t imageBarriers = 0;
+    uint32_t bufferBarriers = 0;
+    uint32_t layoutTransitions = 0;
+    
+    // Transient images each with memory of its own against the heap they share
+    uint32_t transientImages = 0;
+    VkDeviceSize transientBytes = 0;
+    VkDeviceSize aliasedBytes = 0;
+};
+
+// Passes declare the resources they read and write and the graph works out the rest. Compiling culls every pass that
+// contributes nothing to an output, places transient images whose lifetimes do not overlap in the same memory and
+// computes the barriers, only where there is a hazard or a layout change and batched into one call per pass.
+// Passes run in the order they were added, a graphics pass begins and ends its own render pass, which must be built
+// with RenderPassBuilder::setExternalSynchronization so the attachments stay in the layouts the graph put them in
+class RenderGraph
+{
+public:
+    using RecordFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+    
+    void create(VkDevice device, DeviceMemoryAllocator* allocator);
+    void destroy();
+    
+    // Drops every pass and resource to build the graph again. Transient images go with them, so no frame that used
+    // them may still be in flight
+    void reset();
+    
+    // Owned by the caller, the handles can change with every execute but the state before the graph may not
+    uint32_t importImage(const std::string &name, VkFormat format, const ResourceState &initialState);
+    uint32_t importBuffer(const std::string &name, const ResourceState &initialState);
+    void setImage(uint32_t resource, VkImage image);
+    void setBuffer(uint32_t resource, VkBuffer buffer);
+    
+    // Created by compile() with the usage of its passes, its contents never outlive the graph. Every frame in flight
+    // shares the one heap, so the first use of an image waits for the previous execute's last uses of its memory
+    uint32_t createImage(const std::string &name, VkFormat format, VkExtent2D extent);
+    
+    // Of transient images, once compiled
+    VkImage getImage(uint32_t resource) const { return resources[resource].image; }
+    VkImageView getImageView(uint32_t resource) const { return resources[resource].view; }
+    
+    // Keeps the passes writing it alive and leaves it ready for finalUse after the last pass
+    void setOutput(uint32_t resource, ResourceUse finalUse);
+    
+    uint32_t addPass(const std::string &name, PassType type, RecordFunction record);
+    
+    // In the order the pass uses the resource, a graphics pass may move an attachment through several layouts
+    // across its subpasses
+    void read(uint32_t pass, uint32_t resource, ResourceUse use);
+    void write(uint32_t pass, uint32_t resource, ResourceUse use);
+    
+    // Never culled, for passes whose results leave the graph some other way
+    void setSideEffects(uint32_t pass);
+    
+    // Throws for resources used in ways their kind does not allow
+    void compile();
+    void execute(VkCommandBuffer commandBuffer) const;
+    
+    // The compiled schedule with every barrier and the memory of the transient images
+    std::string dump() const;
+    
+    const RenderGraphStats &getStats() const { return stats; }
+
+private:
+    struct Resource
+    {
+        std::string name;
+        bool isImage;
+        bool transient;
+        
+        VkFormat format;
+        VkExtent2D extent;
+        ResourceState initialState;
+        
+        bool output = false;
+        ResourceUse finalUse = ResourceUse::Present;
+        
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        
+        // Transient images only: the scheduled passes using them, where they sit in the heap and what came before
+        int firstPass = -1;
+        int lastPass = -1;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        std::vector<uint32_t> aliases;
+    };
+    
+    struct Use
+    {
+        uint32_t resource;
+        ResourceUse use;
+    };
+    
+    struct Pass
+    {
+        std::string name;
+        PassType type;
+        RecordFunction record;
+        
+        std::vector<Use> uses;
+        bool sideEffects = false;
+        bool culled = false;
+    };
+    
+    struct Barrier
+    {
+        uint32_t resource;
+        VkAccessFlags srcAccess;
+        VkAccessFlags dstAccess;
+        VkImageLayout oldLayout;
+        VkImageLayout newLayout;
+    };
+    
+    struct BarrierBatch
+    {
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        std::vector<Barrier> barriers;
+    };
+    
+    // A scheduled pass and what has to happen before it
+    struct Step
+    {
+        uint32_t pass;
+        BarrierBatch barriers;
+    };
+    
+    VkDevice device = VK_NULL_HANDLE;
+    DeviceMemoryAllocator* allocator = nullptr;
+    
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    
+    std::vector<Step> schedule;
+    BarrierBatch finalBarriers;
+    
+    // Heap of every transient image
+    MemoryAllocation transientMemory;
+    
+    RenderGraphStats stats;
+    
+    void cullPasses();
+    void allocateTransients();
+    void scheduleBarriers();
+    
+    void destroyTransients();
+    void recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch &batch) const;
+    void dumpBatch(std::ostringstream &output, const BarrierBatch &batch) const;
+};
+
+#endif /* renderGraph_hpp */
@@ -0,0 +1,397 @@
+//
+//  renderPassBuilder.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "renderPassBuilder.hpp"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+uint32_t RenderPassBuilder::addAttachment(const AttachmentInfo &info)
+{
+    attachments.push_back(info);
+    
+    return static_cast<uint32_t>(attachments.size() - 1);
+}
+
+uint32_t RenderPassBuilder::addSubpass()
+{
+    subpasses.emplace_back();
+    
+    return static_cast<uint32_t>(subpasses.size() - 1);
+}
+
+void RenderPassBuilder::addColorOutput(uint32_t subpass, uint32_t attachment)
+{
+    subpasses[subpass].colorAttachments.push_back(attachment);
+}
+
+void RenderPassBuilder::addInputAttachment(uint32_t subpass, uint32_t attachment)
+{
+    subpasses[subpass].inputAttachments.push_back(attachment);
+}
+
+void RenderPassBuilder::setDepthAttachment(uint32_t subpass, uint32_t attachment, bool write)
+{
+    subpasses[subpass].hasDepth = true;
+    subpasses[subpass].depthAttachment = attachment;
+    subpasses[subpass].depthWrite = write;
+}
+
+// RENDER PASS BUILDER HELPERS START
+static VkPipelineStageFlags getStages(VkFormat format, bool input)
+{
+    if (input)
+        return VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    
+    return isDepthFormat(format) ? VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+}
+
+static VkAccessFlags getWriteAccess(VkFormat format)
+{
+    return isDepthFormat(format) ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+}
+
+static VkAccessFlags getReadAccess(VkFormat format)
+{
+    return isDepthFormat(format) ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+}
+// RENDER PASS BUILDER HELPERS END
+
+std::vector<RenderPassBuilder::AttachmentUse> RenderPassBuilder::getUses(uint32_t subpass, uint32_t attachment) const
+{
+    const Subpass &references = subpasses[subpass];
+    std::vector<AttachmentUse> uses;
+    
+    if (std::find(references.colorAttachments.begin(), references.colorAttachments.end(), attachment) != references.colorAttachments.end())
+        uses.push_back(AttachmentUse::Color);
+    
+    if (std::find(references.inputAttachments.begin(), references.inputAttachments.end(), attachment) != references.inputAttachments.end())
+        uses.push_back(AttachmentUse::Input);
+    
+    if (references.hasDepth && references.depthAttachment == attachment)
+        uses.push_back(references.depthWrite ? AttachmentUse::Depth : AttachmentUse::DepthReadOnly);
+    
+    return uses;
+}
+
+VkImageLayout RenderPassBuilder::getLayout(uint32_t subpass, uint32_t attachment) const
+{
+    std::vector<AttachmentUse> uses = getUses(subpass, attachment);
+    
+    if (std::find(uses.begin(), uses.end(), AttachmentUse::Color) != uses.end())
+        return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    
+    if (std::find(uses.begin(), uses.end(), AttachmentUse::Depth) != uses.end())
+        return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    
+    // Depth read as an input, tested against or both
+    if (isDepthFormat(attachments[attachment].format))
+        return VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    
+    return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+RenderPassDescription RenderPassBuilder::build() const
+{
+    if (subpasses.empty())
+        throw std::runtime_error("Failed to build render pass, it has no subpasses!");
+    
+    RenderPassDescription description;
+    description.subpasses.resize(subpasses.size());
+    
+    // One dependency per pair of subpasses, holding everything either side needs ordered
+    std::map<std::pair<uint32_t, uint32_t>, VkSubpassDependency> dependencies;
+    
+    auto addDependency = [&](uint32_t source, uint32_t destination, VkPipelineStageFlags sourceStages, VkAccessFlags sourceAccess, VkPipelineStageFlags destinationStages, VkAccessFlags destinationAccess)
+    {
+        VkSubpassDependency &dependency = dependencies[{source, destination}];
+        dependency.srcSubpass = source;
+        dependency.dstSubpass = destination;
+        dependency.srcStageMask |= sourceStages;
+        dependency.srcAccessMask |= sourceAccess;
+        dependency.dstStageMask |= destinationStages;
+        dependency.dstAccessMask |= destinationAccess;
+        
+        // Each pixel only ever depends on the same pixel of an earlier subpass, which is what lets a tiler merge them
+        if (source != VK_SUBPASS_EXTERNAL)
+            dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+    };
+    
+    for (uint32_t attachment = 0; attachment < attachments.size(); attachment++)
+    {
+        const AttachmentInfo &info = attachments[attachment];
+        
+        std::vector<uint32_t> users;
+        VkPipelineStageFlags allStages = 0;
+        VkAccessFlags allWrites = 0;
+        
+        for (uint32_t subpass = 0; subpass < subpasses.size(); subpass++)
+        {
+            std::vector<AttachmentUse> uses = getUses(subpass, attachment);
+            
+            if (uses.empty())
+                continue;
+            
+            bool input = std::find(uses.begin(), uses.end(), AttachmentUse::Input) != uses.end();
+            bool written = std::find(uses.begin(), uses.end(), AttachmentUse::Color) != uses.end() || std::find(uses.begin(), uses.end(), AttachmentUse::Depth) != uses.end();
+            
+            if (input && written)
+                throw std::runtime_error("Failed to build render pass, an attachment is written and read as an input in the same subpass!");
+            
+            users.push_back(subpass);
+        }
+        
+        if (users.empty())
+            throw std::runtime_error("Failed to build render pass, an attachment is not used by any subpass!");
+        
+        for (uint32_t subpass : users)
+        {
+            for (AttachmentUse use : getUses(subpass, attachment))
+            {
+                allStages |= getStages(info.format, use == AttachmentUse::Input);
+                
+                if (use == AttachmentUse::Color || use == AttachmentUse::Depth)
+                    allWrites |= getWriteAccess(info.format);
+            }
+        }
+        
+        std::vector<AttachmentUse> firstUses = getUses(users.front(), attachment);
+        bool firstWrites = std::find(firstUses.begin(), firstUses.end(), AttachmentUse::Color) != firstUses.end() || std::find(firstUses.begin(), firstUses.end(), AttachmentUse::Depth) != firstUses.end();
+        
+        if (!info.loadContents && !firstWrites)
+            throw std::runtime_error("Failed to build render pass, an attachment is read before anything writes it!");
+        
+        if (info.storeContents && info.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED && !externalSynchronization)
+            throw std::runtime_error("Failed to build render pass, a stored attachment needs a final layout!");
+        
+        VkAttachmentDescription attachmentDescription {};
+        attachmentDescription.format = info.format;
+        attachmentDescription.samples = info.samples;
+        
+        attachmentDescription.loadOp = info.loadContents ? VK_ATTACHMENT_LOAD_OP_LOAD : (info.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        attachmentDescription.storeOp = info.storeContents ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        
+        bool stencil = hasStencilComponent(info.format);
+        attachmentDescription.stencilLoadOp = stencil ? attachmentDescription.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachmentDescription.stencilStoreOp = stencil ? attachmentDescription.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        
+        // Without a store the image stays in whatever layout it was last used in, there is nothing to transition for
+        attachmentDescription.initialLayout = info.loadContents ? info.initialLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+        attachmentDescription.finalLayout = info.storeContents ? info.finalLayout : getLayout(users.back(), attachment);
+        
+        if (externalSynchronization)
+        {
+            attachmentDescription.initialLayout = getLayout(users.front(), attachment);
+            attachmentDescription.finalLayout = getLayout(users.back(), attachment);
+        }
+        
+        description.attachments.push_back(attachmentDescription);
+        
+        for (uint32_t subpass = users.front() + 1; subpass < users.back(); subpass++)
+            if (getUses(subpass, attachment).empty())
+                description.subpasses[subpass].preserveAttachments.push_back(attachment);
+        
+        // The load op runs in the attachment stage of the first subpass, even when that subpass only reads it
+        VkPipelineStageFlags loadStages = getStages(info.format, false);
+        VkAccessFlags loadAccess = getWriteAccess(info.format) | (info.loadContents ? getReadAccess(info.format) : 0);
+        
+        for (size_t i = 0; i < users.size(); i++)
+        {
+            VkPipelineStageFlags stages = 0;
+            VkAccessFlags access = 0;
+            VkAccessFlags writes = 0;
+            
+            for (AttachmentUse use : getUses(users[i], attachment))
+            {
+                stages |= getStages(info.format, use == AttachmentUse::Input);
+                
+                if (use == AttachmentUse::Input)
+                    access |= VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+                else
+                    access |= getReadAccess(info.format);
+                
+                if (use == AttachmentUse::Color || use == AttachmentUse::Depth)
+                    writes |= getWriteAccess(info.format);
+            }
+            
+            // The same attachment as used by the previous frame, which may still be in flight
+            if (i == 0)
+            {
+                if (!externalSynchronization)
+                    addDependency(VK_SUBPASS_EXTERNAL, users[i], allStages, allWrites, stages | loadStages, access | writes | loadAccess);
+                
+                continue;
+            }
+            
+            VkPipelineStageFlags previousStages = 0;
+            VkAccessFlags previousWrites = 0;
+            
+            for (AttachmentUse use : getUses(users[i - 1], attachment))
+            {
+                previousStages |= getStages(info.format, use == AttachmentUse::Input);
+                
+                if (use == AttachmentUse::Color || use == AttachmentUse::Depth)
+                    previousWrites |= getWriteAccess(info.format);
+            }
+            
+            // Two subpasses that only read need no ordering between them
+            if (previousWrites != 0 || writes != 0)
+                addDependency(users[i - 1], users[i], previousStages, previousWrites, stages, access | writes);
+        }
+    }
+    
+    for (uint32_t subpass = 0; subpass < subpasses.size(); subpass++)
+    {
+        const Subpass &references = subpasses[subpass];
+        SubpassReferences &subpassReferences = description.subpasses[subpass];
+        
+        for (uint32_t attachment : references.inputAttachments)
+            subpassReferences.inputReferences.push_back({attachment, getLayout(subpass, attachment)});
+        
+        for (uint32_t attachment : references.colorAttachments)
+            subpassReferences.colorReferences.push_back({attachment, getLayout(subpass, attachment)});
+        
+        subpassReferences.hasDepthReference = references.hasDepth;
+        
+        if (references.hasDepth)
+            subpassReferences.depthReference = {references.depthAttachment, getLayout(subpass, references.depthAttachment)};
+    }
+    
+    for (const auto &dependency : dependencies)
+        description.dependencies.push_back(dependency.second);
+    
+    return description;
+}
+
+VkImageUsageFlags RenderPassBuilder::getImageUsage(uint32_t attachment) const
+{
+    VkImageUsageFlags usage = isTransient(attachment) ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0;
+    
+    for (uint32_t subpass = 0; subpass < subpasses.size(); subpass++)
+    {
+        for (AttachmentUse use : getUses(subpass, attachment))
+        {
+            if (use == AttachmentUse::Input)
+                usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+            else if (use == AttachmentUse::Color)
+                usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+            else
+                usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        }
+    }
+    
+    return usage;
+}
+
+bool RenderPassBuilder::isTransient(uint32_t attachment) const
+{
+    return !attachments[attachment].loadContents && !attachments[attachment].storeContents;
+}
+
+// ATTACHMENT IMAGE FUNCTIONS START
+AttachmentImage createAttachmentImage(VkDevice device, DeviceMemoryAllocator* allocator, VkFormat format, VkExtent2D extent, VkImageUsageFlags usage)
+{
+    AttachmentImage attachment;
+    
+    VkImageCreateInfo imageInfo {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = {extent.width, extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    
+    if (vkCreateImage(device, &imageInfo, nullptr, &attachment.image) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create attachment image!");
+    
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, attachment.image, &requirements);
+    
+    // Tilers expose it, desktop GPUs mostly do not and the image just takes ordinary device memory
+    VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    
+    attachment.lazilyAllocated = (usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) && allocator->hasMemoryType(requirements.memoryTypeBits, properties | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    
+    if (attachment.lazilyAllocated)
+        properties |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+    
+    attachment.allocation = allocator->allocateForImage(attachment.image, properties);
+    
+    VkImageAspectFlags aspects = VK_IMAGE_ASPECT_COLOR_BIT;
+    
+    if (isDepthFormat(format))
+        aspects = hasStencilComponent(format) ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+    
+    VkImageViewCreateInfo viewInfo {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = attachment.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspects;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    
+    if (vkCreateImageView(device, &viewInfo, nullptr, &attachment.view) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create attachment image view!");
+    
+    return attachment;
+}
+
+void destroyAttachmentImage(VkDevice device, DeviceMemoryAllocator* allocator, AttachmentImage &attachment)
+{
+    if (attachment.image == VK_NULL_HANDLE)
+        return;
+    
+    vkDestroyImageView(device, attachment.view, nullptr);
+    vkDestroyImage(device, attachment.image, nullptr);
+    allocator->free(attachment.allocation);
+    
+    attachment = AttachmentImage();
+}
+// ATTACHMENT IMAGE FUNCTIONS END
+
+VkFormat chooseOffscreenFormat(VkPhysicalDevice physicalDevice)
+{
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProperties);
+    
+    if (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT)
+        return VK_FORMAT_R8G8B8A8_SRGB;
+    
+    // Required to be renderable on every implementation
+    return VK_FORMAT_R8G8B8A8_UNORM;
+}
+
+bool isDepthFormat(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool hasStencilComponent(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
@@ -0,0 +1,121 @@
+//
+//  renderPassBuilder.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef renderPassBuilder_hpp
+#define renderPassBuilder_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <cstdint>
+#include <vector>
+
+#include "memoryAllocator.hpp"
+#include "pipelineRegistry.hpp"
+
+// What happens to an attachment's contents outside the render pass. One that is neither loaded nor stored only lives
+// between its subpasses, so it gets DONT_CARE ops and can be a transient, lazily allocated image
+struct AttachmentInfo
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    
+    // Previous contents are loaded from initialLayout, otherwise the first write clears when clear is set
+    bool loadContents = false;
+    VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    bool clear = true;
+    
+    // Written back and left in finalLayout for whatever uses the image after the pass
+    bool storeContents = false;
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+// Describes a render pass by how each subpass uses the attachments and derives the rest: load and store ops, layouts,
+// preserved attachments and the dependencies between subpasses, which are all by region so a tiler can keep the
+// data on chip. The incoming external dependencies cover the previous frame's use of the same attachments
+class RenderPassBuilder
+{
+public:
+    uint32_t addAttachment(const AttachmentInfo &info);
+    
+    // Subpasses run in the order they are added
+    uint32_t addSubpass();
+    
+    void addColorOutput(uint32_t subpass, uint32_t attachment);
+    
+    // Read through subpassInput in the fragment shader, at the same pixel the subpass writes
+    void addInputAttachment(uint32_t subpass, uint32_t attachment);
+    
+    // A read-only depth attachment can also be an input attachment of the same subpass
+    void setDepthAttachment(uint32_t subpass, uint32_t attachment, bool write = true);
+    
+    // For passes run by a render graph, which already orders them against everything around them. Attachments then
+    // come in and go out in the layouts of their first and last use, the initial and final layouts are ignored and
+    // there are no external dependencies
+    void setExternalSynchronization(bool external) { externalSynchronization = external; }
+    
+    // Throws when an attachment is read before anything writes or loads it
+    RenderPassDescription build() const;
+    
+    // Usage flags the attachment's image needs, including TRANSIENT_ATTACHMENT when it never leaves the pass
+    VkImageUsageFlags getImageUsage(uint32_t attachment) const;
+    bool isTransient(uint32_t attachment) const;
+
+private:
+    enum class AttachmentUse
+    {
+        Color,
+        Input,
+        Depth,
+        DepthReadOnly
+    };
+    
+    struct Subpass
+    {
+        std::vector<uint32_t> colorAttachments;
+        std::vector<uint32_t> inputAttachments;
+        
+        bool hasDepth = false;
+        uint32_t depthAttachment = 0;
+        bool depthWrite = false;
+    };
+    
+    std::vector<AttachmentInfo> attachments;
+    std::vector<Subpass> subpasses;
+    bool externalSynchronization = false;
+    
+    // How the subpass uses the attachment, empty when it does not
+    std::vector<AttachmentUse> getUses(uint32_t subpass, uint32_t attachment) const;
+    VkImageLayout getLayout(uint32_t subpass, uint32_t attachment) const;
+};
+
+// An image and view sized for the framebuffer
+struct AttachmentImage
+{
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    MemoryAllocation allocation;
+    
+    // Only backed by memory the tiles actually spill, if at all
+    bool lazilyAllocated = false;
+};
+
+// Transient usage gets lazily allocated memory when the device has it and ordinary device memory otherwise
+AttachmentImage createAttachmentImage(VkDevice device, DeviceMemoryAllocator* allocator, VkFormat format, VkExtent2D extent, VkImageUsageFlags usage);
+void destroyAttachmentImage(VkDevice device, DeviceMemoryAllocator* allocator, AttachmentImage &attachment);
+
+// Color format of headless render targets, shared by both applications so readback sees the same bytes
+VkFormat chooseOffscreenFormat(VkPhysicalDevice physicalDevice);
+
+bool isDepthFormat(VkFormat format);
+bool hasStencilComponent(VkFormat format);
+
+#endif /* renderPassBuilder_hpp */
@@ -0,0 +1,142 @@
+//
+//  settings.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "settings.hpp"
+
+#include <stdexcept>
+#include <string>
+
+static uint32_t parseUnsigned(const std::string &option, const std::string &value)
+{
+    try
+    {
+        size_t parsed = 0;
+        unsigned long result = std::stoul(value, &parsed);
+        
+        if (parsed != value.size())
+            throw std::invalid_argument(value);
+        
+        return static_cast<uint32_t>(result);
+    }
+    catch (const std::logic_error &)
+    {
+        throw std::runtime_error("Invalid value for " + option + ": " + value);
+    }
+}
+
+ApplicationSettings parseApplicationSettings(int argc, const char* argv[])
+{
+    ApplicationSettings settings;
+    bool drawCountSet = false;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        
+        std::string option = argument.substr(0, argument.find('='));
+        std::string value = argument.find('=') != std::string::npos ? argument.substr(argument.find('=') + 1) : "";
+        
+        if (option == "--frames-in-flight")
+        {
+            settings.framesInFlight = parseUnsigned(option, value);
+            
+            if (settings.framesInFlight < MIN_FRAMES_IN_FLIGHT || settings.framesInFlight > MAX_FRAMES_IN_FLIGHT)
+                throw std::runtime_error("--frames-in-flight must be between " + std::to_string(MIN_FRAMES_IN_FLIGHT) + " and " + std::to_string(MAX_FRAMES_IN_FLIGHT) + "!");
+        }
+        else if (option == "--headless")
+            settings.headless = true;
+        else if (option == "--frames")
+            settings.frameLimit = parseUnsigned(option, value);
+        else if (option == "--gpu")
+            settings.deviceOverride = value;
+        else if (option == "--archive")
+            settings.assetArchivePath = value;
+        else if (option == "--no-archive")
+            settings.assetArchivePath.clear();
+        else if (option == "--pipeline-cache")
+            settings.pipelineCachePath = value;
+        else if (option == "--no-pipeline-cache")
+            settings.pipelineCachePath.clear();
+        else if (option == "--benchmark-frame-pacing")
+            settings.benchmarkFramePacing = true;
+        else if (option == "--benchmark-frames")
+            settings.benchmarkFrames = parseUnsigned(option, value);
+        else if (option == "--draws")
+        {
+            settings.drawCount = parseUnsigned(option, value);
+            drawCountSet = true;
+        }
+        else if (option == "--record-threads")
+            settings.recordThreads = parseUnsigned(option, value);
+        else if (option == "--benchmark-recording")
+            settings.benchmarkRecording = true;
+        else if (option == "--benchmark-uploads")
+            settings.benchmarkUploads = true;
+        else if (option == "--benchmark-allocator")
+            settings.benchmarkAllocator = true;
+        else if (option == "--benchmark-async-compute")
+            settings.benchmarkAsyncCompute = true;
+        else if (option == "--benchmark-shaders")
+            settings.benchmarkShaders = true;
+        else if (option == "--benchmark-archive")
+            settings.benchmarkArchive = true;
+        else if (option == "--benchmark-pipelines")
+            settings.benchmarkPipelines = true;
+        else if (option == "--no-descriptor-indexing")
+            settings.descriptorIndexing = false;
+        else if (option == "--benchmark-bindless")
+            settings.benchmarkBindless = true;
+        else if (option == "--benchmark-culling")
+            settings.benchmarkCulling = true;
+        else if (option == "--benchmark-instancing")
+            settings.benchmarkInstancing = true;
+        else if (option == "--benchmark-cpu-culling")
+            settings.benchmarkCpuCulling = true;
+        else if (option == "--mesh")
+            settings.meshPaths.push_back(value);
+        else if (option == "--benchmark-mesh-decode")
+            settings.benchmarkMeshDecode = true;
+        else if (option == "--texture")
+            settings.texturePaths.push_back(value);
+        else if (option == "--texture-budget")
+            settings.textureBudgetMegabytes = parseUnsigned(option, value);
+        else if (option == "--benchmark-textures")
+            settings.benchmarkTextures = true;
+        else if (option == "--benchmark-depth")
+            settings.benchmarkDepth = true;
+        else if (option == "--gbuffer")
+            settings.gbufferPass = true;
+        else if (option == "--benchmark-transient")
+            settings.benchmarkTransient = true;
+        else if (option == "--dump-render-graph")
+            settings.dumpRenderGraph = true;
+        else if (option == "--benchmark-render-graph")
+            settings.benchmarkRenderGraph = true;
+        else if (option == "--profile")
+            settings.profileOutputPath = value.empty() ? DEFAULT_PROFILE_PATH : value;
+        else
+            throw std::runtime_error("Unknown option: " + argument);
+    }
+    
+    // Nothing closes a headless run, so it always needs a frame budget
+    if (settings.headless && settings.frameLimit == 0)
+        settings.frameLimit = DEFAULT_HEADLESS_FRAMES;
+    
+    // The benchmark compares the intermediates of the G-buffer subpass, which has to exist from startup
+    if (settings.benchmarkTransient)
+        settings.gbufferPass = true;
+    
+    // A single triangle says nothing about how recording scales
+    if ((settings.benchmarkRecording || settings.benchmarkBindless || settings.benchmarkCulling) && !drawCountSet)
+        settings.drawCount = DEFAULT_BENCHMARK_DRAWS;
+    
+    if (settings.benchmarkCpuCulling && !drawCountSet)
+        settings.drawCount = DEFAULT_CPU_CULLING_OBJECTS;
+    
+    return settings;
+}
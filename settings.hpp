@@ -0,0 +1,135 @@
+//
+//  settings.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef settings_hpp
+#define settings_hpp
+
+#include <stdio.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint32_t MIN_FRAMES_IN_FLIGHT = 1;
+const uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+const uint32_t DEFAULT_HEADLESS_FRAMES = 1000;
+const uint32_t DEFAULT_BENCHMARK_DRAWS = 100000;
+const uint32_t DEFAULT_CPU_CULLING_OBJECTS = 1000000;
+
+const char* const DEFAULT_PROFILE_PATH = "profile.csv";
+
+// Runtime options chosen on the command line, e.g. --frames-in-flight=3
+struct ApplicationSettings
+{
+    uint32_t framesInFlight = 2;
+    
+    // Renders into offscreen images with no window, surface or swapchain
+    bool headless = false;
+    
+    // Stop after this many frames, 0 runs until the window is closed
+    uint32_t frameLimit = 0;
+    
+    // GPU to use by name or UUID instead of the highest scoring one, falls back to $VULKAN_PROJECT_DEVICE
+    std::string deviceOverride;
+    
+    // Packed archive searched before loose files, skipped when the file does not exist
+    std::string assetArchivePath = "assets.pak";
+    
+    // Pipeline cache file loaded at startup and written at shutdown, empty disables it
+    std::string pipelineCachePath = "pipeline_cache.bin";
+    
+    // Runs every frames-in-flight depth back to back and prints CPU/GPU frame times
+    bool benchmarkFramePacing = false;
+    uint32_t benchmarkFrames = 600;
+    
+    // Draws recorded every frame, split across the recording threads
+    uint32_t drawCount = 1;
+    
+    // Worker threads for command recording, 0 uses every hardware thread
+    uint32_t recordThreads = 0;
+    
+    // Records the draw list with 1, 2, 4... workers and prints the recording time of each
+    bool benchmarkRecording = false;
+    
+    // Streams the same amount of data through the staging ring in small and large pieces and prints MB/s
+    bool benchmarkUploads = false;
+    
+    // Times sub-allocator alloc/free under random churn, needs no GPU
+    bool benchmarkAllocator = false;
+    
+    // Runs graphics alone, compute alone and both together, then prints how much of the shorter one was hidden
+    bool benchmarkAsyncCompute = false;
+    
+    // Loads a few hundred shaders the old way and through the shader library and prints both times
+    bool benchmarkShaders = false;
+    
+    // Reads a couple thousand small files loose and from an archive with a cold page cache, needs no GPU
+    bool benchmarkArchive = false;
+    
+    // Builds a few dozen pipeline variants with 1, 2, 4... compile threads and prints the wall clock time of each,
+    // then requests them again per material with and without the pipeline registry
+    bool benchmarkPipelines = false;
+    
+    // Uses VK_EXT_descriptor_indexing for the bindless table when the device has it, off forces the fallback
+    bool descriptorIndexing = true;
+    
+    // Draws the same triangles with a descriptor set per draw and through the bindless table and prints draws per second
+    bool benchmarkBindless = false;
+    
+    // Draws objects spread far past the screen culled per draw on the CPU, then culled by a compute pass and drawn indirectly
+    bool benchmarkCulling = false;
+    
+    // Renders 10k, 100k and 1M instances with a draw per instance and as instanced draws, printing draw calls and frame times
+    bool benchmarkInstancing = false;
+    
+    // Culls a large sphere table with every SIMD kernel the CPU supports and prints objects per nanosecond, needs no GPU
+    bool benchmarkCpuCulling = false;
+    
+    // Mesh files streamed in on worker threads while the frames keep going, one --mesh=path per mesh
+    std::vector<std::string> meshPaths;
+    
+    // Decodes a set of generated meshes with 1, 2, 4... threads and prints MB/s and peak memory, needs no GPU
+    bool benchmarkMeshDecode = false;
+    
+    // KTX2 textures streamed in a few mips per frame, one --texture=path per texture
+    std::vector<std::string> texturePaths;
+    
+    // Resident texel data the texture streamer keeps under, in megabytes
+    uint32_t textureBudgetMegabytes = 256;
+    
+    // Streams a set of generated compressed textures while rendering, then uploads them all at once, and prints the time
+    // until they are visible and the bytes uploaded per frame of both
+    bool benchmarkTextures = false;
+    
+    // Draws a pile of overlapping, expensively shaded quads without depth testing, with it in several draw orders and
+    // behind a depth pre-pass, printing main pass GPU time and fragments shaded per pixel of each
+    bool benchmarkDepth = false;
+    
+    // Renders the scene into a transient albedo attachment and copies it to the swapchain image in a second subpass
+    bool gbufferPass = false;
+    
+    // Renders through the G-buffer subpass with depth and albedo stored, then discarded, and prints main pass GPU time
+    // and the intermediate memory of both
+    bool benchmarkTransient = false;
+    
+    // Prints the compiled schedule of the frame graph with its barriers whenever it is rebuilt
+    bool dumpRenderGraph = false;
+    
+    // Builds and compiles an example deferred frame graph over and over, then prints its schedule, barrier counts and
+    // the memory its transient images save by aliasing
+    bool benchmarkRenderGraph = false;
+    
+    // Profiler report written at exit, .json or CSV by extension. F12 writes one on demand
+    std::string profileOutputPath;
+};
+
+ApplicationSettings parseApplicationSettings(int argc, const char* argv[]);
+
+#endif /* settings_hpp */
@@ -0,0 +1,135 @@
+//
+//  shaderLibrary.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "shaderLibrary.hpp"
+#include "mappedFile.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// FNV-1a, narrows down the blobs that could be identical before their bytes are compared
+static uint64_t hashBytes(const uint8_t* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    
+    return hash;
+}
+
+void validateSpirv(const void* code, size_t size, const std::string &name)
+{
+    if (size < SPIRV_HEADER_SIZE || size % sizeof(uint32_t) != 0)
+        throw std::runtime_error("Invalid SPIR-V size in " + name + "!");
+    
+    uint32_t magic;
+    memcpy(&magic, code, sizeof(magic));
+    
+    if (magic != SPIRV_MAGIC)
+        throw std::runtime_error("Invalid SPIR-V magic in " + name + "!");
+}
+
+void ShaderLibrary::create(VkDevice device)
+{
+    this->device = device;
+    stats = ShaderLibraryStats();
+}
+
+void ShaderLibrary::destroy()
+{
+    for (const auto &module : modulesByContent)
+        vkDestroyShaderModule(device, module.second.module, nullptr);
+    
+    modulesByContent.clear();
+    modulesByPath.clear();
+}
+
+VkShaderModule ShaderLibrary::load(const std::string &path)
+{
+    auto found = modulesByPath.find(path);
+    
+    if (found != modulesByPath.end())
+    {
+        stats.cachedLoads++;
+        return found->second;
+    }
+    
+    const ArchiveEntry* entry = archive != nullptr ? archive->find(path) : nullptr;
+    
+    if (entry != nullptr)
+    {
+        stats.archiveLoads++;
+        
+        // Uncompressed entries are aligned inside the archive and go to the driver without a copy
+        const uint8_t* data = archive->getData(*entry);
+        VkShaderModule module = data != nullptr ? loadFromMemory(data, entry->size, path) : loadFromMemory(archive->read(*entry).data(), entry->size, path);
+        
+        modulesByPath[path] = module;
+        
+        return module;
+    }
+    
+    // The mapping only has to outlive vkCreateShaderModule, the driver keeps its own copy
+    MappedFile file(path);
+    
+    stats.filesMapped++;
+    stats.bytesMapped += file.size();
+    
+    VkShaderModule module = loadFromMemory(file.data(), file.size(), path);
+    modulesByPath[path] = module;
+    
+    return module;
+}
+
+VkShaderModule ShaderLibrary::loadFromMemory(const void* code, size_t size, const std::string &name)
+{
+    validateSpirv(code, size, name);
+    
+    std::pair<uint64_t, size_t> key {hashBytes(static_cast<const uint8_t*>(code), size), size};
+    auto candidates = modulesByContent.equal_range(key);
+    
+    for (auto candidate = candidates.first; candidate != candidates.second; candidate++)
+    {
+        if (memcmp(candidate->second.code.data(), code, size) == 0)
+        {
+            stats.cachedLoads++;
+            return candidate->second.module;
+        }
+    }
+    
+    std::vector<uint32_t> alignedCopy;
+    
+    if (reinterpret_cast<uintptr_t>(code) % alignof(uint32_t) != 0)
+    {
+        alignedCopy.resize(size / sizeof(uint32_t));
+        memcpy(alignedCopy.data(), code, size);
+        
+        code = alignedCopy.data();
+    }
+    
+    VkShaderModuleCreateInfo createInfo {};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = size;
+    createInfo.pCode = static_cast<const uint32_t*>(code);
+    
+    VkShaderModule module;
+    
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &module) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create shader module!");
+    
+    const uint8_t* bytes = static_cast<const uint8_t*>(code);
+    modulesByContent.insert({key, {std::vector<uint8_t>(bytes, bytes + size), module}});
+    stats.modulesCreated++;
+    
+    return module;
+}
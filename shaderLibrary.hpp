@@ -0,0 +1,80 @@
+//
+//  shaderLibrary.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef shaderLibrary_hpp
+#define shaderLibrary_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "assetArchive.hpp"
+
+const uint32_t SPIRV_MAGIC = 0x07230203;
+const size_t SPIRV_HEADER_SIZE = 5 * sizeof(uint32_t);
+
+struct ShaderLibraryStats
+{
+    uint32_t filesMapped = 0;
+    uint32_t archiveLoads = 0;
+    uint32_t modulesCreated = 0;
+    
+    // Loads answered by an existing module, by path or by identical contents
+    uint32_t cachedLoads = 0;
+    
+    uint64_t bytesMapped = 0;
+};
+
+// Throws unless code is a whole number of words starting with a SPIR-V header in host byte order
+void validateSpirv(const void* code, size_t size, const std::string &name);
+
+// Owns every VkShaderModule of the application. Files are mapped rather than read, and a module is
+// created once per distinct SPIR-V blob no matter how many paths or pipelines refer to it
+class ShaderLibrary
+{
+public:
+    void create(VkDevice device);
+    void destroy();
+    
+    // Entries of the archive shadow loose files of the same path
+    void setArchive(const AssetArchive* archive) { this->archive = archive; }
+    
+    VkShaderModule load(const std::string &path);
+    
+    // Blobs that are not 4-byte aligned are copied once, everything else is handed to the driver in place
+    VkShaderModule loadFromMemory(const void* code, size_t size, const std::string &name);
+    
+    const ShaderLibraryStats &getStats() const { return stats; }
+    size_t getModuleCount() const { return modulesByContent.size(); }
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    const AssetArchive* archive = nullptr;
+    
+    std::unordered_map<std::string, VkShaderModule> modulesByPath;
+    
+    struct ContentModule
+    {
+        std::vector<uint8_t> code;
+        VkShaderModule module;
+    };
+    
+    // Keyed by content hash and size, blobs that collide are told apart by their bytes
+    std::multimap<std::pair<uint64_t, size_t>, ContentModule> modulesByContent;
+    
+    ShaderLibraryStats stats;
+};
+
+#endif /* shaderLibrary_hpp */
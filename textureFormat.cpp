@@ -0,0 +1,304 @@
+//
+//  textureFormat.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "textureFormat.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+struct FormatBlockEntry
+{
+    VkFormat format;
+    FormatBlock block;
+};
+
+const FormatBlockEntry FORMAT_BLOCKS[] = {
+    {VK_FORMAT_R8_UNORM, {1, 1, 1}},
+    {VK_FORMAT_R8G8_UNORM, {1, 1, 2}},
+    {VK_FORMAT_R8G8B8A8_UNORM, {1, 1, 4}},
+    {VK_FORMAT_R8G8B8A8_SRGB, {1, 1, 4}},
+    {VK_FORMAT_B8G8R8A8_UNORM, {1, 1, 4}},
+    {VK_FORMAT_B8G8R8A8_SRGB, {1, 1, 4}},
+    {VK_FORMAT_R16G16B16A16_SFLOAT, {1, 1, 8}},
+    {VK_FORMAT_BC1_RGB_UNORM_BLOCK, {4, 4, 8}},
+    {VK_FORMAT_BC1_RGB_SRGB_BLOCK, {4, 4, 8}},
+    {VK_FORMAT_BC1_RGBA_UNORM_BLOCK, {4, 4, 8}},
+    {VK_FORMAT_BC1_RGBA_SRGB_BLOCK, {4, 4, 8}},
+    {VK_FORMAT_BC2_UNORM_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC2_SRGB_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC3_UNORM_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC3_SRGB_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC4_UNORM_BLOCK, {4, 4, 8}},
+    {VK_FORMAT_BC4_SNORM_BLOCK, {4, 4, 8}},
+    {VK_FORMAT_BC5_UNORM_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC5_SNORM_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC6H_UFLOAT_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC6H_SFLOAT_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC7_UNORM_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_BC7_SRGB_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_ASTC_4x4_UNORM_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_ASTC_4x4_SRGB_BLOCK, {4, 4, 16}},
+    {VK_FORMAT_ASTC_5x4_UNORM_BLOCK, {5, 4, 16}},
+    {VK_FORMAT_ASTC_5x4_SRGB_BLOCK, {5, 4, 16}},
+    {VK_FORMAT_ASTC_5x5_UNORM_BLOCK, {5, 5, 16}},
+    {VK_FORMAT_ASTC_5x5_SRGB_BLOCK, {5, 5, 16}},
+    {VK_FORMAT_ASTC_6x5_UNORM_BLOCK, {6, 5, 16}},
+    {VK_FORMAT_ASTC_6x5_SRGB_BLOCK, {6, 5, 16}},
+    {VK_FORMAT_ASTC_6x6_UNORM_BLOCK, {6, 6, 16}},
+    {VK_FORMAT_ASTC_6x6_SRGB_BLOCK, {6, 6, 16}},
+    {VK_FORMAT_ASTC_8x5_UNORM_BLOCK, {8, 5, 16}},
+    {VK_FORMAT_ASTC_8x5_SRGB_BLOCK, {8, 5, 16}},
+    {VK_FORMAT_ASTC_8x6_UNORM_BLOCK, {8, 6, 16}},
+    {VK_FORMAT_ASTC_8x6_SRGB_BLOCK, {8, 6, 16}},
+    {VK_FORMAT_ASTC_8x8_UNORM_BLOCK, {8, 8, 16}},
+    {VK_FORMAT_ASTC_8x8_SRGB_BLOCK, {8, 8, 16}},
+    {VK_FORMAT_ASTC_10x5_UNORM_BLOCK, {10, 5, 16}},
+    {VK_FORMAT_ASTC_10x5_SRGB_BLOCK, {10, 5, 16}},
+    {VK_FORMAT_ASTC_10x6_UNORM_BLOCK, {10, 6, 16}},
+    {VK_FORMAT_ASTC_10x6_SRGB_BLOCK, {10, 6, 16}},
+    {VK_FORMAT_ASTC_10x8_UNORM_BLOCK, {10, 8, 16}},
+    {VK_FORMAT_ASTC_10x8_SRGB_BLOCK, {10, 8, 16}},
+    {VK_FORMAT_ASTC_10x10_UNORM_BLOCK, {10, 10, 16}},
+    {VK_FORMAT_ASTC_10x10_SRGB_BLOCK, {10, 10, 16}},
+    {VK_FORMAT_ASTC_12x10_UNORM_BLOCK, {12, 10, 16}},
+    {VK_FORMAT_ASTC_12x10_SRGB_BLOCK, {12, 10, 16}},
+    {VK_FORMAT_ASTC_12x12_UNORM_BLOCK, {12, 12, 16}},
+    {VK_FORMAT_ASTC_12x12_SRGB_BLOCK, {12, 12, 16}}
+};
+
+bool getFormatBlock(VkFormat format, FormatBlock &block)
+{
+    for (const auto &entry : FORMAT_BLOCKS)
+    {
+        if (entry.format == format)
+        {
+            block = entry.block;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+uint64_t getLevelSize(const FormatBlock &block, uint32_t width, uint32_t height, uint32_t level)
+{
+    uint64_t blocksWide = (std::max(width >> level, 1u) + block.width - 1) / block.width;
+    uint64_t blocksHigh = (std::max(height >> level, 1u) + block.height - 1) / block.height;
+    
+    return blocksWide * blocksHigh * block.bytes;
+}
+
+TextureLayout parseKtx2(const uint8_t* data, size_t size)
+{
+    Ktx2Header header;
+    
+    if (size < sizeof(header) || memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+        throw std::runtime_error("Texture data is not KTX2!");
+    
+    memcpy(&header, data, sizeof(header));
+    
+    // Basis data comes with format 0 and would have to be transcoded, supercompressed levels inflated first
+    if (header.supercompressionScheme != 0 || header.vkFormat == 0)
+        throw std::runtime_error("Supercompressed KTX2 textures are not supported!");
+    
+    if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.pixelWidth == 0 || header.pixelHeight == 0)
+        throw std::runtime_error("Only single 2D KTX2 textures are supported!");
+    
+    TextureLayout layout;
+    layout.format = static_cast<VkFormat>(header.vkFormat);
+    layout.width = header.pixelWidth;
+    layout.height = header.pixelHeight;
+    
+    if (!getFormatBlock(layout.format, layout.block))
+        throw std::runtime_error("KTX2 texture has an unknown format!");
+    
+    // 0 asks the loader to generate the mips, which only leaves the base level here
+    uint32_t levelCount = std::max(header.levelCount, 1u);
+    
+    if (levelCount > 32 || (std::max(layout.width, layout.height) >> (levelCount - 1)) == 0)
+        throw std::runtime_error("KTX2 texture has too many levels!");
+    
+    size_t indexOffset = sizeof(header);
+    
+    if (size < indexOffset + levelCount * sizeof(Ktx2LevelIndex))
+        throw std::runtime_error("KTX2 texture is truncated!");
+    
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        Ktx2LevelIndex index;
+        memcpy(&index, data + indexOffset + level * sizeof(index), sizeof(index));
+        
+        TextureLevel textureLevel;
+        textureLevel.offset = index.byteOffset;
+        textureLevel.size = index.byteLength;
+        textureLevel.width = std::max(layout.width >> level, 1u);
+        textureLevel.height = std::max(layout.height >> level, 1u);
+        textureLevel.rowPitch = static_cast<uint64_t>((textureLevel.width + layout.block.width - 1) / layout.block.width) * layout.block.bytes;
+        
+        if (index.byteLength != getLevelSize(layout.block, layout.width, layout.height, level))
+            throw std::runtime_error("KTX2 texture level has the wrong size!");
+        
+        if (index.byteOffset > size || index.byteLength > size - index.byteOffset)
+            throw std::runtime_error("KTX2 texture is truncated!");
+        
+        layout.levels.push_back(textureLevel);
+    }
+    
+    return layout;
+}
+
+// Basic data format descriptor with one sample per channel, as required by the KTX2 specification
+static std::vector<uint8_t> createDataFormatDescriptor(VkFormat format, const FormatBlock &block)
+{
+    struct Sample
+    {
+        uint16_t bitOffset;
+        uint8_t bitLength;
+        uint8_t channelType;
+        uint32_t upper;
+    };
+    
+    uint8_t colorModel = 0;
+    bool srgb = false;
+    std::vector<Sample> samples;
+    
+    switch (format)
+    {
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            srgb = true;
+            [[fallthrough]];
+        case VK_FORMAT_R8G8B8A8_UNORM:
+            colorModel = 1;     // RGBSDA
+            samples = {{0, 7, 0, 255}, {8, 7, 1, 255}, {16, 7, 2, 255}, {24, 7, 15, 255}};
+            break;
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            srgb = true;
+            [[fallthrough]];
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            colorModel = 128;   // BC1A, color only
+            samples = {{0, 63, 0, UINT32_MAX}};
+            break;
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            srgb = true;
+            [[fallthrough]];
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            colorModel = 128;   // BC1A with alpha present
+            samples = {{0, 63, 15, UINT32_MAX}};
+            break;
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            srgb = true;
+            [[fallthrough]];
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            colorModel = 134;   // BC7
+            samples = {{0, 127, 0, UINT32_MAX}};
+            break;
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+            srgb = true;
+            [[fallthrough]];
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+            colorModel = 162;   // ASTC
+            samples = {{0, 127, 0, UINT32_MAX}};
+            break;
+        default:
+            throw std::runtime_error("No KTX2 data format descriptor for this format!");
+    }
+    
+    uint16_t blockSize = static_cast<uint16_t>(24 + 16 * samples.size());
+    uint32_t totalSize = 4 + blockSize;
+    
+    std::vector<uint8_t> descriptor(totalSize, 0);
+    uint8_t* cursor = descriptor.data();
+    
+    auto write = [&cursor](const void* value, size_t size)
+    {
+        memcpy(cursor, value, size);
+        cursor += size;
+    };
+    
+    uint32_t vendorAndType = 0;
+    uint16_t version = 2;
+    uint8_t basics[4] = {colorModel, 1, static_cast<uint8_t>(srgb ? 2 : 1), 0};   // BT.709 primaries, sRGB or linear
+    uint8_t dimensions[4] = {static_cast<uint8_t>(block.width - 1), static_cast<uint8_t>(block.height - 1), 0, 0};
+    uint8_t bytesPlane[8] = {static_cast<uint8_t>(block.bytes), 0, 0, 0, 0, 0, 0, 0};
+    
+    write(&totalSize, sizeof(totalSize));
+    write(&vendorAndType, sizeof(vendorAndType));
+    write(&version, sizeof(version));
+    write(&blockSize, sizeof(blockSize));
+    write(basics, sizeof(basics));
+    write(dimensions, sizeof(dimensions));
+    write(bytesPlane, sizeof(bytesPlane));
+    
+    for (const auto &sample : samples)
+    {
+        uint32_t lower = 0;
+        uint8_t position[4] = {0, 0, 0, 0};
+        
+        write(&sample.bitOffset, sizeof(sample.bitOffset));
+        write(&sample.bitLength, sizeof(sample.bitLength));
+        write(&sample.channelType, sizeof(sample.channelType));
+        write(position, sizeof(position));
+        write(&lower, sizeof(lower));
+        write(&sample.upper, sizeof(sample.upper));
+    }
+    
+    return descriptor;
+}
+
+std::vector<uint8_t> writeKtx2(VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>> &levels)
+{
+    FormatBlock block;
+    
+    if (!getFormatBlock(format, block))
+        throw std::runtime_error("Failed to write KTX2 texture, unknown format!");
+    
+    uint32_t levelCount = static_cast<uint32_t>(levels.size());
+    
+    for (uint32_t level = 0; level < levelCount; level++)
+        if (levels[level].size() != getLevelSize(block, width, height, level))
+            throw std::runtime_error("Failed to write KTX2 texture, a level has the wrong size!");
+    
+    std::vector<uint8_t> descriptor = createDataFormatDescriptor(format, block);
+    
+    Ktx2Header header {};
+    memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat = format;
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.faceCount = 1;
+    header.levelCount = levelCount;
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(header) + levelCount * sizeof(Ktx2LevelIndex));
+    header.dfdByteLength = static_cast<uint32_t>(descriptor.size());
+    
+    // Level data goes smallest first, each level aligned to the least common multiple of the block size and 4
+    uint64_t alignment = block.bytes % 4 == 0 ? block.bytes : block.bytes * (block.bytes % 2 == 0 ? 2 : 4);
+    uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+    
+    std::vector<Ktx2LevelIndex> index(levelCount);
+    
+    for (uint32_t level = levelCount; level-- > 0;)
+    {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        
+        index[level] = {offset, levels[level].size(), levels[level].size()};
+        offset += levels[level].size();
+    }
+    
+    std::vector<uint8_t> data(offset, 0);
+    
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), index.data(), index.size() * sizeof(Ktx2LevelIndex));
+    memcpy(data.data() + header.dfdByteOffset, descriptor.data(), descriptor.size());
+    
+    for (uint32_t level = 0; level < levelCount; level++)
+        memcpy(data.data() + index[level].byteOffset, levels[level].data(), levels[level].size());
+    
+    return data;
+}
@@ -0,0 +1,99 @@
+//
+//  textureFormat.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef textureFormat_hpp
+#define textureFormat_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <cstdint>
+#include <vector>
+
+// «KTX 20»\r\n\x1A\n
+const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+// Followed by levelCount Ktx2LevelIndex entries. Everything is little endian
+struct Ktx2Header
+{
+    uint8_t identifier[12];
+    
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct Ktx2LevelIndex
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+// Size of a format's texel block, 1x1 for uncompressed formats
+struct FormatBlock
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytes;
+};
+
+// Knows the BC and ASTC block formats and a few plain color ones, false for anything else
+bool getFormatBlock(VkFormat format, FormatBlock &block);
+
+struct TextureLevel
+{
+    uint64_t offset;
+    uint64_t size;
+    
+    uint32_t width;
+    uint32_t height;
+    
+    // Bytes from one row of blocks to the next, the rows are tightly packed
+    uint64_t rowPitch;
+};
+
+// Where every mip level of a texture lives in its file, level 0 being the largest
+struct TextureLayout
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    FormatBlock block {};
+    
+    uint32_t width = 0;
+    uint32_t height = 0;
+    
+    std::vector<TextureLevel> levels;
+};
+
+// Single 2D images with a known block format and no supercompression. Every level has to lie inside the data and be
+// exactly as large as its extent needs, anything else throws
+TextureLayout parseKtx2(const uint8_t* data, size_t size);
+
+// Levels largest first. Only formats with a data format descriptor below are written: BC1, BC7, ASTC 4x4 and RGBA8
+std::vector<uint8_t> writeKtx2(VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>> &levels);
+
+// Bytes level `level` of a width x height image takes in the format
+uint64_t getLevelSize(const FormatBlock &block, uint32_t width, uint32_t height, uint32_t level);
+
+#endif /* textureFormat_hpp */
@@ -0,0 +1,288 @@
+//
+//  textureStreamer.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "textureStreamer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+void TextureStreamer::create(VkPhysicalDevice physicalDevice, VkDevice device, BufferManager* bufferManager, BindlessTable* bindlessTable, const AssetArchive* archive, uint32_t slotCount, VkDeviceSize budget)
+{
+    this->physicalDevice = physicalDevice;
+    this->device = device;
+    this->bufferManager = bufferManager;
+    this->bindlessTable = bindlessTable;
+    this->archive = archive;
+    this->slotCount = slotCount;
+    this->budget = budget;
+    
+    const uint32_t white = 0xFFFFFFFF;
+    
+    placeholderImage = bufferManager->createDeviceImage(VK_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, VK_IMAGE_USAGE_SAMPLED_BIT);
+    bufferManager->uploadImage(placeholderImage, 0, 1, sizeof(white), &white);
+    
+    bufferManager->flush();
+    bufferManager->waitIdle();
+    
+    placeholderView = createView(placeholderImage);
+    bindlessTable->setDefaultSampledImage(placeholderView);
+}
+
+void TextureStreamer::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+    
+    for (auto &texture : textures)
+    {
+        if (texture.view == VK_NULL_HANDLE)
+            continue;
+        
+        vkDestroyImageView(device, texture.view, nullptr);
+        bufferManager->destroyImage(texture.image);
+    }
+    
+    for (auto &retired : retiredImages)
+    {
+        vkDestroyImageView(device, retired.view, nullptr);
+        bufferManager->destroyImage(retired.image);
+    }
+    
+    vkDestroyImageView(device, placeholderView, nullptr);
+    bufferManager->destroyImage(placeholderImage);
+    
+    textures.clear();
+    retiredImages.clear();
+    
+    device = VK_NULL_HANDLE;
+}
+
+uint32_t TextureStreamer::request(const std::string &path)
+{
+    Texture texture;
+    texture.path = path;
+    texture.requestTime = std::chrono::steady_clock::now();
+    
+    const ArchiveEntry* entry = archive != nullptr && archive->isOpen() ? archive->find(path) : nullptr;
+    size_t size = 0;
+    
+    if (entry != nullptr)
+    {
+        texture.data = archive->getData(*entry);
+        
+        if (texture.data == nullptr)
+        {
+            texture.bytes = archive->read(*entry);
+            texture.data = texture.bytes.data();
+        }
+        
+        size = entry->size;
+    }
+    else
+    {
+        texture.file = MappedFile(path);
+        texture.data = texture.file.data();
+        size = texture.file.size();
+    }
+    
+    // Only the header and level index are read here, the level data stays on disk until it is uploaded
+    texture.layout = parseKtx2(texture.data, size);
+    
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, texture.layout.format, &properties);
+    
+    if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        throw std::runtime_error("Failed to load " + path + ", its format cannot be sampled on this device!");
+    
+    texture.residentLevel = static_cast<uint32_t>(texture.layout.levels.size());
+    
+    textures.push_back(std::move(texture));
+    settled = false;
+    
+    return static_cast<uint32_t>(textures.size() - 1);
+}
+
+VkDeviceSize TextureStreamer::update(VkDeviceSize uploadBudget)
+{
+    frameNumber++;
+    
+    // Frames recorded before an image was replaced are all done once slotCount more frames have been submitted
+    retiredImages.erase(std::remove_if(retiredImages.begin(), retiredImages.end(), [this](RetiredImage &retired)
+    {
+        if (frameNumber - retired.retiredAtFrame < slotCount)
+            return false;
+        
+        vkDestroyImageView(device, retired.view, nullptr);
+        bufferManager->destroyImage(retired.image);
+        
+        return true;
+    }), retiredImages.end());
+    
+    VkDeviceSize uploaded = 0;
+    
+    // Over the budget the largest textures give up their top level first, never going below the preview levels
+    while (stats.residentBytes > budget && uploaded < uploadBudget)
+    {
+        Texture* largest = nullptr;
+        
+        for (auto &texture : textures)
+        {
+            if (texture.residentLevel >= getPreviewLevel(texture.layout))
+                continue;
+            
+            if (largest == nullptr || getChainSize(texture.layout, texture.residentLevel) > getChainSize(largest->layout, largest->residentLevel))
+                largest = &texture;
+        }
+        
+        if (largest == nullptr)
+            break;
+        
+        uploaded += makeResident(*largest, largest->residentLevel + 1);
+        stats.downgrades++;
+    }
+    
+    // Textures with nothing resident come first, then the lowest resolutions, so the quality evens out across the scene
+    std::vector<Texture*> candidates;
+    
+    for (auto &texture : textures)
+        if (texture.residentLevel > 0)
+            candidates.push_back(&texture);
+    
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b)
+    {
+        bool aMissing = a->residentLevel == a->layout.levels.size();
+        bool bMissing = b->residentLevel == b->layout.levels.size();
+        
+        if (aMissing != bMissing)
+            return aMissing;
+        
+        if (aMissing)
+            return false;
+        
+        const TextureLevel &aLevel = a->layout.levels[a->residentLevel];
+        const TextureLevel &bLevel = b->layout.levels[b->residentLevel];
+        
+        return static_cast<uint64_t>(aLevel.width) * aLevel.height < static_cast<uint64_t>(bLevel.width) * bLevel.height;
+    });
+    
+    settled = stats.residentBytes <= budget;
+    
+    for (Texture* texture : candidates)
+    {
+        const TextureLayout &layout = texture->layout;
+        bool visible = texture->residentLevel < layout.levels.size();
+        
+        uint32_t level = visible ? texture->residentLevel - 1 : getPreviewLevel(layout);
+        VkDeviceSize growth = getChainSize(layout, level) - (visible ? getChainSize(layout, texture->residentLevel) : 0);
+        
+        // A smaller texture further down may still fit
+        if (stats.residentBytes + growth > budget)
+            continue;
+        
+        settled = false;
+        
+        if (uploaded >= uploadBudget)
+            break;
+        
+        uploaded += makeResident(*texture, level);
+        
+        if (visible)
+            stats.upgrades++;
+    }
+    
+    // Replaced images are only freed here, so callers that stop updating once settled leave nothing behind
+    if (!retiredImages.empty())
+        settled = false;
+    
+    stats.bytesUploadedLastFrame = uploaded;
+    stats.bytesUploaded += uploaded;
+    stats.maxBytesUploadedPerFrame = std::max(stats.maxBytesUploadedPerFrame, uploaded);
+    
+    if (uploaded > 0)
+        stats.framesWithUploads++;
+    
+    return uploaded;
+}
+
+uint32_t TextureStreamer::getPreviewLevel(const TextureLayout &layout)
+{
+    uint32_t lastLevel = static_cast<uint32_t>(layout.levels.size() - 1);
+    
+    for (uint32_t level = 0; level < lastLevel; level++)
+        if (std::max(layout.levels[level].width, layout.levels[level].height) <= TEXTURE_PREVIEW_EXTENT)
+            return level;
+    
+    return lastLevel;
+}
+
+VkDeviceSize TextureStreamer::getChainSize(const TextureLayout &layout, uint32_t firstLevel)
+{
+    VkDeviceSize size = 0;
+    
+    for (uint32_t level = firstLevel; level < layout.levels.size(); level++)
+        size += layout.levels[level].size;
+    
+    return size;
+}
+
+VkImageView TextureStreamer::createView(const DeviceImage &image) const
+{
+    VkImageViewCreateInfo viewInfo {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = image.format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = image.mipLevels;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    
+    VkImageView view;
+    
+    if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create texture image view!");
+    
+    return view;
+}
+
+VkDeviceSize TextureStreamer::makeResident(Texture &texture, uint32_t firstLevel)
+{
+    const TextureLayout &layout = texture.layout;
+    const TextureLevel &top = layout.levels[firstLevel];
+    
+    uint32_t levelCount = static_cast<uint32_t>(layout.levels.size()) - firstLevel;
+    DeviceImage image = bufferManager->createDeviceImage(layout.format, top.width, top.height, levelCount, VK_IMAGE_USAGE_SAMPLED_BIT);
+    
+    // Levels that were already resident are uploaded again instead of copied over, together they are at most a third
+    // of the new top level
+    for (uint32_t level = firstLevel; level < layout.levels.size(); level++)
+        bufferManager->uploadImage(image, level - firstLevel, layout.block.height, layout.levels[level].rowPitch, texture.data + layout.levels[level].offset);
+    
+    VkDeviceSize uploaded = getChainSize(layout, firstLevel);
+    
+    if (texture.image.image != VK_NULL_HANDLE)
+    {
+        retiredImages.push_back({texture.image, texture.view, frameNumber});
+        bindlessTable->remove(BindlessResourceType::SampledImage, texture.handle);
+        
+        stats.residentBytes -= getChainSize(layout, texture.residentLevel);
+    }
+    
+    texture.image = image;
+    texture.view = createView(image);
+    texture.handle = bindlessTable->addSampledImage(texture.view);
+    texture.residentLevel = firstLevel;
+    
+    stats.residentBytes += uploaded;
+    
+    if (texture.timeToVisible < 0.0)
+        texture.timeToVisible = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - texture.requestTime).count();
+    
+    return uploaded;
+}
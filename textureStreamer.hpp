@@ -0,0 +1,148 @@
+//
+//  textureStreamer.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef textureStreamer_hpp
+#define textureStreamer_hpp
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdio.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "assetArchive.hpp"
+#include "bindlessTable.hpp"
+#include "bufferManager.hpp"
+#include "mappedFile.hpp"
+#include "textureFormat.hpp"
+
+// Mips up to this size go up together as soon as a texture is requested, so something is visible within a frame
+const uint32_t TEXTURE_PREVIEW_EXTENT = 64;
+
+const VkDeviceSize DEFAULT_TEXTURE_BUDGET = 256 * 1024 * 1024;
+
+// Texture bytes queued per frame, one upgrade larger than this still goes through on its own
+const VkDeviceSize DEFAULT_TEXTURE_UPLOAD_BUDGET = 8 * 1024 * 1024;
+
+struct TextureStreamingStats
+{
+    // Texel data of every resident level, the budget is checked against this
+    VkDeviceSize residentBytes = 0;
+    
+    VkDeviceSize bytesUploaded = 0;
+    VkDeviceSize bytesUploadedLastFrame = 0;
+    VkDeviceSize maxBytesUploadedPerFrame = 0;
+    
+    uint32_t upgrades = 0;
+    uint32_t downgrades = 0;
+    uint32_t framesWithUploads = 0;
+};
+
+// Streams KTX2 textures into sampled images registered in the bindless table. A request makes the small mips resident
+// first, then every update() raises the lowest resolution textures one level at a time for as long as the resident
+// data stays under the budget. A level changes by building a new image with the new chain and switching the handle
+// over, the old image goes slotCount updates later when no frame in flight can still sample it
+class TextureStreamer
+{
+public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, BufferManager* bufferManager, BindlessTable* bindlessTable, const AssetArchive* archive, uint32_t slotCount, VkDeviceSize budget = DEFAULT_TEXTURE_BUDGET);
+    
+    // The device must be idle
+    void destroy();
+    
+    // Looked up in the archive first, then as a loose file. Throws for formats the device cannot sample
+    uint32_t request(const std::string &path);
+    
+    // A lower budget is met over the next updates by dropping the top levels of the largest textures
+    void setBudget(VkDeviceSize budget) { this->budget = budget; }
+    VkDeviceSize getBudget() const { return budget; }
+    
+    // Main thread, at most once per frame before it is recorded. Queues the uploads of this frame and returns their
+    // size, the caller flushes them with a semaphore the next graphics submit waits on
+    VkDeviceSize update(VkDeviceSize uploadBudget = DEFAULT_TEXTURE_UPLOAD_BUDGET);
+    
+    // INVALID_BINDLESS_HANDLE until something of the texture is resident, may change with every update()
+    uint32_t getHandle(uint32_t texture) const { return textures[texture].handle; }
+    
+    // Index of the largest resident level, the level count while nothing is resident
+    uint32_t getResidentLevel(uint32_t texture) const { return textures[texture].residentLevel; }
+    uint32_t getLevelCount(uint32_t texture) const { return static_cast<uint32_t>(textures[texture].layout.levels.size()); }
+    
+    // From the request to the update that made the first levels resident, negative until then
+    double getTimeToVisible(uint32_t texture) const { return textures[texture].timeToVisible; }
+    
+    uint32_t getTextureCount() const { return static_cast<uint32_t>(textures.size()); }
+    
+    // True once every texture is either complete or cannot grow without going over the budget, and every image it
+    // replaced has been freed. Until then update() has to keep being called
+    bool isSettled() const { return settled; }
+    
+    const TextureStreamingStats &getStats() const { return stats; }
+
+private:
+    struct Texture
+    {
+        std::string path;
+        TextureLayout layout;
+        
+        // Level data, mapped from a loose file or an uncompressed archive entry, or read out of a compressed one
+        const uint8_t* data = nullptr;
+        MappedFile file;
+        std::vector<uint8_t> bytes;
+        
+        DeviceImage image;
+        VkImageView view = VK_NULL_HANDLE;
+        uint32_t handle = INVALID_BINDLESS_HANDLE;
+        uint32_t residentLevel = 0;
+        
+        std::chrono::steady_clock::time_point requestTime;
+        double timeToVisible = -1.0;
+    };
+    
+    struct RetiredImage
+    {
+        DeviceImage image;
+        VkImageView view;
+        uint64_t retiredAtFrame;
+    };
+    
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    BufferManager* bufferManager = nullptr;
+    BindlessTable* bindlessTable = nullptr;
+    const AssetArchive* archive = nullptr;
+    
+    uint32_t slotCount = 0;
+    VkDeviceSize budget = 0;
+    
+    std::vector<Texture> textures;
+    std::vector<RetiredImage> retiredImages;
+    uint64_t frameNumber = 0;
+    bool settled = true;
+    
+    // 1x1 white, written into the unused slots of a fallback bindless table
+    DeviceImage placeholderImage;
+    VkImageView placeholderView = VK_NULL_HANDLE;
+    
+    TextureStreamingStats stats;
+    
+    static uint32_t getPreviewLevel(const TextureLayout &layout);
+    static VkDeviceSize getChainSize(const TextureLayout &layout, uint32_t firstLevel);
+    
+    VkImageView createView(const DeviceImage &image) const;
+    
+    // Builds and uploads an image holding firstLevel and everything below it, returns the bytes queued
+    VkDeviceSize makeResident(Texture &texture, uint32_t firstLevel);
+};
+
+#endif /* textureStreamer_hpp */
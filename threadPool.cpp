@@ -0,0 +1,57 @@
+//
+//  threadPool.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "threadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    
+    workers.reserve(threadCount);
+    
+    for (uint32_t i = 0; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    
+    queueCondition.notify_all();
+    
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            
+            // Drain whatever is queued before shutting down so no future is left unsatisfied
+            if (stopping && tasks.empty())
+                return;
+            
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        
+        task();
+    }
+}
@@ -0,0 +1,66 @@
+//
+//  threadPool.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef threadPool_hpp
+#define threadPool_hpp
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one FIFO queue
+class ThreadPool
+{
+public:
+    // 0 picks one worker per hardware thread
+    explicit ThreadPool(uint32_t threadCount = 0);
+    
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    
+    template <typename Function>
+    auto submit(Function &&function) -> std::future<decltype(function())>
+    {
+        using Result = decltype(function());
+        
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> result = task->get_future();
+        
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.emplace([task]() { (*task)(); });
+        }
+        
+        queueCondition.notify_one();
+        
+        return result;
+    }
+    
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping = false;
+    
+    void workerLoop();
+};
+
+#endif /* threadPool_hpp */
@@ -0,0 +1,266 @@
+//
+//  tlsfAllocator.cpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+
+#include "tlsfAllocator.hpp"
+
+#include <algorithm>
+
+static uint32_t highestBit(uint64_t value)
+{
+    return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+}
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t size)
+{
+    reset(size);
+}
+
+void TlsfAllocator::reset(uint64_t size)
+{
+    nodes.clear();
+    unusedNodes.clear();
+    
+    firstLevelBitmap = 0;
+    std::fill(std::begin(secondLevelBitmaps), std::end(secondLevelBitmaps), 0u);
+    
+    for (auto &list : freeLists)
+        std::fill(std::begin(list), std::end(list), INVALID_HANDLE);
+    
+    totalSize = size & ~(MIN_ALIGNMENT - 1);
+    freeSize = totalSize;
+    allocationCount = 0;
+    
+    if (totalSize > 0)
+        insertFree(createNode(0, totalSize));
+}
+
+uint32_t TlsfAllocator::allocate(uint64_t size, uint64_t alignment, uint64_t &offset)
+{
+    size = alignUp(std::max<uint64_t>(size, 1), MIN_ALIGNMENT);
+    alignment = std::max(alignment, MIN_ALIGNMENT);
+    
+    // Every node starts on MIN_ALIGNMENT, so this is the most padding a larger alignment can cost
+    uint32_t node = findFreeNode(size + alignment - MIN_ALIGNMENT);
+    
+    if (node == INVALID_HANDLE)
+        return INVALID_HANDLE;
+    
+    removeFree(node);
+    
+    uint64_t padding = alignUp(nodes[node].offset, alignment) - nodes[node].offset;
+    
+    if (padding >= MIN_SPLIT_SIZE)
+    {
+        splitFront(node, padding);
+        padding = 0;
+    }
+    
+    if (nodes[node].size - padding - size >= MIN_SPLIT_SIZE)
+        splitBack(node, padding + size);
+    
+    nodes[node].free = false;
+    
+    freeSize -= nodes[node].size;
+    allocationCount++;
+    
+    offset = nodes[node].offset + padding;
+    
+    return node;
+}
+
+void TlsfAllocator::free(uint32_t handle)
+{
+    uint32_t node = handle;
+    
+    nodes[node].free = true;
+    
+    freeSize += nodes[node].size;
+    allocationCount--;
+    
+    uint32_t next = nodes[node].nextPhysical;
+    
+    if (next != INVALID_HANDLE && nodes[next].free)
+    {
+        removeFree(next);
+        absorbNext(node);
+    }
+    
+    uint32_t previous = nodes[node].previousPhysical;
+    
+    if (previous != INVALID_HANDLE && nodes[previous].free)
+    {
+        removeFree(previous);
+        absorbNext(previous);
+        
+        node = previous;
+    }
+    
+    insertFree(node);
+}
+
+void TlsfAllocator::mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel)
+{
+    // Sizes below SECOND_LEVEL_COUNT get one exact class each, above that every power of two is split in SECOND_LEVEL_COUNT
+    if (size < SECOND_LEVEL_COUNT)
+    {
+        firstLevel = 0;
+        secondLevel = static_cast<uint32_t>(size);
+    }
+    else
+    {
+        uint32_t bit = highestBit(size);
+        
+        firstLevel = bit - SECOND_LEVEL_LOG + 1;
+        secondLevel = static_cast<uint32_t>(size >> (bit - SECOND_LEVEL_LOG)) - SECOND_LEVEL_COUNT;
+    }
+}
+
+uint32_t TlsfAllocator::findFreeNode(uint64_t size) const
+{
+    // Rounding up to the next class boundary means any node found in that class or above is big enough
+    if (size >= SECOND_LEVEL_COUNT)
+        size += (1ull << (highestBit(size) - SECOND_LEVEL_LOG)) - 1;
+    
+    uint32_t firstLevel, secondLevel;
+    mapping(size, firstLevel, secondLevel);
+    
+    if (firstLevel >= FIRST_LEVEL_COUNT)
+        return INVALID_HANDLE;
+    
+    uint32_t secondLevelMap = secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    
+    if (secondLevelMap == 0)
+    {
+        uint64_t firstLevelMap = firstLevel + 1 < FIRST_LEVEL_COUNT ? firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+        
+        if (firstLevelMap == 0)
+            return INVALID_HANDLE;
+        
+        firstLevel = static_cast<uint32_t>(__builtin_ctzll(firstLevelMap));
+        secondLevelMap = secondLevelBitmaps[firstLevel];
+    }
+    
+    secondLevel = static_cast<uint32_t>(__builtin_ctz(secondLevelMap));
+    
+    return freeLists[firstLevel][secondLevel];
+}
+
+uint32_t TlsfAllocator::createNode(uint64_t offset, uint64_t size)
+{
+    Node node {offset, size, INVALID_HANDLE, INVALID_HANDLE, INVALID_HANDLE, INVALID_HANDLE, true};
+    
+    if (!unusedNodes.empty())
+    {
+        uint32_t index = unusedNodes.back();
+        unusedNodes.pop_back();
+        
+        nodes[index] = node;
+        
+        return index;
+    }
+    
+    nodes.push_back(node);
+    
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void TlsfAllocator::insertFree(uint32_t node)
+{
+    uint32_t firstLevel, secondLevel;
+    mapping(nodes[node].size, firstLevel, secondLevel);
+    
+    uint32_t head = freeLists[firstLevel][secondLevel];
+    
+    nodes[node].free = true;
+    nodes[node].previousFree = INVALID_HANDLE;
+    nodes[node].nextFree = head;
+    
+    if (head != INVALID_HANDLE)
+        nodes[head].previousFree = node;
+    
+    freeLists[firstLevel][secondLevel] = node;
+    
+    firstLevelBitmap |= 1ull << firstLevel;
+    secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::removeFree(uint32_t node)
+{
+    uint32_t firstLevel, secondLevel;
+    mapping(nodes[node].size, firstLevel, secondLevel);
+    
+    uint32_t previous = nodes[node].previousFree;
+    uint32_t next = nodes[node].nextFree;
+    
+    if (previous != INVALID_HANDLE)
+        nodes[previous].nextFree = next;
+    else
+        freeLists[firstLevel][secondLevel] = next;
+    
+    if (next != INVALID_HANDLE)
+        nodes[next].previousFree = previous;
+    
+    if (freeLists[firstLevel][secondLevel] == INVALID_HANDLE)
+    {
+        secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+        
+        if (secondLevelBitmaps[firstLevel] == 0)
+            firstLevelBitmap &= ~(1ull << firstLevel);
+    }
+}
+
+void TlsfAllocator::splitFront(uint32_t node, uint64_t size)
+{
+    uint32_t front = createNode(nodes[node].offset, size);
+    
+    nodes[front].previousPhysical = nodes[node].previousPhysical;
+    nodes[front].nextPhysical = node;
+    
+    if (nodes[node].previousPhysical != INVALID_HANDLE)
+        nodes[nodes[node].previousPhysical].nextPhysical = front;
+    
+    nodes[node].previousPhysical = front;
+    nodes[node].offset += size;
+    nodes[node].size -= size;
+    
+    insertFree(front);
+}
+
+void TlsfAllocator::splitBack(uint32_t node, uint64_t size)
+{
+    uint32_t back = createNode(nodes[node].offset + size, nodes[node].size - size);
+    
+    nodes[back].previousPhysical = node;
+    nodes[back].nextPhysical = nodes[node].nextPhysical;
+    
+    if (nodes[node].nextPhysical != INVALID_HANDLE)
+        nodes[nodes[node].nextPhysical].previousPhysical = back;
+    
+    nodes[node].nextPhysical = back;
+    nodes[node].size = size;
+    
+    insertFree(back);
+}
+
+void TlsfAllocator::absorbNext(uint32_t node)
+{
+    uint32_t next = nodes[node].nextPhysical;
+    
+    nodes[node].size += nodes[next].size;
+    nodes[node].nextPhysical = nodes[next].nextPhysical;
+    
+    if (nodes[next].nextPhysical != INVALID_HANDLE)
+        nodes[nodes[next].nextPhysical].previousPhysical = node;
+    
+    unusedNodes.push_back(next);
+}
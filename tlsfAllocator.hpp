@@ -0,0 +1,91 @@
+//
+//  tlsfAllocator.hpp
+//  VulkanProject
+//
+//  Created by Keegan Bilodeau on 10/17/26.
+//  Copyright © 2020 Keegan Bilodeau. All rights reserved.
+//
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdocumentation"
+
+#ifndef tlsfAllocator_hpp
+#define tlsfAllocator_hpp
+
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+// Two-level segregated fit over the range [0, size). It only hands out offsets, so it knows nothing
+// about Vulkan and every operation is O(1): two bitmap scans to find a free range, constant time merges on free
+class TlsfAllocator
+{
+public:
+    static constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+    
+    // Offsets and sizes are kept multiples of this, any smaller alignment comes for free
+    static constexpr uint64_t MIN_ALIGNMENT = 16;
+    
+    explicit TlsfAllocator(uint64_t size = 0);
+    
+    void reset(uint64_t size);
+    
+    // Returns the handle to free with, or INVALID_HANDLE when no free range fits. alignment must be a power of two
+    uint32_t allocate(uint64_t size, uint64_t alignment, uint64_t &offset);
+    void free(uint32_t handle);
+    
+    // Bytes the allocation actually holds, alignment padding and unsplit remainders included
+    uint64_t getReservedSize(uint32_t handle) const { return nodes[handle].size; }
+    
+    uint64_t getSize() const { return totalSize; }
+    uint64_t getFreeSize() const { return freeSize; }
+    bool isEmpty() const { return allocationCount == 0; }
+
+private:
+    static constexpr uint32_t SECOND_LEVEL_LOG = 5;
+    static constexpr uint32_t SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_LOG;
+    static constexpr uint32_t FIRST_LEVEL_COUNT = 64;
+    
+    // Leftovers smaller than this stay with the allocation instead of becoming a free range of their own
+    static constexpr uint64_t MIN_SPLIT_SIZE = 256;
+    
+    struct Node
+    {
+        uint64_t offset;
+        uint64_t size;
+        
+        uint32_t previousPhysical;
+        uint32_t nextPhysical;
+        uint32_t previousFree;
+        uint32_t nextFree;
+        
+        bool free;
+    };
+    
+    std::vector<Node> nodes;
+    std::vector<uint32_t> unusedNodes;
+    
+    uint64_t firstLevelBitmap = 0;
+    uint32_t secondLevelBitmaps[FIRST_LEVEL_COUNT];
+    uint32_t freeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+    
+    uint64_t totalSize = 0;
+    uint64_t freeSize = 0;
+    uint32_t allocationCount = 0;
+    
+    static void mapping(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel);
+    
+    uint32_t findFreeNode(uint64_t size) const;
+    uint32_t createNode(uint64_t offset, uint64_t size);
+    
+    void insertFree(uint32_t node);
+    void removeFree(uint32_t node);
+    
+    // Cuts size bytes off the front of the node into a new free node placed before it
+    void splitFront(uint32_t node, uint64_t size);
+    void splitBack(uint32_t node, uint64_t size);
+    
+    // Folds the next physical node into node, the next one must be free and out of its free list
+    void absorbNext(uint32_t node);
+};
+
+#endif /* tlsfAllocator_hpp */